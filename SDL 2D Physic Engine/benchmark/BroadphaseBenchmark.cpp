@@ -0,0 +1,164 @@
+/*
+ * Headless broadphase benchmark. Builds towers of boxes that are already at rest (the common case once
+ * a level settles) and a falling pile where everything moves, then times MoveProxy + UpdatePairs per step.
+ *
+ * Build from this folder:
+ * g++ -O2 -std=c++17 -I../src -I../include/GLM BroadphaseBenchmark.cpp ../src/AllPairsBroadphase.cpp
+ *     ../src/SpatialHashBroadphase.cpp ../src/DynamicTree.cpp ../src/DynamicTreeBroadphase.cpp
+ *     ../src/SweepAndPruneBroadphase.cpp -o BroadphaseBenchmark
+ */
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "AllPairsBroadphase.h"
+#include "DynamicTreeBroadphase.h"
+#include "SpatialHashBroadphase.h"
+#include "SweepAndPruneBroadphase.h"
+
+namespace
+{
+	constexpr int STEPS = 120;
+
+	// The all pairs loop is quadratic, past this it only proves the point slower
+	constexpr int ALL_PAIRS_LIMIT = 5000;
+
+	struct Scene
+	{
+		std::vector<AABB> boxes;
+		std::vector<glm::vec2> velocities;
+		float jitter = 0.0f;
+	};
+
+	// Columns of 55x90 blocks stacked on a ground box, like the PlayScene towers
+	Scene BuildStackedScene(const int body_count)
+	{
+		Scene scene;
+		scene.jitter = 0.02f;
+		scene.boxes.push_back(AABB::FromCenter({ 0.0f, 60.0f }, { 100000.0f, 62.5f }));
+
+		const int tower_height = 10;
+		for (int i = 1; i < body_count; i++)
+		{
+			const int column = (i - 1) / tower_height;
+			const int row = (i - 1) % tower_height;
+			const glm::vec2 center = { column * 70.0f, -row * 90.0f - 45.0f };
+			scene.boxes.push_back(AABB::FromCenter(center, { 27.5f, 45.0f }));
+		}
+
+		scene.velocities.assign(scene.boxes.size(), glm::vec2(0, 0));
+		return scene;
+	}
+
+	// Circles raining down on the ground, every proxy moves every step
+	Scene BuildFallingScene(const int body_count)
+	{
+		Scene scene;
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> position_x(0.0f, body_count * 3.0f);
+		std::uniform_real_distribution<float> position_y(-body_count * 1.0f, 0.0f);
+		std::uniform_real_distribution<float> speed(-4.0f, 4.0f);
+
+		scene.boxes.push_back(AABB::FromCenter({ 0.0f, 60.0f }, { 100000.0f, 62.5f }));
+		for (int i = 1; i < body_count; i++)
+		{
+			scene.boxes.push_back(AABB::FromCenter({ position_x(random), position_y(random) }, { 15.0f, 15.0f }));
+		}
+
+		scene.velocities.resize(scene.boxes.size());
+		scene.velocities[0] = glm::vec2(0, 0);
+		for (size_t i = 1; i < scene.velocities.size(); i++)
+		{
+			scene.velocities[i] = { speed(random), speed(random) + 2.0f };
+		}
+		return scene;
+	}
+
+	// Returns the average microseconds per step and the average pair count
+	void Run(Broadphase& broadphase, Scene scene, double& micro_seconds, double& pair_count)
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> noise(-scene.jitter, scene.jitter);
+
+		std::vector<int> proxies;
+		for (const auto& box : scene.boxes)
+		{
+			proxies.push_back(broadphase.CreateProxy(box));
+		}
+
+		std::vector<BroadphasePair> pairs;
+		broadphase.UpdatePairs(pairs);
+
+		double total_pairs = 0;
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (int step = 0; step < STEPS; step++)
+		{
+			for (size_t i = 0; i < scene.boxes.size(); i++)
+			{
+				const glm::vec2 offset = scene.velocities[i] + ((i == 0) ? glm::vec2(0, 0) : glm::vec2(noise(random), noise(random)));
+				scene.boxes[i].min += offset;
+				scene.boxes[i].max += offset;
+				broadphase.MoveProxy(proxies[i], scene.boxes[i]);
+			}
+
+			broadphase.UpdatePairs(pairs);
+			total_pairs += static_cast<double>(pairs.size());
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		micro_seconds = std::chrono::duration<double, std::micro>(end - start).count() / STEPS;
+		pair_count = total_pairs / STEPS;
+	}
+
+	std::unique_ptr<Broadphase> Create(const BroadphaseType type)
+	{
+		switch (type)
+		{
+		case BroadphaseType::ALL_PAIRS:
+			return std::make_unique<AllPairsBroadphase>();
+		case BroadphaseType::SPATIAL_HASH:
+			return std::make_unique<SpatialHashBroadphase>();
+		case BroadphaseType::DYNAMIC_TREE:
+			return std::make_unique<DynamicTreeBroadphase>();
+		case BroadphaseType::SWEEP_AND_PRUNE:
+		default:
+			return std::make_unique<SweepAndPruneBroadphase>();
+		}
+	}
+}
+
+int main()
+{
+	const char* names[] = { "all pairs", "spatial hash", "dynamic tree", "sweep and prune" };
+	const int sizes[] = { 1000, 4000, 16000 };
+
+	for (int scene_index = 0; scene_index < 2; scene_index++)
+	{
+		printf("\n%s scene, %d steps\n", (scene_index == 0) ? "stacked" : "falling", STEPS);
+		printf("%-8s %-16s %12s %12s\n", "bodies", "broadphase", "us/step", "pairs");
+
+		for (const int size : sizes)
+		{
+			const Scene scene = (scene_index == 0) ? BuildStackedScene(size) : BuildFallingScene(size);
+
+			for (int type = 0; type < static_cast<int>(BroadphaseType::NUM_OF_TYPES); type++)
+			{
+				if (type == static_cast<int>(BroadphaseType::ALL_PAIRS) && size > ALL_PAIRS_LIMIT)
+				{
+					continue;
+				}
+
+				const auto broadphase = Create(static_cast<BroadphaseType>(type));
+				double micro_seconds = 0;
+				double pair_count = 0;
+				Run(*broadphase, scene, micro_seconds, pair_count);
+
+				printf("%-8d %-16s %12.1f %12.0f\n", size, names[type], micro_seconds, pair_count);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * Headless integrator benchmark. Fills the body columns with random bodies (one in eight static like the
+ * ground, one in eight kinematic), times every integrator path the CPU supports, and checks each one against the scalar
+ * path after all the steps.
+ *
+ * Build from this folder:
+ * g++ -O2 -std=c++17 -I../src IntegratorBenchmark.cpp ../src/Integrator.cpp -o IntegratorBenchmark
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Integrator.h"
+
+namespace
+{
+	constexpr int STEPS = 200;
+	constexpr float GRAVITY = -1000.0f;
+	constexpr float AIR_FRICTION = 0.999f;
+	constexpr float DELTA_TIME = 0.016f;
+
+	// Relative error allowed between a SIMD path and the scalar path
+	constexpr float EPSILON = 1e-5f;
+
+	struct Bodies
+	{
+		std::vector<float> positionX, positionY, velocityX, velocityY, forceX, forceY;
+		std::vector<float> mass, inverseMass, gravityScaleX, gravityScaleY;
+		std::vector<BodyType> bodyType;
+		std::vector<uint32_t> enableGravity, awake;
+
+		IntegrationBatch GetBatch()
+		{
+			IntegrationBatch batch;
+			batch.positionX = positionX.data();
+			batch.positionY = positionY.data();
+			batch.velocityX = velocityX.data();
+			batch.velocityY = velocityY.data();
+			batch.forceX = forceX.data();
+			batch.forceY = forceY.data();
+			batch.mass = mass.data();
+			batch.inverseMass = inverseMass.data();
+			batch.gravityScaleX = gravityScaleX.data();
+			batch.gravityScaleY = gravityScaleY.data();
+			batch.bodyType = bodyType.data();
+			batch.enableGravity = enableGravity.data();
+			batch.awake = awake.data();
+			batch.count = static_cast<int>(positionX.size());
+			return batch;
+		}
+	};
+
+	Bodies BuildBodies(const int count)
+	{
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> position(0.0f, 2000.0f);
+		std::uniform_real_distribution<float> velocity(-300.0f, 300.0f);
+		std::uniform_real_distribution<float> mass(100.0f, 5000.0f);
+
+		Bodies bodies;
+		for (int i = 0; i < count; i++)
+		{
+			const float body_mass = mass(random);
+			bodies.positionX.push_back(position(random));
+			bodies.positionY.push_back(position(random));
+			bodies.velocityX.push_back(velocity(random));
+			bodies.velocityY.push_back(velocity(random));
+			bodies.forceX.push_back(0.0f);
+			bodies.forceY.push_back(0.0f);
+			bodies.mass.push_back(body_mass);
+			bodies.inverseMass.push_back(1.0f / body_mass);
+			bodies.gravityScaleX.push_back(0.0f);
+			bodies.gravityScaleY.push_back(-1.0f);
+			const BodyType body_type = (i % 8 == 0) ? BodyType::STATIC : (i % 8 == 4) ? BodyType::KINEMATIC : BodyType::DYNAMIC;
+			bodies.bodyType.push_back(body_type);
+			bodies.enableGravity.push_back((body_type == BodyType::DYNAMIC) ? 1 : 0);
+			bodies.awake.push_back((i % 5 == 0) ? 0 : 1);
+		}
+		return bodies;
+	}
+
+	// Contact forces show up between steps in the game, add some so the force path is exercised
+	void AddForces(Bodies& bodies, const int step)
+	{
+		for (size_t i = step % 3; i < bodies.forceX.size(); i += 3)
+		{
+			bodies.forceX[i] += 50.0f;
+			bodies.forceY[i] -= 120.0f;
+		}
+	}
+
+	float MaxRelativeError(const std::vector<float>& expected, const std::vector<float>& actual)
+	{
+		float error = 0.0f;
+		for (size_t i = 0; i < expected.size(); i++)
+		{
+			const float scale = std::max(1.0f, std::abs(expected[i]));
+			error = std::max(error, std::abs(expected[i] - actual[i]) / scale);
+		}
+		return error;
+	}
+}
+
+int main()
+{
+	const int sizes[] = { 1000, 10000, 100000 };
+	bool all_passed = true;
+
+	printf("best path on this CPU: %s, %d steps\n", Integrator::GetName(Integrator::GetBestType()), STEPS);
+	printf("%-8s %-8s %12s %12s %12s\n", "bodies", "path", "us/step", "speedup", "max error");
+
+	for (const int size : sizes)
+	{
+		Bodies reference;
+		double scalar_time = 0.0;
+
+		for (int type = 0; type < static_cast<int>(IntegratorType::NUM_OF_TYPES); type++)
+		{
+			const IntegratorType integrator_type = static_cast<IntegratorType>(type);
+			if (!Integrator::IsSupported(integrator_type))
+			{
+				continue;
+			}
+
+			Bodies bodies = BuildBodies(size);
+
+			double total = 0.0;
+			for (int step = 0; step < STEPS; step++)
+			{
+				AddForces(bodies, step);
+
+				const auto start = std::chrono::high_resolution_clock::now();
+				Integrator::Integrate(integrator_type, bodies.GetBatch(), GRAVITY, AIR_FRICTION, DELTA_TIME);
+				const auto end = std::chrono::high_resolution_clock::now();
+				total += std::chrono::duration<double, std::micro>(end - start).count();
+			}
+			const double micro_seconds = total / STEPS;
+
+			float error = 0.0f;
+			if (integrator_type == IntegratorType::SCALAR)
+			{
+				reference = bodies;
+				scalar_time = micro_seconds;
+			}
+			else
+			{
+				error = std::max({ MaxRelativeError(reference.positionX, bodies.positionX), MaxRelativeError(reference.positionY, bodies.positionY),
+					MaxRelativeError(reference.velocityX, bodies.velocityX), MaxRelativeError(reference.velocityY, bodies.velocityY) });
+			}
+
+			const bool passed = error <= EPSILON && bodies.forceX == reference.forceX && bodies.forceY == reference.forceY;
+			all_passed = all_passed && passed;
+
+			printf("%-8d %-8s %12.1f %11.2fx %12.2e%s\n", size, Integrator::GetName(integrator_type), micro_seconds,
+				scalar_time / micro_seconds, error, passed ? "" : "  MISMATCH");
+		}
+	}
+
+	return all_passed ? 0 : 1;
+}
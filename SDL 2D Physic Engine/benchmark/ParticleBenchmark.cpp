@@ -0,0 +1,124 @@
+/*
+ * Headless particle benchmark. Keeps a pool topped up with bursts every frame until tens of thousands of
+ * particles are alive, like a stream of pigs popping and blocks shattering, times every update path the CPU
+ * supports and checks each one against the scalar path after all the frames.
+ *
+ * Build from this folder:
+ * g++ -O2 -std=c++17 -I../src -I../include/GLM ParticleBenchmark.cpp ../src/ParticlePool.cpp ../src/Integrator.cpp -o ParticleBenchmark
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Integrator.h"
+#include "ParticlePool.h"
+
+namespace
+{
+	constexpr int FRAMES = 600;
+	constexpr int CAPACITY = 65536;
+	constexpr float DELTA_TIME = 1.0f / 60.0f;
+	constexpr float DRAG = 0.99f;
+	constexpr float GROWTH = 2.0f;
+	const glm::vec2 GRAVITY = glm::vec2(0.0f, 918.0f);
+
+	// Relative error allowed between a SIMD path and the scalar path
+	constexpr float EPSILON = 1e-5f;
+
+	struct Result
+	{
+		double microSeconds = 0.0;
+		int averageCount = 0;
+	};
+
+	// Same bursts for every path, so the pools stay comparable particle for particle
+	Result Run(ParticlePool& pool, const IntegratorType type, const int spawns_per_frame)
+	{
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> position(0.0f, 800.0f);
+		std::uniform_real_distribution<float> velocity(-300.0f, 300.0f);
+		std::uniform_real_distribution<float> lifetime(0.5f, 1.8f);
+		std::uniform_real_distribution<float> size(3.0f, 7.0f);
+
+		double total = 0.0;
+		long long count = 0;
+		for (int frame = 0; frame < FRAMES; frame++)
+		{
+			for (int i = 0; i < spawns_per_frame; i++)
+			{
+				pool.Spawn(glm::vec2(position(random), position(random)), glm::vec2(velocity(random), velocity(random)),
+					lifetime(random), size(random));
+			}
+
+			const auto start = std::chrono::high_resolution_clock::now();
+			pool.Update(type, GRAVITY, DRAG, GROWTH, DELTA_TIME);
+			const auto end = std::chrono::high_resolution_clock::now();
+			total += std::chrono::duration<double, std::micro>(end - start).count();
+			count += pool.GetCount();
+		}
+
+		return { total / FRAMES, static_cast<int>(count / FRAMES) };
+	}
+
+	float MaxRelativeError(const std::vector<float>& expected, const std::vector<float>& actual, const int count)
+	{
+		float error = 0.0f;
+		for (int i = 0; i < count; i++)
+		{
+			const float scale = std::max(1.0f, std::abs(expected[i]));
+			error = std::max(error, std::abs(expected[i] - actual[i]) / scale);
+		}
+		return error;
+	}
+}
+
+int main()
+{
+	const int spawn_rates[] = { 100, 500, 1000 };
+	bool all_passed = true;
+
+	printf("best path on this CPU: %s, %d frames\n", Integrator::GetName(Integrator::GetBestType()), FRAMES);
+	printf("%-8s %-10s %-8s %12s %12s %12s\n", "spawns", "particles", "path", "us/frame", "speedup", "max error");
+
+	for (const int spawn_rate : spawn_rates)
+	{
+		ParticlePool reference(CAPACITY);
+		double scalar_time = 0.0;
+
+		for (int type = 0; type < static_cast<int>(IntegratorType::NUM_OF_TYPES); type++)
+		{
+			const IntegratorType update_type = static_cast<IntegratorType>(type);
+			if (!Integrator::IsSupported(update_type))
+			{
+				continue;
+			}
+
+			ParticlePool pool(CAPACITY);
+			const Result result = Run(pool, update_type, spawn_rate);
+
+			float error = 0.0f;
+			if (update_type == IntegratorType::SCALAR)
+			{
+				reference = pool;
+				scalar_time = result.microSeconds;
+			}
+			else
+			{
+				const int count = pool.GetCount();
+				error = std::max({ MaxRelativeError(reference.positionX, pool.positionX, count), MaxRelativeError(reference.positionY, pool.positionY, count),
+					MaxRelativeError(reference.alpha, pool.alpha, count), MaxRelativeError(reference.size, pool.size, count) });
+			}
+
+			const bool passed = error <= EPSILON && pool.GetCount() == reference.GetCount();
+			all_passed = all_passed && passed;
+
+			printf("%-8d %-10d %-8s %12.1f %11.2fx %12.2e%s\n", spawn_rate, result.averageCount, Integrator::GetName(update_type),
+				result.microSeconds, scalar_time / result.microSeconds, error, passed ? "" : "  MISMATCH");
+		}
+	}
+
+	return all_passed ? 0 : 1;
+}
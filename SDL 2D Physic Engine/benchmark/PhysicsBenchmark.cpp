@@ -0,0 +1,485 @@
+/*
+ * Headless benchmark of the whole PhysicsEngine step. Builds worlds procedurally (towers of blocks, a pile
+ * dropped into a box, a rain of circles, a mix of shapes over segment terrain and circles falling through a
+ * level of static blocks), steps them without a window and prints the timings and contact counts as JSON on stdout, progress goes to stderr.
+ *
+ * Build from this folder:
+ * g++ -O2 -std=c++17 -pthread -I../src -I../include/GLM PhysicsBenchmark.cpp ../src/PhysicsEngine.cpp
+ *     ../src/BodyStore.cpp ../src/RigidBody.cpp ../src/GameObject.cpp ../src/ContactSolver.cpp
+ *     ../src/Narrowphase.cpp ../src/Integrator.cpp ../src/StaticGeometry.cpp ../src/TimeOfImpact.cpp
+ *     ../src/WorkerPool.cpp ../src/AllPairsBroadphase.cpp ../src/SpatialHashBroadphase.cpp ../src/DynamicTree.cpp
+ *     ../src/DynamicTreeBroadphase.cpp ../src/SweepAndPruneBroadphase.cpp ../src/PhysicsProfiler.cpp
+ *     ../src/ConvexShape.cpp -o PhysicsBenchmark
+ *
+ * Options, all optional:
+ * --scene tower|pile|rain|mixed|level   --bodies N   --steps N   --broadphase all_pairs|spatial_hash|dynamic_tree|
+ * sweep_and_prune|all   --threads N   --iterations N   --substeps N   --no-warm-start   --no-sleep
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "GameObject.h"
+#include "PhysicsEngine.h"
+
+namespace
+{
+	constexpr float GRAVITY = -918.0f;
+	constexpr float DELTA_TIME = 0.016f;
+	constexpr int DEFAULT_STEPS = 120;
+
+	// Big worlds get fewer steps, no run steps more bodies than this in total
+	constexpr double BODY_STEP_BUDGET = 2000000.0;
+	constexpr int MIN_STEPS = 10;
+
+	// The all pairs broadphase is quadratic, past this it only proves the point slower
+	constexpr int ALL_PAIRS_LIMIT = 5000;
+
+	const char* SCENE_NAMES[] = { "tower", "pile", "rain", "mixed", "level" };
+	const char* BROADPHASE_NAMES[] = { "all_pairs", "spatial_hash", "dynamic_tree", "sweep_and_prune" };
+	const char* INTEGRATOR_NAMES[] = { "scalar", "sse", "avx" };
+	constexpr int SCENE_COUNT = 5;
+	constexpr int DEFAULT_SIZES[] = { 10, 100, 1000, 10000, 100000 };
+
+	struct BenchmarkObject : GameObject
+	{
+		void Draw() override {}
+		void Update() override {}
+		void Clean() override {}
+	};
+
+	struct Options
+	{
+		int scene = -1;
+		int bodies = -1;
+		int steps = -1;
+		int broadphase = static_cast<int>(BroadphaseType::SPATIAL_HASH);
+		bool allBroadphases = false;
+		int threads = 0;
+		int iterations = 8;
+		int substeps = 1;
+		bool warmStarting = true;
+		bool sleeping = true;
+	};
+
+	struct Result
+	{
+		int steps = 0;
+		double seconds = 0.0;
+		double maxStepSeconds = 0.0;
+		double candidatePairs = 0.0;
+		double contacts = 0.0;
+		int awakeBodies = 0;
+		int sleepingBodies = 0;
+	};
+
+	// Owns the game objects the rigid bodies live in, the engine only points at them
+	struct World
+	{
+		std::vector<std::unique_ptr<BenchmarkObject>> objects;
+
+		void AddBox(PhysicsEngine& engine, const glm::vec2 center, const int width, const int height, const float angle = 0.0f,
+			const BodyType body_type = BodyType::DYNAMIC)
+		{
+			RigidBody* body = Create(center);
+			objects.back()->SetWidth(width);
+			objects.back()->SetHeight(height);
+			body->angle = angle;
+			body->bodyType = body_type;
+			engine.AddRectangleObject(body);
+		}
+
+		void AddCapsule(PhysicsEngine& engine, const glm::vec2 center, const int width, const int height, const float angle)
+		{
+			RigidBody* body = Create(center);
+			objects.back()->SetWidth(width);
+			objects.back()->SetHeight(height);
+			body->angle = angle;
+			engine.AddCapsuleObject(body);
+		}
+
+		void AddCircle(PhysicsEngine& engine, const glm::vec2 center, const float radius, const glm::vec2 velocity)
+		{
+			RigidBody* body = Create(center);
+			objects.back()->SetWidth(static_cast<int>(radius * 2.0f));
+			objects.back()->SetHeight(static_cast<int>(radius * 2.0f));
+			body->radius = radius;
+			engine.AddCircleObject(body);
+			body->SetVelocity(velocity);
+		}
+
+	private:
+		RigidBody* Create(const glm::vec2 center)
+		{
+			objects.push_back(std::make_unique<BenchmarkObject>());
+			objects.back()->GetTransform()->position = center;
+
+			RigidBody* body = objects.back()->GetRigidBody();
+			body->restitution = 0.2f;
+			body->friction = 0.5f;
+			return body;
+		}
+	};
+
+	// Ground along y = 0, bodies fall towards +y
+	void AddGround(PhysicsEngine& engine)
+	{
+		engine.AddStaticPlane({ 0.0f, 0.0f }, { 0.0f, -1.0f }, 0.5f, 0.2f);
+	}
+
+	// Columns of ten 55x90 blocks at rest, like the PlayScene towers
+	void BuildTower(PhysicsEngine& engine, World& world, const int body_count)
+	{
+		AddGround(engine);
+
+		constexpr int tower_height = 10;
+		for (int i = 0; i < body_count; i++)
+		{
+			const int column = i / tower_height;
+			const int row = i % tower_height;
+			world.AddBox(engine, { column * 70.0f, -row * 90.0f - 45.0f }, 55, 90);
+		}
+	}
+
+	// Boxes and circles dropped from a grid into a box made of planes, ends up as a heap
+	void BuildPile(PhysicsEngine& engine, World& world, const int body_count)
+	{
+		const int columns = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(body_count))));
+		const float width = columns * 24.0f;
+
+		AddGround(engine);
+		engine.AddStaticPlane({ 0.0f, 0.0f }, { 1.0f, 0.0f }, 0.5f, 0.2f);
+		engine.AddStaticPlane({ width, 0.0f }, { -1.0f, 0.0f }, 0.5f, 0.2f);
+
+		for (int i = 0; i < body_count; i++)
+		{
+			const glm::vec2 center = { (i % columns) * 24.0f + 12.0f + ((i / columns) % 2) * 3.0f, -(i / columns) * 26.0f - 40.0f };
+			if (i % 2 == 0)
+			{
+				world.AddBox(engine, center, 20, 20);
+			}
+			else
+			{
+				world.AddCircle(engine, center, 10.0f, { 0.0f, 0.0f });
+			}
+		}
+	}
+
+	// Circles falling on the ground from random heights, nearly every body moves every step
+	void BuildRain(PhysicsEngine& engine, World& world, const int body_count)
+	{
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> position_x(0.0f, body_count * 4.0f + 100.0f);
+		std::uniform_real_distribution<float> position_y(-2000.0f, -20.0f);
+		std::uniform_real_distribution<float> speed(-50.0f, 50.0f);
+
+		AddGround(engine);
+		for (int i = 0; i < body_count; i++)
+		{
+			world.AddCircle(engine, { position_x(random), position_y(random) }, 8.0f, { speed(random), speed(random) + 200.0f });
+		}
+	}
+
+	// Boxes, turned planks, circles and capsules of random sizes over a zigzag of segments
+	void BuildMixed(PhysicsEngine& engine, World& world, const int body_count)
+	{
+		std::mt19937 random(7);
+		const float width = std::sqrt(static_cast<float>(body_count)) * 60.0f + 200.0f;
+		std::uniform_real_distribution<float> position_x(0.0f, width);
+		std::uniform_real_distribution<float> position_y(-width, -60.0f);
+		std::uniform_int_distribution<int> size(10, 40);
+		std::uniform_real_distribution<float> angle(0.0f, 180.0f);
+
+		AddGround(engine);
+		for (float x = 0.0f; x < width; x += 100.0f)
+		{
+			const float y = (static_cast<int>(x / 100.0f) % 2 == 0) ? -20.0f : -50.0f;
+			const float next_y = (y == -20.0f) ? -50.0f : -20.0f;
+			engine.AddStaticSegment({ x, y }, { x + 100.0f, next_y }, 0.5f, 0.2f);
+		}
+
+		for (int i = 0; i < body_count; i++)
+		{
+			const glm::vec2 center = { position_x(random), position_y(random) };
+			switch (i % 4)
+			{
+			case 0:
+				world.AddBox(engine, center, size(random), size(random));
+				break;
+			case 1:
+				world.AddCircle(engine, center, size(random) * 0.5f, { 0.0f, 0.0f });
+				break;
+			case 2:
+				world.AddBox(engine, center, size(random) * 2, size(random) / 2, angle(random));
+				break;
+			default:
+				world.AddCapsule(engine, center, size(random) * 2, size(random), angle(random));
+				break;
+			}
+		}
+	}
+
+	// Half the bodies are static blocks staggered like pegs, the other half circles dropped through them
+	void BuildLevel(PhysicsEngine& engine, World& world, const int body_count)
+	{
+		const int static_count = body_count / 2;
+		const int columns = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(static_count))));
+		const float width = columns * 60.0f;
+
+		AddGround(engine);
+		for (int i = 0; i < static_count; i++)
+		{
+			const int row = i / columns;
+			const float x = (i % columns) * 60.0f + (row % 2) * 30.0f + 30.0f;
+			world.AddBox(engine, { x, -row * 50.0f - 60.0f }, 30, 10, 0.0f, BodyType::STATIC);
+		}
+
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> position_x(0.0f, width);
+		const float top = -(static_count / columns + 1) * 50.0f - 60.0f;
+		for (int i = static_count; i < body_count; i++)
+		{
+			world.AddCircle(engine, { position_x(random), top - (i - static_count) * 2.0f }, 8.0f, { 0.0f, 0.0f });
+		}
+	}
+
+	Result Run(const Options& options, const int scene, const int body_count, const BroadphaseType broadphase)
+	{
+		PhysicsEngine engine;
+		engine.SetGravity(GRAVITY);
+		engine.SetFriction(1.0f);
+		engine.SetOnSlingshot(false);
+		engine.SetBroadphaseType(broadphase);
+		engine.SetThreadCount(options.threads);
+		engine.SetSubsteps(options.substeps);
+		engine.SetFixedDeltaTime(DELTA_TIME);
+		engine.SetSleepEnabled(options.sleeping);
+		engine.GetSolver().SetVelocityIterations(options.iterations);
+		engine.GetSolver().SetWarmStarting(options.warmStarting);
+
+		World world;
+		world.objects.reserve(body_count);
+		switch (scene)
+		{
+		case 0:
+			BuildTower(engine, world, body_count);
+			break;
+		case 1:
+			BuildPile(engine, world, body_count);
+			break;
+		case 2:
+			BuildRain(engine, world, body_count);
+			break;
+		case 3:
+			BuildMixed(engine, world, body_count);
+			break;
+		default:
+			BuildLevel(engine, world, body_count);
+			break;
+		}
+
+		Result result;
+		result.steps = (options.steps > 0) ? options.steps :
+			std::max(MIN_STEPS, std::min(DEFAULT_STEPS, static_cast<int>(BODY_STEP_BUDGET / body_count)));
+
+		for (int step = 0; step < result.steps; step++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			engine.UpdatePhysics();
+			const auto end = std::chrono::steady_clock::now();
+
+			const double seconds = std::chrono::duration<double>(end - start).count();
+			result.seconds += seconds;
+			result.maxStepSeconds = std::max(result.maxStepSeconds, seconds);
+			result.candidatePairs += engine.GetCandidatePairCount();
+			result.contacts += engine.GetManifoldCount();
+		}
+
+		result.candidatePairs /= result.steps;
+		result.contacts /= result.steps;
+		result.awakeBodies = engine.GetAwakeBodyCount();
+		result.sleepingBodies = engine.GetSleepingBodyCount();
+		return result;
+	}
+
+	int FindName(const char* name, const char* const* names, const int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (std::strcmp(name, names[i]) == 0)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	bool ParseOptions(const int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const std::string option = argv[i];
+			const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+			if (option == "--no-warm-start")
+			{
+				options.warmStarting = false;
+				continue;
+			}
+			if (option == "--no-sleep")
+			{
+				options.sleeping = false;
+				continue;
+			}
+			if (value == nullptr)
+			{
+				fprintf(stderr, "%s needs a value\n", option.c_str());
+				return false;
+			}
+			i++;
+
+			if (option == "--scene")
+			{
+				options.scene = FindName(value, SCENE_NAMES, SCENE_COUNT);
+				if (options.scene == -1)
+				{
+					fprintf(stderr, "unknown scene %s\n", value);
+					return false;
+				}
+			}
+			else if (option == "--broadphase")
+			{
+				options.allBroadphases = std::strcmp(value, "all") == 0;
+				options.broadphase = options.allBroadphases ? 0 :
+					FindName(value, BROADPHASE_NAMES, static_cast<int>(BroadphaseType::NUM_OF_TYPES));
+				if (options.broadphase == -1)
+				{
+					fprintf(stderr, "unknown broadphase %s\n", value);
+					return false;
+				}
+			}
+			else if (option == "--bodies")
+			{
+				options.bodies = std::max(1, std::atoi(value));
+			}
+			else if (option == "--steps")
+			{
+				options.steps = std::max(1, std::atoi(value));
+			}
+			else if (option == "--threads")
+			{
+				options.threads = std::max(0, std::atoi(value));
+			}
+			else if (option == "--iterations")
+			{
+				options.iterations = std::max(1, std::atoi(value));
+			}
+			else if (option == "--substeps")
+			{
+				options.substeps = std::max(1, std::atoi(value));
+			}
+			else
+			{
+				fprintf(stderr, "unknown option %s\n", option.c_str());
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	std::vector<int> scenes;
+	for (int scene = 0; scene < SCENE_COUNT; scene++)
+	{
+		if (options.scene == -1 || options.scene == scene)
+		{
+			scenes.push_back(scene);
+		}
+	}
+
+	std::vector<int> sizes;
+	if (options.bodies > 0)
+	{
+		sizes.push_back(options.bodies);
+	}
+	else
+	{
+		sizes.assign(std::begin(DEFAULT_SIZES), std::end(DEFAULT_SIZES));
+	}
+
+	std::vector<int> broadphases;
+	for (int type = 0; type < static_cast<int>(BroadphaseType::NUM_OF_TYPES); type++)
+	{
+		if (options.allBroadphases || options.broadphase == type)
+		{
+			broadphases.push_back(type);
+		}
+	}
+
+	// Thread count as the engine reports it, 0 asks for every hardware thread
+	int thread_count = 0;
+	IntegratorType integrator;
+	{
+		PhysicsEngine engine;
+		engine.SetThreadCount(options.threads);
+		thread_count = engine.GetThreadCount();
+		integrator = engine.GetIntegratorType();
+	}
+
+	printf("{\n");
+	printf("  \"benchmark\": \"physics\",\n");
+	printf("  \"delta_time\": %g,\n", DELTA_TIME);
+	printf("  \"threads\": %d,\n", thread_count);
+	printf("  \"integrator\": \"%s\",\n", INTEGRATOR_NAMES[static_cast<int>(integrator)]);
+	printf("  \"velocity_iterations\": %d,\n", options.iterations);
+	printf("  \"substeps\": %d,\n", options.substeps);
+	printf("  \"warm_starting\": %s,\n", options.warmStarting ? "true" : "false");
+	printf("  \"sleeping\": %s,\n", options.sleeping ? "true" : "false");
+	printf("  \"results\": [");
+
+	bool first = true;
+	for (const int scene : scenes)
+	{
+		for (const int size : sizes)
+		{
+			for (const int type : broadphases)
+			{
+				if (type == static_cast<int>(BroadphaseType::ALL_PAIRS) && size > ALL_PAIRS_LIMIT && options.allBroadphases)
+				{
+					continue;
+				}
+
+				fprintf(stderr, "%s, %d bodies, %s...\n", SCENE_NAMES[scene], size, BROADPHASE_NAMES[type]);
+				const Result result = Run(options, scene, size, static_cast<BroadphaseType>(type));
+
+				printf("%s\n    {\"scene\": \"%s\", \"bodies\": %d, \"broadphase\": \"%s\", \"steps\": %d, ",
+					first ? "" : ",", SCENE_NAMES[scene], size, BROADPHASE_NAMES[type], result.steps);
+				printf("\"total_ms\": %.3f, \"steps_per_second\": %.2f, \"max_step_ms\": %.3f, \"ns_per_body\": %.2f, ",
+					result.seconds * 1e3, result.steps / result.seconds, result.maxStepSeconds * 1e3,
+					result.seconds * 1e9 / (static_cast<double>(result.steps) * size));
+				printf("\"candidate_pairs\": %.1f, \"contacts\": %.1f, \"awake_bodies\": %d, \"sleeping_bodies\": %d}",
+					result.candidatePairs, result.contacts, result.awakeBodies, result.sleepingBodies);
+				fflush(stdout);
+				first = false;
+			}
+		}
+	}
+
+	printf("\n  ]\n}\n");
+	return 0;
+}
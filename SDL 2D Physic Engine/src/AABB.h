@@ -0,0 +1,91 @@
+#pragma once
+#ifndef __AABB__
+#define __AABB__
+#include <cmath>
+#include <glm/vec2.hpp>
+#include <glm/common.hpp>
+
+// Axis aligned bounding box used by the broadphase
+struct AABB
+{
+	glm::vec2 min = glm::vec2(0, 0);
+	glm::vec2 max = glm::vec2(0, 0);
+
+	[[nodiscard]] bool Overlaps(const AABB& other) const
+	{
+		return min.x <= other.max.x && max.x >= other.min.x &&
+			min.y <= other.max.y && max.y >= other.min.y;
+	}
+
+	[[nodiscard]] bool Contains(const AABB& other) const
+	{
+		return min.x <= other.min.x && min.y <= other.min.y &&
+			max.x >= other.max.x && max.y >= other.max.y;
+	}
+
+	[[nodiscard]] glm::vec2 GetCenter() const
+	{
+		return (min + max) * 0.5f;
+	}
+
+	[[nodiscard]] glm::vec2 GetExtents() const
+	{
+		return (max - min) * 0.5f;
+	}
+
+	// Perimeter is the surface area heuristic in 2D
+	[[nodiscard]] float GetPerimeter() const
+	{
+		return 2.0f * ((max.x - min.x) + (max.y - min.y));
+	}
+
+	[[nodiscard]] AABB Grow(const float amount) const
+	{
+		return { min - glm::vec2(amount, amount), max + glm::vec2(amount, amount) };
+	}
+
+	// Fraction of the move from start by translation at which it enters the box, 0 when it starts inside.
+	// False if it misses the box or only gets there past max_fraction
+	[[nodiscard]] bool RayCast(const glm::vec2 start, const glm::vec2 translation, const float max_fraction, float& fraction) const
+	{
+		float enter = 0.0f;
+		float exit = max_fraction;
+
+		for (int axis = 0; axis < 2; axis++)
+		{
+			if (std::abs(translation[axis]) < 1e-6f)
+			{
+				if (start[axis] < min[axis] || start[axis] > max[axis])
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const float inverse = 1.0f / translation[axis];
+			const float near_side = (min[axis] - start[axis]) * inverse;
+			const float far_side = (max[axis] - start[axis]) * inverse;
+			enter = std::fmax(enter, std::fmin(near_side, far_side));
+			exit = std::fmin(exit, std::fmax(near_side, far_side));
+			if (enter > exit)
+			{
+				return false;
+			}
+		}
+
+		fraction = enter;
+		return true;
+	}
+
+	static AABB FromCenter(const glm::vec2 center, const glm::vec2 half_extents)
+	{
+		return { center - half_extents, center + half_extents };
+	}
+
+	static AABB Union(const AABB& a, const AABB& b)
+	{
+		return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+	}
+};
+
+#endif /* defined (__AABB__) */
@@ -0,0 +1,94 @@
+#include "AllPairsBroadphase.h"
+
+int AllPairsBroadphase::CreateProxy(const AABB& aabb)
+{
+	int proxy_id;
+	if (!m_freeProxies.empty())
+	{
+		proxy_id = m_freeProxies.back();
+		m_freeProxies.pop_back();
+	}
+	else
+	{
+		proxy_id = static_cast<int>(m_aabbs.size());
+		m_aabbs.emplace_back();
+		m_active.push_back(false);
+	}
+
+	m_aabbs[proxy_id] = aabb;
+	m_active[proxy_id] = true;
+	m_proxyCount++;
+
+	return proxy_id;
+}
+
+void AllPairsBroadphase::DestroyProxy(const int proxy_id)
+{
+	m_active[proxy_id] = false;
+	m_freeProxies.push_back(proxy_id);
+	m_proxyCount--;
+}
+
+void AllPairsBroadphase::MoveProxy(const int proxy_id, const AABB& aabb)
+{
+	m_aabbs[proxy_id] = aabb;
+}
+
+void AllPairsBroadphase::UpdatePairs(std::vector<BroadphasePair>& pairs)
+{
+	pairs.clear();
+
+	const int count = static_cast<int>(m_aabbs.size());
+	for (int i = 0; i < count; i++)
+	{
+		if (!m_active[i])
+		{
+			continue;
+		}
+
+		for (int j = i + 1; j < count; j++)
+		{
+			if (m_active[j] && m_aabbs[i].Overlaps(m_aabbs[j]))
+			{
+				pairs.push_back({ i, j });
+			}
+		}
+	}
+}
+
+void AllPairsBroadphase::Query(const AABB& aabb, std::vector<int>& proxies) const
+{
+	proxies.clear();
+
+	const int count = static_cast<int>(m_aabbs.size());
+	for (int i = 0; i < count; i++)
+	{
+		if (m_active[i] && m_aabbs[i].Overlaps(aabb))
+		{
+			proxies.push_back(i);
+		}
+	}
+}
+
+void AllPairsBroadphase::RayCast(const RayCastInput& input, float max_fraction, const RayCastCallback& callback) const
+{
+	const int count = static_cast<int>(m_aabbs.size());
+	for (int i = 0; i < count && max_fraction > 0.0f; i++)
+	{
+		float enter;
+		if (m_active[i] && m_aabbs[i].Grow(input.radius).RayCast(input.start, input.translation, max_fraction, enter))
+		{
+			max_fraction = callback(i, max_fraction);
+		}
+	}
+}
+
+int AllPairsBroadphase::GetProxyCount() const
+{
+	return m_proxyCount;
+}
+
+BroadphaseType AllPairsBroadphase::GetType() const
+{
+	return BroadphaseType::ALL_PAIRS;
+}
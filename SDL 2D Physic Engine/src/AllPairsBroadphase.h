@@ -0,0 +1,30 @@
+#pragma once
+#ifndef __ALL_PAIRS_BROADPHASE__
+#define __ALL_PAIRS_BROADPHASE__
+#include "Broadphase.h"
+
+/*
+ * Reference broadphase that tests every proxy against every other proxy.
+ * This is the cost the old nested list loops paid and is kept to benchmark the other modes against
+ */
+class AllPairsBroadphase final : public Broadphase
+{
+public:
+	int CreateProxy(const AABB& aabb) override;
+	void DestroyProxy(int proxy_id) override;
+	void MoveProxy(int proxy_id, const AABB& aabb) override;
+	void UpdatePairs(std::vector<BroadphasePair>& pairs) override;
+	void Query(const AABB& aabb, std::vector<int>& proxies) const override;
+	void RayCast(const RayCastInput& input, float max_fraction, const RayCastCallback& callback) const override;
+
+	[[nodiscard]] int GetProxyCount() const override;
+	[[nodiscard]] BroadphaseType GetType() const override;
+
+private:
+	std::vector<AABB> m_aabbs;
+	std::vector<bool> m_active;
+	std::vector<int> m_freeProxies;
+	int m_proxyCount = 0;
+};
+
+#endif /* defined (__ALL_PAIRS_BROADPHASE__) */
@@ -2,6 +2,7 @@
 
 
 #include "SoundManager.h"
+#include "SpriteBatch.h"
 #include "TextureManager.h"
 
 BigBlock::BigBlock(int w, int h)
@@ -23,7 +24,7 @@ BigBlock::BigBlock(int w, int h)
 	GetTransform()->position = glm::vec2(300.0f, 300.0f);
 
 	SetType(GameObjectType::OBSTACLE);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 
 
 }
@@ -33,7 +34,7 @@ BigBlock::~BigBlock()
 
 void BigBlock::Draw()
 {
-	TextureManager::Instance().Draw("BigBlock", GetTransform()->position, 0, 255, true);
+	SpriteBatch::Instance().Draw("BigBlock", GetTransform()->position, 0, 255, true);
 }
 
 void BigBlock::Update()
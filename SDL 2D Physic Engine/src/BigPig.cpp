@@ -1,5 +1,6 @@
 #include "BigPig.h"
 #include "SoundManager.h"
+#include "SpriteBatch.h"
 #include "TextureManager.h"
 
 BigPig::BigPig(int w, int h)
@@ -19,7 +20,7 @@ BigPig::BigPig(int w, int h)
 	GetTransform()->position = glm::vec2(300.0f, 300.0f);
 
 	SetType(GameObjectType::PIG);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 }
 
 BigPig::~BigPig()
@@ -27,7 +28,7 @@ BigPig::~BigPig()
 
 void BigPig::Draw()
 {
-	TextureManager::Instance().Draw("BigPig", GetTransform()->position, 0, 255, true);
+	SpriteBatch::Instance().Draw("BigPig", GetTransform()->position, 0, 255, true);
 }
 
 void BigPig::Update()
@@ -2,6 +2,7 @@
 
 
 #include "SoundManager.h"
+#include "SpriteBatch.h"
 #include "TextureManager.h"
 
 Block::Block(int w, int h)
@@ -21,7 +22,7 @@ Block::Block(int w, int h)
 	GetTransform()->position = glm::vec2(300.0f, 300.0f);
 
 	SetType(GameObjectType::OBSTACLE);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 
 
 }
@@ -31,7 +32,7 @@ Block::~Block()
 
 void Block::Draw()
 {
-	TextureManager::Instance().Draw("Block", GetTransform()->position, 0, 255, true);
+	SpriteBatch::Instance().Draw("Block", GetTransform()->position, this, 0, 255, true);
 }
 
 void Block::Update()
@@ -0,0 +1,33 @@
+#pragma once
+#ifndef __BODY_HANDLE__
+#define __BODY_HANDLE__
+#include <cstdint>
+
+/*
+ * Stable reference to a body in the BodyStore. The slot never moves while the body lives, and the
+ * generation is bumped every time the slot is freed so an old handle no longer resolves
+ */
+struct BodyHandle
+{
+	static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFF;
+
+	uint32_t slot = INVALID_SLOT;
+	uint32_t generation = 0;
+
+	[[nodiscard]] bool IsValid() const
+	{
+		return slot != INVALID_SLOT;
+	}
+
+	bool operator==(const BodyHandle& other) const
+	{
+		return slot == other.slot && generation == other.generation;
+	}
+
+	bool operator!=(const BodyHandle& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+#endif /* defined (__BODY_HANDLE__) */
@@ -0,0 +1,456 @@
+#include "BodyStore.h"
+#include <algorithm>
+#include "GameObject.h"
+
+BodyHandle BodyStore::Add(RigidBody* rb, const ConvexShape& hull)
+{
+	uint32_t slot;
+	if (!m_freeSlots.empty())
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		slot = static_cast<uint32_t>(m_slotIndex.size());
+		m_slotIndex.push_back(0);
+		m_slotGeneration.push_back(0);
+	}
+
+	m_slotIndex[slot] = static_cast<uint32_t>(GetCount());
+	m_indexSlot.push_back(slot);
+	PushBack(rb, hull);
+
+	const BodyHandle handle = { slot, m_slotGeneration[slot] };
+	rb->handle = handle;
+	rb->store = this;
+	return handle;
+}
+
+int BodyStore::Remove(const BodyHandle handle)
+{
+	if (!IsValid(handle))
+	{
+		return -1;
+	}
+
+	const int index = GetIndex(handle);
+
+	// Hand the simulated state back so the body can be added again later
+	Release(index);
+
+	m_slotGeneration[handle.slot]++;
+	m_freeSlots.push_back(handle.slot);
+
+	const int last = GetCount() - 1;
+	int moved = -1;
+	if (index != last)
+	{
+		MoveBody(last, index);
+		m_indexSlot[index] = m_indexSlot[last];
+		m_slotIndex[m_indexSlot[index]] = static_cast<uint32_t>(index);
+		moved = index;
+	}
+
+	m_indexSlot.pop_back();
+	PopBack();
+
+	return moved;
+}
+
+bool BodyStore::IsValid(const BodyHandle handle) const
+{
+	return handle.slot < m_slotGeneration.size() && m_slotGeneration[handle.slot] == handle.generation;
+}
+
+int BodyStore::GetIndex(const BodyHandle handle) const
+{
+	return static_cast<int>(m_slotIndex[handle.slot]);
+}
+
+BodyHandle BodyStore::GetHandle(const int index) const
+{
+	const uint32_t slot = m_indexSlot[index];
+	return { slot, m_slotGeneration[slot] };
+}
+
+int BodyStore::GetCount() const
+{
+	return static_cast<int>(positionX.size());
+}
+
+glm::vec2 BodyStore::GetPosition(const int index) const
+{
+	return { positionX[index], positionY[index] };
+}
+
+void BodyStore::SetPosition(const int index, const glm::vec2 position)
+{
+	positionX[index] = position.x;
+	positionY[index] = position.y;
+}
+
+void BodyStore::Teleport(const int index, const glm::vec2 position)
+{
+	SetPosition(index, position);
+	previousPositionX[index] = position.x;
+	previousPositionY[index] = position.y;
+
+	const BodyHandle handle = GetHandle(index);
+	if (std::find(m_teleported.begin(), m_teleported.end(), handle) == m_teleported.end())
+	{
+		m_teleported.push_back(handle);
+	}
+}
+
+const std::vector<BodyHandle>& BodyStore::GetTeleported() const
+{
+	return m_teleported;
+}
+
+void BodyStore::ClearTeleported()
+{
+	m_teleported.clear();
+}
+
+glm::vec2 BodyStore::GetVelocity(const int index) const
+{
+	return { velocityX[index], velocityY[index] };
+}
+
+void BodyStore::SetVelocity(const int index, const glm::vec2 velocity)
+{
+	velocityX[index] = velocity.x;
+	velocityY[index] = velocity.y;
+}
+
+glm::vec2 BodyStore::GetForce(const int index) const
+{
+	return { forceX[index], forceY[index] };
+}
+
+void BodyStore::SetForce(const int index, const glm::vec2 force)
+{
+	forceX[index] = force.x;
+	forceY[index] = force.y;
+}
+
+void BodyStore::SetMass(const int index, const float new_mass)
+{
+	mass[index] = new_mass;
+	inverseMass[index] = (new_mass > 0.0f) ? 1.0f / new_mass : 0.0f;
+}
+
+void BodyStore::SetCollisionFilter(const int index, const uint32_t layer, const uint32_t mask)
+{
+	collisionLayer[index] = layer;
+	collisionMask[index] = mask;
+	Wake(index);
+}
+
+bool BodyStore::IsAwake(const int index) const
+{
+	return awake[index] != 0;
+}
+
+bool BodyStore::IsStatic(const int index) const
+{
+	return bodyType[index] == BodyType::STATIC;
+}
+
+void BodyStore::Wake(const int index)
+{
+	awake[index] = 1;
+	stillSteps[index] = 0;
+}
+
+void BodyStore::Sleep(const int index)
+{
+	awake[index] = 0;
+	velocityX[index] = 0.0f;
+	velocityY[index] = 0.0f;
+	forceX[index] = 0.0f;
+	forceY[index] = 0.0f;
+}
+
+IntegrationBatch BodyStore::GetIntegrationBatch()
+{
+	IntegrationBatch batch;
+	batch.positionX = positionX.data();
+	batch.positionY = positionY.data();
+	batch.velocityX = velocityX.data();
+	batch.velocityY = velocityY.data();
+	batch.forceX = forceX.data();
+	batch.forceY = forceY.data();
+	batch.mass = mass.data();
+	batch.inverseMass = inverseMass.data();
+	batch.gravityScaleX = gravityScaleX.data();
+	batch.gravityScaleY = gravityScaleY.data();
+	batch.bodyType = bodyType.data();
+	batch.enableGravity = enableGravity.data();
+	batch.awake = awake.data();
+	batch.count = GetCount();
+	return batch;
+}
+
+void BodyStore::SavePreviousPositions()
+{
+	previousPositionX = positionX;
+	previousPositionY = positionY;
+}
+
+void BodyStore::SyncTransforms(const float alpha) const
+{
+	const int count = GetCount();
+	for (int i = 0; i < count; i++)
+	{
+		transform[i]->position.x = previousPositionX[i] + (positionX[i] - previousPositionX[i]) * alpha;
+		transform[i]->position.y = previousPositionY[i] + (positionY[i] - previousPositionY[i]) * alpha;
+	}
+}
+
+void BodyStore::PushBack(RigidBody* rb, const ConvexShape& hull)
+{
+	GameObject* game_object = rb->gameObject;
+	const glm::vec2 position = game_object->GetTransform()->position;
+
+	positionX.push_back(position.x);
+	positionY.push_back(position.y);
+	previousPositionX.push_back(position.x);
+	previousPositionY.push_back(position.y);
+	velocityX.push_back(rb->velocity.x);
+	velocityY.push_back(rb->velocity.y);
+	forceX.push_back(rb->netForce.x);
+	forceY.push_back(rb->netForce.y);
+	mass.push_back(rb->mass);
+	inverseMass.push_back((rb->mass > 0.0f) ? 1.0f / rb->mass : 0.0f);
+	const float width = static_cast<float>(game_object->GetWidth());
+	const float height = static_cast<float>(game_object->GetHeight());
+	const ConvexShape body_convex = ConvexShape::Make(rb->shape, width, height, rb->radius, rb->angle, hull);
+
+	// Turned boxes are polygons to the narrowphase, the box routines only handle axis aligned ones
+	const CollisionShape body_shape = (rb->shape == CollisionShape::RECTANGLE && rb->angle != 0.0f) ? CollisionShape::POLYGON : rb->shape;
+	const bool bounded_by_size = body_shape == CollisionShape::CIRCLE || body_shape == CollisionShape::RECTANGLE ||
+		body_shape == CollisionShape::NO_COLLIDER;
+	const glm::vec2 half_extents = bounded_by_size ? glm::vec2(width, height) * 0.5f : body_convex.GetHalfExtents();
+
+	radius.push_back((body_shape == CollisionShape::CAPSULE) ? body_convex.radius : rb->radius);
+	halfWidth.push_back(half_extents.x);
+	halfHeight.push_back(half_extents.y);
+	restitution.push_back(rb->restitution);
+	friction.push_back(rb->friction);
+	gravityScaleX.push_back(rb->gravityScale.x);
+	gravityScaleY.push_back(rb->gravityScale.y);
+	const BodyType body_type = (rb->bodyType == BodyType::DYNAMIC && !rb->enableGravity) ? BodyType::STATIC : rb->bodyType;
+	bodyType.push_back(body_type);
+	enableGravity.push_back((body_type == BodyType::DYNAMIC) ? 1 : 0);
+	awake.push_back(1);
+	continuousCollision.push_back(rb->continuousCollision ? 1 : 0);
+	stillSteps.push_back(0);
+	collisionLayer.push_back(rb->collisionLayer);
+	collisionMask.push_back(rb->collisionMask);
+	shape.push_back(body_shape);
+	convex.push_back(body_convex);
+	proxyId.push_back(-1);
+	owner.push_back(rb);
+	transform.push_back(game_object->GetTransform());
+}
+
+void BodyStore::MoveBody(const int from, const int to)
+{
+	positionX[to] = positionX[from];
+	positionY[to] = positionY[from];
+	previousPositionX[to] = previousPositionX[from];
+	previousPositionY[to] = previousPositionY[from];
+	velocityX[to] = velocityX[from];
+	velocityY[to] = velocityY[from];
+	forceX[to] = forceX[from];
+	forceY[to] = forceY[from];
+	mass[to] = mass[from];
+	inverseMass[to] = inverseMass[from];
+	radius[to] = radius[from];
+	halfWidth[to] = halfWidth[from];
+	halfHeight[to] = halfHeight[from];
+	restitution[to] = restitution[from];
+	friction[to] = friction[from];
+	gravityScaleX[to] = gravityScaleX[from];
+	gravityScaleY[to] = gravityScaleY[from];
+	bodyType[to] = bodyType[from];
+	enableGravity[to] = enableGravity[from];
+	awake[to] = awake[from];
+	continuousCollision[to] = continuousCollision[from];
+	stillSteps[to] = stillSteps[from];
+	collisionLayer[to] = collisionLayer[from];
+	collisionMask[to] = collisionMask[from];
+	shape[to] = shape[from];
+	convex[to] = convex[from];
+	proxyId[to] = proxyId[from];
+	owner[to] = owner[from];
+	transform[to] = transform[from];
+}
+
+void BodyStore::PopBack()
+{
+	positionX.pop_back();
+	positionY.pop_back();
+	previousPositionX.pop_back();
+	previousPositionY.pop_back();
+	velocityX.pop_back();
+	velocityY.pop_back();
+	forceX.pop_back();
+	forceY.pop_back();
+	mass.pop_back();
+	inverseMass.pop_back();
+	radius.pop_back();
+	halfWidth.pop_back();
+	halfHeight.pop_back();
+	restitution.pop_back();
+	friction.pop_back();
+	gravityScaleX.pop_back();
+	gravityScaleY.pop_back();
+	bodyType.pop_back();
+	enableGravity.pop_back();
+	awake.pop_back();
+	continuousCollision.pop_back();
+	stillSteps.pop_back();
+	collisionLayer.pop_back();
+	collisionMask.pop_back();
+	shape.pop_back();
+	convex.pop_back();
+	proxyId.pop_back();
+	owner.pop_back();
+	transform.pop_back();
+}
+
+void BodyStore::Save(WorldSnapshot& snapshot) const
+{
+	snapshot.Write(static_cast<uint32_t>(GetCount()));
+	snapshot.Write(static_cast<uint32_t>(m_slotIndex.size()));
+	snapshot.Write(static_cast<uint32_t>(m_freeSlots.size()));
+
+	snapshot.WriteColumn(positionX);
+	snapshot.WriteColumn(positionY);
+	snapshot.WriteColumn(previousPositionX);
+	snapshot.WriteColumn(previousPositionY);
+	snapshot.WriteColumn(velocityX);
+	snapshot.WriteColumn(velocityY);
+	snapshot.WriteColumn(forceX);
+	snapshot.WriteColumn(forceY);
+	snapshot.WriteColumn(mass);
+	snapshot.WriteColumn(inverseMass);
+	snapshot.WriteColumn(radius);
+	snapshot.WriteColumn(halfWidth);
+	snapshot.WriteColumn(halfHeight);
+	snapshot.WriteColumn(restitution);
+	snapshot.WriteColumn(friction);
+	snapshot.WriteColumn(gravityScaleX);
+	snapshot.WriteColumn(gravityScaleY);
+	snapshot.WriteColumn(bodyType);
+	snapshot.WriteColumn(enableGravity);
+	snapshot.WriteColumn(awake);
+	snapshot.WriteColumn(continuousCollision);
+	snapshot.WriteColumn(stillSteps);
+	snapshot.WriteColumn(collisionLayer);
+	snapshot.WriteColumn(collisionMask);
+	snapshot.WriteColumn(shape);
+	snapshot.WriteColumn(convex);
+	snapshot.WriteColumn(proxyId);
+
+	snapshot.WriteColumn(m_slotIndex);
+	snapshot.WriteColumn(m_indexSlot);
+	snapshot.WriteColumn(m_freeSlots);
+}
+
+bool BodyStore::Restore(const WorldSnapshot& snapshot, size_t& offset, const std::vector<RigidBody*>& owners)
+{
+	uint32_t count = 0;
+	uint32_t slot_count = 0;
+	uint32_t free_count = 0;
+	if (!snapshot.Read(offset, count) || !snapshot.Read(offset, slot_count) || !snapshot.Read(offset, free_count) ||
+		owners.size() != count)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < GetCount(); i++)
+	{
+		Release(i);
+	}
+
+	const bool read = snapshot.ReadColumn(offset, positionX, count) &&
+		snapshot.ReadColumn(offset, positionY, count) &&
+		snapshot.ReadColumn(offset, previousPositionX, count) &&
+		snapshot.ReadColumn(offset, previousPositionY, count) &&
+		snapshot.ReadColumn(offset, velocityX, count) &&
+		snapshot.ReadColumn(offset, velocityY, count) &&
+		snapshot.ReadColumn(offset, forceX, count) &&
+		snapshot.ReadColumn(offset, forceY, count) &&
+		snapshot.ReadColumn(offset, mass, count) &&
+		snapshot.ReadColumn(offset, inverseMass, count) &&
+		snapshot.ReadColumn(offset, radius, count) &&
+		snapshot.ReadColumn(offset, halfWidth, count) &&
+		snapshot.ReadColumn(offset, halfHeight, count) &&
+		snapshot.ReadColumn(offset, restitution, count) &&
+		snapshot.ReadColumn(offset, friction, count) &&
+		snapshot.ReadColumn(offset, gravityScaleX, count) &&
+		snapshot.ReadColumn(offset, gravityScaleY, count) &&
+		snapshot.ReadColumn(offset, bodyType, count) &&
+		snapshot.ReadColumn(offset, enableGravity, count) &&
+		snapshot.ReadColumn(offset, awake, count) &&
+		snapshot.ReadColumn(offset, continuousCollision, count) &&
+		snapshot.ReadColumn(offset, stillSteps, count) &&
+		snapshot.ReadColumn(offset, collisionLayer, count) &&
+		snapshot.ReadColumn(offset, collisionMask, count) &&
+		snapshot.ReadColumn(offset, shape, count) &&
+		snapshot.ReadColumn(offset, convex, count) &&
+		snapshot.ReadColumn(offset, proxyId, count) &&
+		snapshot.ReadColumn(offset, m_slotIndex, slot_count) &&
+		snapshot.ReadColumn(offset, m_indexSlot, count) &&
+		snapshot.ReadColumn(offset, m_freeSlots, free_count);
+
+	if (!read)
+	{
+		return false;
+	}
+
+	// Slots made since the snapshot stay, free, so their generations are never handed out again
+	const uint32_t generation_count = static_cast<uint32_t>(m_slotGeneration.size());
+	for (uint32_t slot = slot_count; slot < generation_count; slot++)
+	{
+		m_slotIndex.push_back(0);
+		m_freeSlots.push_back(slot);
+	}
+
+	m_slotGeneration.resize(m_slotIndex.size(), 0);
+	for (auto& generation : m_slotGeneration)
+	{
+		generation++;
+	}
+	m_teleported.clear();
+
+	owner = owners;
+	transform.resize(count);
+	for (int i = 0; i < GetCount(); i++)
+	{
+		owner[i]->handle = GetHandle(i);
+		owner[i]->store = this;
+		transform[i] = owner[i]->gameObject->GetTransform();
+	}
+
+	return true;
+}
+
+void BodyStore::Release(const int index)
+{
+	RigidBody* rb = owner[index];
+	rb->velocity = GetVelocity(index);
+	rb->netForce = GetForce(index);
+	rb->mass = mass[index];
+	rb->restitution = restitution[index];
+	rb->friction = friction[index];
+	rb->collisionLayer = collisionLayer[index];
+	rb->collisionMask = collisionMask[index];
+	rb->handle = BodyHandle();
+	rb->store = nullptr;
+	transform[index]->position = GetPosition(index);
+}
@@ -0,0 +1,144 @@
+#pragma once
+#ifndef __BODY_STORE__
+#define __BODY_STORE__
+#include <cstdint>
+#include <vector>
+#include <glm/vec2.hpp>
+#include "BodyHandle.h"
+#include "BodyType.h"
+#include "CollisionShape.h"
+#include "ConvexShape.h"
+#include "Integrator.h"
+#include "WorldSnapshot.h"
+
+struct RigidBody;
+struct Transform;
+
+/*
+ * Structure of arrays storage for the bodies registered with the PhysicsEngine. Every column is
+ * contiguous and indexed by the same dense index, so the integrator and the collision passes walk
+ * plain float arrays instead of going RigidBody -> GameObject -> Transform for every body.
+ *
+ * Removing a body moves the last one into its place, so dense indices change. Handles do not: they
+ * name a slot that maps to the current dense index
+ */
+class BodyStore
+{
+public:
+	// Copies the definition of the rigid body in, from then on the RigidBody reads through the handle.
+	// Polygons take their corners from hull, see ConvexShape::MakeHull
+	BodyHandle Add(RigidBody* rb, const ConvexShape& hull = ConvexShape());
+
+	// Copies the state back into the RigidBody and swaps the last body into the hole.
+	// Returns the new dense index of the moved body, or -1 if nothing moved
+	int Remove(BodyHandle handle);
+
+	[[nodiscard]] bool IsValid(BodyHandle handle) const;
+	[[nodiscard]] int GetIndex(BodyHandle handle) const;
+	[[nodiscard]] BodyHandle GetHandle(int index) const;
+	[[nodiscard]] int GetCount() const;
+
+	[[nodiscard]] glm::vec2 GetPosition(int index) const;
+	void SetPosition(int index, glm::vec2 position);
+
+	// Moves the body without a trail, the previous position is set too so nothing is interpolated. The body
+	// is remembered until the engine moves its proxy, see GetTeleported
+	void Teleport(int index, glm::vec2 position);
+
+	// Bodies teleported since the last ClearTeleported, their proxies still have the box they had before.
+	// Handles of bodies removed since do not resolve
+	[[nodiscard]] const std::vector<BodyHandle>& GetTeleported() const;
+	void ClearTeleported();
+	[[nodiscard]] glm::vec2 GetVelocity(int index) const;
+	void SetVelocity(int index, glm::vec2 velocity);
+	[[nodiscard]] glm::vec2 GetForce(int index) const;
+	void SetForce(int index, glm::vec2 force);
+	void SetMass(int index, float mass);
+
+	// Wakes the body so the contacts the new filter drops let go of it
+	void SetCollisionFilter(int index, uint32_t layer, uint32_t mask);
+
+	// The one test every pair passes before the narrowphase, see RigidBody::collisionLayer
+	[[nodiscard]] bool CanCollide(const int a, const int b) const
+	{
+		return ((collisionLayer[a] & collisionMask[b]) != 0) & ((collisionLayer[b] & collisionMask[a]) != 0);
+	}
+
+	// Sleeping bodies are not integrated or moved in the broadphase until something wakes them
+	[[nodiscard]] bool IsAwake(int index) const;
+	[[nodiscard]] bool IsStatic(int index) const;
+	void Wake(int index);
+	void Sleep(int index);
+
+	// Pointers into the columns for the integration kernels, invalidated by Add and Remove
+	[[nodiscard]] IntegrationBatch GetIntegrationBatch();
+
+	// Called before every fixed step, the Transforms are interpolated from these positions
+	void SavePreviousPositions();
+
+	// Writes previous + (current - previous) * alpha to the Transforms the rest of the game reads
+	void SyncTransforms(float alpha) const;
+
+	// Appends every column but the owners and the slot tables to the snapshot
+	void Save(WorldSnapshot& snapshot) const;
+
+	// Replaces every body with the ones in the snapshot, owned by owners in dense index order. Bodies that are
+	// not in it are handed their state back like Remove does, the ones in it are registered again whether or not
+	// they were removed since. Every slot moves on a generation, so handles taken before the restore stop
+	// resolving and the owners get new ones. Fails without changing anything if owners is not the snapshot's size
+	bool Restore(const WorldSnapshot& snapshot, size_t& offset, const std::vector<RigidBody*>& owners);
+
+	// Columns, all GetCount() long. Every entry is 4 bytes and 4 byte aligned, the integrator walks the 13 in
+	// IntegrationBatch, 52 bytes a body, and the contact passes mostly the position, velocity and mass ones
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> previousPositionX;
+	std::vector<float> previousPositionY;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> forceX;
+	std::vector<float> forceY;
+	std::vector<float> mass;
+	std::vector<float> inverseMass;
+	std::vector<float> radius;
+	std::vector<float> halfWidth;
+	std::vector<float> halfHeight;
+	std::vector<float> restitution;
+	std::vector<float> friction;
+	std::vector<float> gravityScaleX;
+	std::vector<float> gravityScaleY;
+	// 32 bit so the integrator can load them straight into a SIMD lane mask. enableGravity is set for
+	// dynamic bodies only
+	std::vector<BodyType> bodyType;
+	std::vector<uint32_t> enableGravity;
+	std::vector<uint32_t> awake;
+	std::vector<uint32_t> continuousCollision;
+	// Consecutive steps the body moved slower than the sleep velocity
+	std::vector<int> stillSteps;
+	std::vector<uint32_t> collisionLayer;
+	std::vector<uint32_t> collisionMask;
+	std::vector<CollisionShape> shape;
+	// Points around the position every shape is the hull of, for the pairs the narrowphase runs GJK on
+	std::vector<ConvexShape> convex;
+	std::vector<int> proxyId;
+	std::vector<RigidBody*> owner;
+	std::vector<Transform*> transform;
+
+private:
+	void PushBack(RigidBody* rb, const ConvexShape& hull);
+	void MoveBody(int from, int to);
+	void PopBack();
+
+	// Hands the simulated state back to the RigidBody and unbinds it
+	void Release(int index);
+
+	// Slot -> dense index and dense index -> slot
+	std::vector<uint32_t> m_slotIndex;
+	std::vector<uint32_t> m_slotGeneration;
+	std::vector<uint32_t> m_indexSlot;
+	std::vector<uint32_t> m_freeSlots;
+
+	std::vector<BodyHandle> m_teleported;
+};
+
+#endif /* defined (__BODY_STORE__) */
@@ -0,0 +1,15 @@
+#pragma once
+#ifndef __BODY_TYPE__
+#define __BODY_TYPE__
+#include <cstdint>
+
+// Static is 0 so the integrator kernels can mask static bodies out with a compare against zero
+enum class BodyType : uint32_t
+{
+	STATIC,
+	KINEMATIC,
+	DYNAMIC,
+	NUM_OF_TYPES
+};
+
+#endif /* defined (__BODY_TYPE__) */
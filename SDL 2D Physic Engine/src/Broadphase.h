@@ -0,0 +1,42 @@
+#pragma once
+#ifndef __BROADPHASE__
+#define __BROADPHASE__
+#include <functional>
+#include <vector>
+#include "AABB.h"
+#include "BroadphasePair.h"
+#include "BroadphaseType.h"
+#include "RayCastInput.h"
+
+/*
+ * Interface shared by the broadphase implementations of the PhysicsEngine.
+ * Each body owns one proxy, the engine moves the proxies every step and asks for the candidate pairs
+ */
+class Broadphase
+{
+public:
+	// Gets a proxy the cast reaches and the fraction it still looks up to, returns the fraction to clip it to
+	typedef std::function<float(int, float)> RayCastCallback;
+
+	virtual ~Broadphase() = default;
+
+	virtual int CreateProxy(const AABB& aabb) = 0;
+	virtual void DestroyProxy(int proxy_id) = 0;
+	virtual void MoveProxy(int proxy_id, const AABB& aabb) = 0;
+
+	// Writes every pair of proxies whose boxes overlap, sorted by proxy id
+	virtual void UpdatePairs(std::vector<BroadphasePair>& pairs) = 0;
+
+	// Writes every proxy whose box overlaps the given one, in no particular order
+	virtual void Query(const AABB& aabb, std::vector<int>& proxies) const = 0;
+
+	// Reports every proxy whose box, grown by the cast radius, the cast enters before max_fraction. Walks
+	// nearest first where the structure allows, so clipping at a hit skips the rest. Returning 0 from the
+	// callback stops the walk. A proxy may be reported more than once
+	virtual void RayCast(const RayCastInput& input, float max_fraction, const RayCastCallback& callback) const = 0;
+
+	[[nodiscard]] virtual int GetProxyCount() const = 0;
+	[[nodiscard]] virtual BroadphaseType GetType() const = 0;
+};
+
+#endif /* defined (__BROADPHASE__) */
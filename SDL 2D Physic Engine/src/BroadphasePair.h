@@ -0,0 +1,22 @@
+#pragma once
+#ifndef __BROADPHASE_PAIR__
+#define __BROADPHASE_PAIR__
+
+// Candidate pair emitted by the broadphase. proxyA is always the lower proxy id
+struct BroadphasePair
+{
+	int proxyA = -1;
+	int proxyB = -1;
+
+	bool operator<(const BroadphasePair& other) const
+	{
+		return (proxyA == other.proxyA) ? proxyB < other.proxyB : proxyA < other.proxyA;
+	}
+
+	bool operator==(const BroadphasePair& other) const
+	{
+		return proxyA == other.proxyA && proxyB == other.proxyB;
+	}
+};
+
+#endif /* defined (__BROADPHASE_PAIR__) */
@@ -0,0 +1,11 @@
+#pragma once
+#ifndef __BROADPHASE_TYPE__
+#define __BROADPHASE_TYPE__
+enum class BroadphaseType {
+	ALL_PAIRS,
+	SPATIAL_HASH,
+	DYNAMIC_TREE,
+	SWEEP_AND_PRUNE,
+	NUM_OF_TYPES
+};
+#endif /* defined (__BROADPHASE_TYPE__) */
@@ -20,9 +20,9 @@ bool CollisionManager::SquaredRadiusCheck(GameObject* object1, GameObject* objec
 	if (const int half_heights = static_cast<int>((object1->GetHeight() + object2->GetHeight()) * 0.5); 
 		SquaredDistance(p1, p2) < (half_heights * half_heights)) 
 	{
-		if (!object2->GetRigidBody()->isColliding) 
+		if (!object2->IsColliding()) 
 		{
-			object2->GetRigidBody()->isColliding = true;
+			object2->SetColliding(true);
 
 			switch (object2->GetType()) {
 			case GameObjectType::TARGET:
@@ -39,7 +39,7 @@ bool CollisionManager::SquaredRadiusCheck(GameObject* object1, GameObject* objec
 		}
 		return false;
 	}
-	object2->GetRigidBody()->isColliding = false;
+	object2->SetColliding(false);
 	return false;
 
 }
@@ -61,10 +61,10 @@ bool CollisionManager::AABBCheck(GameObject* object1, GameObject* object2)
 		p1.y + p1_height > p2.y
 		)
 	{
-		if (!object2->GetRigidBody()->isColliding) 
+		if (!object2->IsColliding()) 
 		{
 
-			object2->GetRigidBody()->isColliding = true;
+			object2->SetColliding(true);
 
 			switch (object2->GetType()) {
 			case GameObjectType::TARGET:
@@ -84,7 +84,7 @@ bool CollisionManager::AABBCheck(GameObject* object1, GameObject* object2)
 		}
 		return false;
 	}
-	object2->GetRigidBody()->isColliding = false;
+	object2->SetColliding(false);
 	return false;
 
 }
@@ -272,9 +272,9 @@ bool CollisionManager::CircleAABBCheck(GameObject* object1, GameObject* object2)
 	if (const auto box_start = object2->GetTransform()->position - glm::vec2(half_box_width, half_box_height); 
 		CircleAABBSquaredDistance(circle_centre, circle_radius, box_start, object2->GetWidth(), object2->GetHeight()) <= (circle_radius * circle_radius))
 	{
-		if (!object2->GetRigidBody()->isColliding) 
+		if (!object2->IsColliding()) 
 		{
-			object2->GetRigidBody()->isColliding = true;
+			object2->SetColliding(true);
 
 			const auto attack_vector = object1->GetTransform()->position - object2->GetTransform()->position;
 			constexpr auto normal = glm::vec2(0.0f, -1.0f);
@@ -330,7 +330,7 @@ bool CollisionManager::CircleAABBCheck(GameObject* object1, GameObject* object2)
 		}
 		return false;
 	}
-	object2->GetRigidBody()->isColliding = false;
+	object2->SetColliding(false);
 	return false;
 
 }
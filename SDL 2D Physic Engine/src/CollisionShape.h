@@ -8,7 +8,9 @@ enum class CollisionShape
 	CIRCLE,
 	LINE,
 	CAPSULE,
-	RECTANGLE
+	RECTANGLE,
+	POLYGON,
+	NUM_OF_TYPES
 };
 
 #endif /* defined(__COLLISION_SHAPE__) */
@@ -0,0 +1,29 @@
+#pragma once
+#ifndef __CONTACT_EVENT__
+#define __CONTACT_EVENT__
+#include <glm/vec2.hpp>
+#include "BodyHandle.h"
+#include "ContactEventType.h"
+
+/*
+ * Emitted by the PhysicsEngine when a contact begins or ends and once a step while it persists, and handed to
+ * the contact listeners once the frame's steps are done. The handles stay valid until a listener removes the body
+ */
+struct ContactEvent
+{
+	ContactEventType type = ContactEventType::BEGIN;
+	BodyHandle bodyA;
+	BodyHandle bodyB;
+
+	// Points from A to B
+	glm::vec2 normal = glm::vec2(0, 0);
+
+	// Impulse of the approach with the real masses, what pig toughness is measured against. PERSIST has the
+	// hardest of the step's substeps
+	float impactImpulse = 0.0f;
+
+	// Total impulse the solver pushed the bodies apart with, zero for END
+	float normalImpulse = 0.0f;
+};
+
+#endif /* defined (__CONTACT_EVENT__) */
@@ -0,0 +1,10 @@
+#pragma once
+#ifndef __CONTACT_EVENT_TYPE__
+#define __CONTACT_EVENT_TYPE__
+enum class ContactEventType {
+	BEGIN,
+	PERSIST,
+	END,
+	NUM_OF_TYPES
+};
+#endif /* defined (__CONTACT_EVENT_TYPE__) */
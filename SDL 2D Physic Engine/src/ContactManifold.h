@@ -0,0 +1,84 @@
+#pragma once
+#ifndef __CONTACT_MANIFOLD__
+#define __CONTACT_MANIFOLD__
+#include <cstdint>
+#include <glm/vec2.hpp>
+
+struct ContactPoint
+{
+	// Distance along the normal, negative while the shapes overlap
+	float separation = 0.0f;
+
+	// Names the features that produced the point, a point keeps its impulses only while this matches
+	uint32_t featureId = 0;
+
+	// Accumulated over the solver iterations and carried over to the next step
+	float normalImpulse = 0.0f;
+	float tangentImpulse = 0.0f;
+
+	// Solver data, rebuilt every step
+	float normalMass = 0.0f;
+	float tangentMass = 0.0f;
+	float velocityBias = 0.0f;
+};
+
+// Support points of A and B that GJK finished on, the next step starts from them so a pair that barely
+// moved is done in an iteration or two
+struct SimplexCache
+{
+	uint8_t count = 0;
+	uint8_t indexA[3] = { 0, 0, 0 };
+	uint8_t indexB[3] = { 0, 0, 0 };
+};
+
+/*
+ * Contact between two bodies, built by the narrowphase from a broadphase pair.
+ * Manifolds are kept sorted by proxy pair so the ones from the previous step can be matched in one walk
+ */
+struct ContactManifold
+{
+	static constexpr int MAX_POINTS = 2;
+
+	int proxyA = -1;
+	int proxyB = -1;
+
+	// Body B of a contact with the StaticGeometry, which has no body and no velocity
+	static constexpr int STATIC_BODY = -1;
+
+	// Dense body indices, only valid during the step that built the manifold
+	int bodyA = -1;
+	int bodyB = -1;
+
+	// Points from A to B
+	glm::vec2 normal = glm::vec2(0, 0);
+
+	ContactPoint points[MAX_POINTS];
+	int pointCount = 0;
+
+	float friction = 0.0f;
+	float restitution = 0.0f;
+
+	// Only filled for the pairs that go through GJK
+	SimplexCache simplexCache;
+
+	// Impulse the old resolver would have applied for the approach speed, the toughness of pigs is tuned to it
+	float impactImpulse = 0.0f;
+
+	// Hardest impact of a contact that stays touching since its last event, PERSIST reports it once per step
+	float peakImpactImpulse = 0.0f;
+
+	// Whether the bodies pressed together after the solver ran this step and the step before
+	bool touching = false;
+	bool wasTouching = false;
+
+	// Body positions when the solver started, the position pass measures the separation from these
+	glm::vec2 startPositionA = glm::vec2(0, 0);
+	glm::vec2 startPositionB = glm::vec2(0, 0);
+
+	bool operator<(const ContactManifold& other) const
+	{
+		return proxyA < other.proxyA || (proxyA == other.proxyA && proxyB < other.proxyB);
+	}
+};
+
+#endif /* defined (__CONTACT_MANIFOLD__) */
@@ -0,0 +1,289 @@
+#include "ContactSolver.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	float Dot(const glm::vec2 lhs, const glm::vec2 rhs)
+	{
+		return lhs.x * rhs.x + lhs.y * rhs.y;
+	}
+
+	glm::vec2 Tangent(const glm::vec2 normal)
+	{
+		return glm::vec2(-normal.y, normal.x);
+	}
+}
+
+ContactSolver::ContactSolver()
+= default;
+
+int ContactSolver::SolveVelocities(BodyStore& bodies, std::vector<ContactManifold>& manifolds, const float delta_time) const
+{
+	if (manifolds.empty() || delta_time <= 0.0f)
+	{
+		return 0;
+	}
+
+	PreStep(bodies, manifolds, delta_time);
+
+	int impulses = 0;
+	for (int i = 0; i < m_velocityIterations; i++)
+	{
+		impulses += SolveVelocityIteration(bodies, manifolds);
+	}
+	return impulses;
+}
+
+void ContactSolver::SolvePositions(BodyStore& bodies, const std::vector<ContactManifold>& manifolds) const
+{
+	for (int i = 0; i < m_positionIterations; i++)
+	{
+		SolvePositionIteration(bodies, manifolds);
+	}
+}
+
+void ContactSolver::SetVelocityIterations(const int iterations)
+{
+	m_velocityIterations = std::max(1, iterations);
+}
+
+int ContactSolver::GetVelocityIterations() const
+{
+	return m_velocityIterations;
+}
+
+void ContactSolver::SetPositionIterations(const int iterations)
+{
+	m_positionIterations = std::max(0, iterations);
+}
+
+int ContactSolver::GetPositionIterations() const
+{
+	return m_positionIterations;
+}
+
+void ContactSolver::SetWarmStarting(const bool enabled)
+{
+	m_warmStarting = enabled;
+}
+
+bool ContactSolver::IsWarmStarting() const
+{
+	return m_warmStarting;
+}
+
+void ContactSolver::PreStep(BodyStore& bodies, std::vector<ContactManifold>& manifolds, const float delta_time) const
+{
+	const float inverse_delta_time = 1.0f / delta_time;
+
+	for (auto& manifold : manifolds)
+	{
+		const int a = manifold.bodyA;
+		const int b = manifold.bodyB;
+		const float inverse_mass_a = GetInverseMass(bodies, a);
+		const float inverse_mass_b = GetInverseMass(bodies, b);
+		const float inverse_mass_sum = inverse_mass_a + inverse_mass_b;
+
+		// The static geometry mixes its own material in when it builds the manifold
+		if (b != ContactManifold::STATIC_BODY)
+		{
+			manifold.friction = std::sqrt(bodies.friction[a] * bodies.friction[b]);
+			manifold.restitution = std::min(bodies.restitution[a], bodies.restitution[b]);
+		}
+		manifold.startPositionA = GetPosition(bodies, a);
+		manifold.startPositionB = GetPosition(bodies, b);
+
+		const float normal_velocity = Dot(GetVelocity(bodies, b) - GetVelocity(bodies, a), manifold.normal);
+
+		// Measured with the real masses, as the old resolver did, so pig toughness keeps its meaning. Resting
+		// contacts only close at the speed gravity adds in one step and do not count as hits. Static geometry
+		// does not give, the reduced mass is the body's own
+		const float mass_a = bodies.mass[a];
+		const float reduced_mass = (b == ContactManifold::STATIC_BODY) ? mass_a :
+			(mass_a + bodies.mass[b] > 0.0f) ? mass_a * bodies.mass[b] / (mass_a + bodies.mass[b]) : 0.0f;
+		manifold.impactImpulse = (normal_velocity < -m_restitutionThreshold) ?
+			-(1.0f + manifold.restitution) * normal_velocity * reduced_mass : 0.0f;
+
+		for (int i = 0; i < manifold.pointCount; i++)
+		{
+			ContactPoint& point = manifold.points[i];
+
+			point.normalMass = (inverse_mass_sum > 0.0f) ? 1.0f / inverse_mass_sum : 0.0f;
+			point.tangentMass = point.normalMass;
+
+			if (normal_velocity < -m_restitutionThreshold && point.separation < -normal_velocity * delta_time)
+			{
+				// Hits this step, bounce even if the gap has not quite closed yet
+				point.velocityBias = -manifold.restitution * normal_velocity;
+			}
+			else if (point.separation > 0.0f)
+			{
+				// Speculative contact, the bodies may still close the gap this step
+				point.velocityBias = -point.separation * inverse_delta_time;
+			}
+			else
+			{
+				point.velocityBias = 0.0f;
+			}
+
+			if (!m_warmStarting)
+			{
+				point.normalImpulse = 0.0f;
+				point.tangentImpulse = 0.0f;
+			}
+		}
+	}
+
+	// Only once every bias is measured, otherwise later manifolds would bounce off the warm start impulses
+	for (const auto& manifold : manifolds)
+	{
+		const int a = manifold.bodyA;
+		const int b = manifold.bodyB;
+		const float inverse_mass_a = GetInverseMass(bodies, a);
+		const float inverse_mass_b = GetInverseMass(bodies, b);
+		const glm::vec2 tangent = Tangent(manifold.normal);
+
+		for (int i = 0; i < manifold.pointCount; i++)
+		{
+			// Apply what the point needed last step, the iterations only correct the difference
+			const ContactPoint& point = manifold.points[i];
+			const glm::vec2 impulse = point.normalImpulse * manifold.normal + point.tangentImpulse * tangent;
+			SetVelocity(bodies, a, GetVelocity(bodies, a) - impulse * inverse_mass_a);
+			SetVelocity(bodies, b, GetVelocity(bodies, b) + impulse * inverse_mass_b);
+		}
+	}
+}
+
+int ContactSolver::SolveVelocityIteration(BodyStore& bodies, std::vector<ContactManifold>& manifolds)
+{
+	int impulses = 0;
+	for (auto& manifold : manifolds)
+	{
+		const int a = manifold.bodyA;
+		const int b = manifold.bodyB;
+		const float inverse_mass_a = GetInverseMass(bodies, a);
+		const float inverse_mass_b = GetInverseMass(bodies, b);
+		const glm::vec2 normal = manifold.normal;
+		const glm::vec2 tangent = Tangent(normal);
+
+		// Contacts between sleeping bodies keep their impulses for when the island wakes
+		if (inverse_mass_a + inverse_mass_b <= 0.0f)
+		{
+			continue;
+		}
+
+		glm::vec2 velocity_a = GetVelocity(bodies, a);
+		glm::vec2 velocity_b = GetVelocity(bodies, b);
+
+		for (int i = 0; i < manifold.pointCount; i++)
+		{
+			ContactPoint& point = manifold.points[i];
+
+			// Friction first, bounded by the normal impulse of the last iteration
+			{
+				const float tangent_velocity = Dot(velocity_b - velocity_a, tangent);
+				const float max_friction = manifold.friction * point.normalImpulse;
+				const float new_impulse = std::clamp(point.tangentImpulse - point.tangentMass * tangent_velocity, -max_friction, max_friction);
+				const float lambda = new_impulse - point.tangentImpulse;
+				point.tangentImpulse = new_impulse;
+
+				velocity_a -= lambda * inverse_mass_a * tangent;
+				velocity_b += lambda * inverse_mass_b * tangent;
+			}
+
+			// Normal impulse, the total may push but never pull
+			{
+				const float normal_velocity = Dot(velocity_b - velocity_a, normal);
+				const float new_impulse = std::max(point.normalImpulse - point.normalMass * (normal_velocity - point.velocityBias), 0.0f);
+				const float lambda = new_impulse - point.normalImpulse;
+				point.normalImpulse = new_impulse;
+
+				velocity_a -= lambda * inverse_mass_a * normal;
+				velocity_b += lambda * inverse_mass_b * normal;
+			}
+		}
+
+		SetVelocity(bodies, a, velocity_a);
+		SetVelocity(bodies, b, velocity_b);
+
+		// A friction and a normal impulse per point
+		impulses += manifold.pointCount * 2;
+	}
+	return impulses;
+}
+
+void ContactSolver::SolvePositionIteration(BodyStore& bodies, const std::vector<ContactManifold>& manifolds) const
+{
+	for (const auto& manifold : manifolds)
+	{
+		const int a = manifold.bodyA;
+		const int b = manifold.bodyB;
+		const float inverse_mass_a = GetInverseMass(bodies, a);
+		const float inverse_mass_b = GetInverseMass(bodies, b);
+		const float inverse_mass_sum = inverse_mass_a + inverse_mass_b;
+
+		if (inverse_mass_sum <= 0.0f)
+		{
+			continue;
+		}
+
+		glm::vec2 position_a = GetPosition(bodies, a);
+		glm::vec2 position_b = GetPosition(bodies, b);
+
+		for (int i = 0; i < manifold.pointCount; i++)
+		{
+			// Bodies do not rotate, so the separation only changes by how far they moved along the normal
+			const glm::vec2 moved = (position_b - manifold.startPositionB) - (position_a - manifold.startPositionA);
+			const float separation = manifold.points[i].separation + Dot(moved, manifold.normal);
+
+			const float correction = std::clamp(m_positionCorrection * (separation + m_linearSlop), -m_maxCorrection, 0.0f);
+			if (correction >= 0.0f)
+			{
+				continue;
+			}
+
+			const glm::vec2 impulse = (-correction / inverse_mass_sum) * manifold.normal;
+			position_a -= impulse * inverse_mass_a;
+			position_b += impulse * inverse_mass_b;
+		}
+
+		SetPosition(bodies, a, position_a);
+		SetPosition(bodies, b, position_b);
+	}
+}
+
+float ContactSolver::GetInverseMass(const BodyStore& bodies, const int index)
+{
+	if (index == ContactManifold::STATIC_BODY)
+	{
+		return 0.0f;
+	}
+	return (bodies.enableGravity[index] && bodies.awake[index]) ? bodies.inverseMass[index] : 0.0f;
+}
+
+glm::vec2 ContactSolver::GetVelocity(const BodyStore& bodies, const int index)
+{
+	return (index == ContactManifold::STATIC_BODY) ? glm::vec2(0, 0) : bodies.GetVelocity(index);
+}
+
+void ContactSolver::SetVelocity(BodyStore& bodies, const int index, const glm::vec2 velocity)
+{
+	if (index != ContactManifold::STATIC_BODY)
+	{
+		bodies.SetVelocity(index, velocity);
+	}
+}
+
+glm::vec2 ContactSolver::GetPosition(const BodyStore& bodies, const int index)
+{
+	return (index == ContactManifold::STATIC_BODY) ? glm::vec2(0, 0) : bodies.GetPosition(index);
+}
+
+void ContactSolver::SetPosition(BodyStore& bodies, const int index, const glm::vec2 position)
+{
+	if (index != ContactManifold::STATIC_BODY)
+	{
+		bodies.SetPosition(index, position);
+	}
+}
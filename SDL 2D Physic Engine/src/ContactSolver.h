@@ -0,0 +1,62 @@
+#pragma once
+#ifndef __CONTACT_SOLVER__
+#define __CONTACT_SOLVER__
+#include <vector>
+#include "BodyStore.h"
+#include "ContactManifold.h"
+
+/*
+ * Sequential impulse solver. Each velocity iteration clamps the accumulated friction and normal impulse of
+ * every contact point, starting from the impulses the points ended the previous step with (warm starting),
+ * so a resting stack only needs a few iterations to hold still. Overlap left after the velocity pass is
+ * removed by moving the bodies, which adds no energy.
+ *
+ * Bodies without gravity, like the ground, sleeping bodies and the static geometry take part as if their
+ * mass was infinite
+ */
+class ContactSolver
+{
+public:
+	ContactSolver();
+
+	// Run after the velocities are integrated and before the positions are. Returns the number of impulses applied
+	int SolveVelocities(BodyStore& bodies, std::vector<ContactManifold>& manifolds, float delta_time) const;
+
+	// Run after the positions are integrated
+	void SolvePositions(BodyStore& bodies, const std::vector<ContactManifold>& manifolds) const;
+
+	void SetVelocityIterations(int iterations);
+	[[nodiscard]] int GetVelocityIterations() const;
+	void SetPositionIterations(int iterations);
+	[[nodiscard]] int GetPositionIterations() const;
+	void SetWarmStarting(bool enabled);
+	[[nodiscard]] bool IsWarmStarting() const;
+
+private:
+	void PreStep(BodyStore& bodies, std::vector<ContactManifold>& manifolds, float delta_time) const;
+	static int SolveVelocityIteration(BodyStore& bodies, std::vector<ContactManifold>& manifolds);
+	void SolvePositionIteration(BodyStore& bodies, const std::vector<ContactManifold>& manifolds) const;
+
+	// Body B of a manifold may be the static geometry, which reads as still and ignores writes
+	static float GetInverseMass(const BodyStore& bodies, int index);
+	static glm::vec2 GetVelocity(const BodyStore& bodies, int index);
+	static void SetVelocity(BodyStore& bodies, int index, glm::vec2 velocity);
+	static glm::vec2 GetPosition(const BodyStore& bodies, int index);
+	static void SetPosition(BodyStore& bodies, int index, glm::vec2 position);
+
+	int m_velocityIterations = 8;
+	int m_positionIterations = 3;
+	bool m_warmStarting = true;
+
+	// Approach speed in pixels per second below which contacts do not bounce, so resting bodies stay put
+	float m_restitutionThreshold = 60.0f;
+
+	// Overlap allowed to stay so touching bodies keep their contact from step to step
+	float m_linearSlop = 0.5f;
+
+	// Fraction of the overlap removed per position iteration and the most it moves a body at once
+	float m_positionCorrection = 0.4f;
+	float m_maxCorrection = 8.0f;
+};
+
+#endif /* defined (__CONTACT_SOLVER__) */
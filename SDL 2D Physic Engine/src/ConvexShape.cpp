@@ -0,0 +1,144 @@
+#include "ConvexShape.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr float DEGREES_TO_RADIANS = 3.14159265358979f / 180.0f;
+}
+
+ConvexShape ConvexShape::Make(const CollisionShape shape, const float width, const float height, const float circle_radius,
+	const float angle, const ConvexShape& hull)
+{
+	ConvexShape convex;
+	const float half_width = width * 0.5f;
+	const float half_height = height * 0.5f;
+
+	switch (shape)
+	{
+	case CollisionShape::CIRCLE:
+		convex.vertices[0] = glm::vec2(0, 0);
+		convex.count = 1;
+		convex.radius = circle_radius;
+		return convex;
+	case CollisionShape::LINE:
+		convex.vertices[0] = glm::vec2(-half_width, 0);
+		convex.vertices[1] = glm::vec2(half_width, 0);
+		convex.count = 2;
+		break;
+	case CollisionShape::CAPSULE:
+		// Rounded along the long side, the short side is the diameter
+		convex.radius = std::min(half_width, half_height);
+		convex.vertices[0] = (half_width > half_height) ? glm::vec2(convex.radius - half_width, 0) : glm::vec2(0, convex.radius - half_height);
+		convex.vertices[1] = -convex.vertices[0];
+		convex.count = 2;
+		break;
+	case CollisionShape::POLYGON:
+		convex.count = hull.count;
+		std::copy(hull.vertices, hull.vertices + hull.count, convex.vertices);
+		break;
+	case CollisionShape::RECTANGLE:
+		convex.vertices[0] = glm::vec2(-half_width, -half_height);
+		convex.vertices[1] = glm::vec2(half_width, -half_height);
+		convex.vertices[2] = glm::vec2(half_width, half_height);
+		convex.vertices[3] = glm::vec2(-half_width, half_height);
+		convex.count = 4;
+		break;
+	case CollisionShape::NO_COLLIDER:
+	default:
+		return convex;
+	}
+
+	if (angle != 0.0f)
+	{
+		const float cosine = std::cos(angle * DEGREES_TO_RADIANS);
+		const float sine = std::sin(angle * DEGREES_TO_RADIANS);
+		for (int i = 0; i < convex.count; i++)
+		{
+			const glm::vec2 vertex = convex.vertices[i];
+			convex.vertices[i] = glm::vec2(vertex.x * cosine - vertex.y * sine, vertex.x * sine + vertex.y * cosine);
+		}
+	}
+
+	return convex;
+}
+
+int ConvexShape::GetSupport(const glm::vec2 direction) const
+{
+	int best = 0;
+	float best_distance = vertices[0].x * direction.x + vertices[0].y * direction.y;
+
+	for (int i = 1; i < count; i++)
+	{
+		const float distance = vertices[i].x * direction.x + vertices[i].y * direction.y;
+		if (distance > best_distance)
+		{
+			best = i;
+			best_distance = distance;
+		}
+	}
+
+	return best;
+}
+
+bool ConvexShape::MakeHull(const std::vector<glm::vec2>& points, ConvexShape& hull)
+{
+	hull = ConvexShape();
+	if (points.size() < 3)
+	{
+		return false;
+	}
+
+	std::vector<glm::vec2> sorted = points;
+	std::sort(sorted.begin(), sorted.end(), [](const glm::vec2 lhs, const glm::vec2 rhs)
+	{
+		return (lhs.x == rhs.x) ? lhs.y < rhs.y : lhs.x < rhs.x;
+	});
+
+	auto turn = [](const glm::vec2 origin, const glm::vec2 a, const glm::vec2 b)
+	{
+		return (a.x - origin.x) * (b.y - origin.y) - (a.y - origin.y) * (b.x - origin.x);
+	};
+
+	// Andrew's monotone chain, the lower half left to right and the upper half back. Every corner turns the
+	// same way as a box's, points that do not are dropped
+	std::vector<glm::vec2> corners(sorted.size() * 2);
+	int count = 0;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		const int chain_start = count;
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			const glm::vec2 point = (pass == 0) ? sorted[i] : sorted[sorted.size() - 1 - i];
+			while (count - chain_start >= 2 && turn(corners[count - 2], corners[count - 1], point) <= 0.0f)
+			{
+				count--;
+			}
+			corners[count++] = point;
+		}
+
+		// The last point of a half is the first of the other
+		count--;
+	}
+
+	if (count < 3 || count > MAX_VERTICES)
+	{
+		return false;
+	}
+
+	std::copy(corners.begin(), corners.begin() + count, hull.vertices);
+	hull.count = count;
+	return true;
+}
+
+glm::vec2 ConvexShape::GetHalfExtents() const
+{
+	glm::vec2 extents = glm::vec2(0, 0);
+	for (int i = 0; i < count; i++)
+	{
+		extents.x = std::max(extents.x, std::abs(vertices[i].x));
+		extents.y = std::max(extents.y, std::abs(vertices[i].y));
+	}
+
+	return extents + glm::vec2(radius, radius);
+}
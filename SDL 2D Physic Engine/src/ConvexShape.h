@@ -0,0 +1,39 @@
+#pragma once
+#ifndef __CONVEX_SHAPE__
+#define __CONVEX_SHAPE__
+#include <vector>
+#include <glm/vec2.hpp>
+#include "CollisionShape.h"
+
+/*
+ * Any body shape as the convex hull of a few points around the body position, grown by a radius. A circle
+ * is one point, a capsule or a line two, a box four. Bodies do not spin, so the points are rotated once
+ * when the body is added and the narrowphase only ever adds the position.
+ *
+ * GJK and EPA only look at a shape through GetSupport, points inside the hull are never picked
+ */
+struct ConvexShape
+{
+	static constexpr int MAX_VERTICES = 8;
+
+	glm::vec2 vertices[MAX_VERTICES];
+	int count = 0;
+	float radius = 0.0f;
+
+	// Boxes and capsules are width x height turned by angle degrees, lines are width long.
+	// Polygons are a copy of hull turned by angle too, see MakeHull
+	static ConvexShape Make(CollisionShape shape, float width, float height, float circle_radius, float angle,
+		const ConvexShape& hull);
+
+	// Convex hull of the points, wound like the corners of a box and without the points on its edges. False if
+	// fewer than 3 of them are off one line or the hull has more than MAX_VERTICES corners
+	static bool MakeHull(const std::vector<glm::vec2>& points, ConvexShape& hull);
+
+	// Index of the point furthest along direction
+	[[nodiscard]] int GetSupport(glm::vec2 direction) const;
+
+	// Half size of the axis aligned box around the shape, radius included
+	[[nodiscard]] glm::vec2 GetHalfExtents() const;
+};
+
+#endif /* defined (__CONVEX_SHAPE__) */
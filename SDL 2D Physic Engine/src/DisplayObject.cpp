@@ -27,6 +27,30 @@ uint32_t DisplayObject::GetLayerOrderIndex() const
 
 void DisplayObject::SetLayerIndex(const uint32_t new_index, const uint32_t new_order)
 {
+	const uint32_t old_index = m_layerIndex;
 	m_layerIndex = new_index;
 	m_layerOrderIndex = new_order;
+
+	if (m_pParentScene != nullptr)
+	{
+		m_pParentScene->MoveChild(this, old_index);
+	}
+}
+
+void DisplayObject::SetEnabled(const bool state)
+{
+	if (state != IsEnabled() && m_pParentScene != nullptr)
+	{
+		m_pParentScene->MarkDisplayListDirty();
+	}
+	GameObject::SetEnabled(state);
+}
+
+void DisplayObject::SetVisible(const bool state)
+{
+	if (state != IsVisible() && m_pParentScene != nullptr)
+	{
+		m_pParentScene->MarkDisplayListDirty();
+	}
+	GameObject::SetVisible(state);
 }
@@ -5,6 +5,8 @@
 #include "GameObject.h"
 #include "Scene.h"
 
+class DisplayObjectPool;
+
 class DisplayObject : public GameObject
 {
 public:
@@ -34,13 +36,22 @@ public:
 	 * @param new_order The order within the layer, default is zero
 	 */
 	void SetLayerIndex(uint32_t new_index, const uint32_t new_order = 0);
+
+	// Also tell the parent scene its display list changed
+	void SetEnabled(bool state) override;
+	void SetVisible(bool state) override;
 	
 
 private:
 	friend class Scene;
+	template <typename T> friend class ObjectPool;
 	uint32_t m_layerIndex = 0;
 	uint32_t m_layerOrderIndex;
 	Scene* m_pParentScene{};
+
+	// Set for objects an ObjectPool made, the scene hands them back to it instead of deleting them
+	DisplayObjectPool* m_pPool{};
+	uint32_t m_poolSlot = 0;
 };
 
 #endif /* defined (__DISPLAY_OBJECT__) */
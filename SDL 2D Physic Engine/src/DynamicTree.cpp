@@ -0,0 +1,363 @@
+#include "DynamicTree.h"
+#include <algorithm>
+
+DynamicTree::DynamicTree()
+= default;
+
+int DynamicTree::CreateProxy(const AABB& aabb)
+{
+	const int proxy_id = AllocateNode();
+
+	const glm::vec2 margin(m_margin, m_margin);
+	m_nodes[proxy_id].aabb = { aabb.min - margin, aabb.max + margin };
+	m_nodes[proxy_id].height = 0;
+
+	InsertLeaf(proxy_id);
+
+	return proxy_id;
+}
+
+void DynamicTree::DestroyProxy(const int proxy_id)
+{
+	RemoveLeaf(proxy_id);
+	FreeNode(proxy_id);
+}
+
+bool DynamicTree::MoveProxy(const int proxy_id, const AABB& aabb)
+{
+	if (m_nodes[proxy_id].aabb.Contains(aabb))
+	{
+		return false;
+	}
+
+	RemoveLeaf(proxy_id);
+
+	const glm::vec2 margin(m_margin, m_margin);
+	m_nodes[proxy_id].aabb = { aabb.min - margin, aabb.max + margin };
+
+	InsertLeaf(proxy_id);
+
+	return true;
+}
+
+const AABB& DynamicTree::GetFatAABB(const int proxy_id) const
+{
+	return m_nodes[proxy_id].aabb;
+}
+
+const TreeNode& DynamicTree::GetNode(const int node_id) const
+{
+	return m_nodes[node_id];
+}
+
+int DynamicTree::GetRoot() const
+{
+	return m_root;
+}
+
+int DynamicTree::GetHeight() const
+{
+	return (m_root == -1) ? 0 : m_nodes[m_root].height;
+}
+
+int DynamicTree::GetNodeCapacity() const
+{
+	return static_cast<int>(m_nodes.size());
+}
+
+void DynamicTree::SetMargin(const float margin)
+{
+	m_margin = margin;
+}
+
+float DynamicTree::GetMargin() const
+{
+	return m_margin;
+}
+
+int DynamicTree::AllocateNode()
+{
+	if (m_freeList == -1)
+	{
+		m_nodes.emplace_back();
+		return static_cast<int>(m_nodes.size()) - 1;
+	}
+
+	const int node_id = m_freeList;
+	m_freeList = m_nodes[node_id].parent;
+	m_nodes[node_id] = TreeNode();
+	return node_id;
+}
+
+void DynamicTree::FreeNode(const int node_id)
+{
+	m_nodes[node_id].parent = m_freeList;
+	m_nodes[node_id].height = -1;
+	m_freeList = node_id;
+}
+
+void DynamicTree::InsertLeaf(const int leaf)
+{
+	if (m_root == -1)
+	{
+		m_root = leaf;
+		m_nodes[m_root].parent = -1;
+		return;
+	}
+
+	// Find the best sibling, descending while it is cheaper than pairing with the current node
+	const AABB leaf_aabb = m_nodes[leaf].aabb;
+	int index = m_root;
+	while (!m_nodes[index].IsLeaf())
+	{
+		const TreeNode& node = m_nodes[index];
+		const float area = node.aabb.GetPerimeter();
+		const float combined_area = AABB::Union(node.aabb, leaf_aabb).GetPerimeter();
+
+		// Cost of creating a new parent for this node and the new leaf
+		const float cost = 2.0f * combined_area;
+
+		// Minimum cost of pushing the leaf further down the tree
+		const float inheritance_cost = 2.0f * (combined_area - area);
+
+		float child_costs[2];
+		const int children[2] = { node.child1, node.child2 };
+		for (int i = 0; i < 2; i++)
+		{
+			const TreeNode& child = m_nodes[children[i]];
+			const float child_area = AABB::Union(leaf_aabb, child.aabb).GetPerimeter();
+			child_costs[i] = (child.IsLeaf() ? child_area : child_area - child.aabb.GetPerimeter()) + inheritance_cost;
+		}
+
+		if (cost < child_costs[0] && cost < child_costs[1])
+		{
+			break;
+		}
+
+		index = (child_costs[0] < child_costs[1]) ? children[0] : children[1];
+	}
+
+	const int sibling = index;
+
+	// Create a new parent for the sibling and the leaf
+	const int old_parent = m_nodes[sibling].parent;
+	const int new_parent = AllocateNode();
+	m_nodes[new_parent].parent = old_parent;
+	m_nodes[new_parent].aabb = AABB::Union(leaf_aabb, m_nodes[sibling].aabb);
+	m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+	m_nodes[new_parent].child1 = sibling;
+	m_nodes[new_parent].child2 = leaf;
+	m_nodes[sibling].parent = new_parent;
+	m_nodes[leaf].parent = new_parent;
+
+	if (old_parent != -1)
+	{
+		if (m_nodes[old_parent].child1 == sibling)
+		{
+			m_nodes[old_parent].child1 = new_parent;
+		}
+		else
+		{
+			m_nodes[old_parent].child2 = new_parent;
+		}
+	}
+	else
+	{
+		m_root = new_parent;
+	}
+
+	// Walk back up fixing heights and boxes
+	index = m_nodes[leaf].parent;
+	while (index != -1)
+	{
+		index = Balance(index);
+
+		TreeNode& node = m_nodes[index];
+		node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+		node.aabb = AABB::Union(m_nodes[node.child1].aabb, m_nodes[node.child2].aabb);
+
+		index = node.parent;
+	}
+}
+
+void DynamicTree::RemoveLeaf(const int leaf)
+{
+	if (leaf == m_root)
+	{
+		m_root = -1;
+		return;
+	}
+
+	const int parent = m_nodes[leaf].parent;
+	const int grand_parent = m_nodes[parent].parent;
+	const int sibling = (m_nodes[parent].child1 == leaf) ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+	if (grand_parent == -1)
+	{
+		m_root = sibling;
+		m_nodes[sibling].parent = -1;
+		FreeNode(parent);
+		return;
+	}
+
+	// Destroy the parent and connect the sibling to the grand parent
+	if (m_nodes[grand_parent].child1 == parent)
+	{
+		m_nodes[grand_parent].child1 = sibling;
+	}
+	else
+	{
+		m_nodes[grand_parent].child2 = sibling;
+	}
+	m_nodes[sibling].parent = grand_parent;
+	FreeNode(parent);
+
+	int index = grand_parent;
+	while (index != -1)
+	{
+		index = Balance(index);
+
+		TreeNode& node = m_nodes[index];
+		node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+		node.aabb = AABB::Union(m_nodes[node.child1].aabb, m_nodes[node.child2].aabb);
+
+		index = node.parent;
+	}
+}
+
+int DynamicTree::Balance(const int index_a)
+{
+	/*
+	 * Performs a left or right rotation if node A is imbalanced and returns the new root of the subtree
+	 *
+	 *       A
+	 *     /   \
+	 *    B     C
+	 *   / \   / \
+	 *  D   E F   G
+	 */
+	TreeNode& a = m_nodes[index_a];
+	if (a.IsLeaf() || a.height < 2)
+	{
+		return index_a;
+	}
+
+	const int index_b = a.child1;
+	const int index_c = a.child2;
+	TreeNode& b = m_nodes[index_b];
+	TreeNode& c = m_nodes[index_c];
+
+	const int balance = c.height - b.height;
+
+	// Rotate C up
+	if (balance > 1)
+	{
+		const int index_f = c.child1;
+		const int index_g = c.child2;
+		TreeNode& f = m_nodes[index_f];
+		TreeNode& g = m_nodes[index_g];
+
+		// Swap A and C
+		c.child1 = index_a;
+		c.parent = a.parent;
+		a.parent = index_c;
+
+		// A's old parent should point to C
+		if (c.parent != -1)
+		{
+			if (m_nodes[c.parent].child1 == index_a)
+			{
+				m_nodes[c.parent].child1 = index_c;
+			}
+			else
+			{
+				m_nodes[c.parent].child2 = index_c;
+			}
+		}
+		else
+		{
+			m_root = index_c;
+		}
+
+		// Keep the taller grandchild under C
+		if (f.height > g.height)
+		{
+			c.child2 = index_f;
+			a.child2 = index_g;
+			g.parent = index_a;
+			a.aabb = AABB::Union(b.aabb, g.aabb);
+			c.aabb = AABB::Union(a.aabb, f.aabb);
+			a.height = 1 + std::max(b.height, g.height);
+			c.height = 1 + std::max(a.height, f.height);
+		}
+		else
+		{
+			c.child2 = index_g;
+			a.child2 = index_f;
+			f.parent = index_a;
+			a.aabb = AABB::Union(b.aabb, f.aabb);
+			c.aabb = AABB::Union(a.aabb, g.aabb);
+			a.height = 1 + std::max(b.height, f.height);
+			c.height = 1 + std::max(a.height, g.height);
+		}
+
+		return index_c;
+	}
+
+	// Rotate B up
+	if (balance < -1)
+	{
+		const int index_d = b.child1;
+		const int index_e = b.child2;
+		TreeNode& d = m_nodes[index_d];
+		TreeNode& e = m_nodes[index_e];
+
+		// Swap A and B
+		b.child1 = index_a;
+		b.parent = a.parent;
+		a.parent = index_b;
+
+		// A's old parent should point to B
+		if (b.parent != -1)
+		{
+			if (m_nodes[b.parent].child1 == index_a)
+			{
+				m_nodes[b.parent].child1 = index_b;
+			}
+			else
+			{
+				m_nodes[b.parent].child2 = index_b;
+			}
+		}
+		else
+		{
+			m_root = index_b;
+		}
+
+		// Keep the taller grandchild under B
+		if (d.height > e.height)
+		{
+			b.child2 = index_d;
+			a.child1 = index_e;
+			e.parent = index_a;
+			a.aabb = AABB::Union(c.aabb, e.aabb);
+			b.aabb = AABB::Union(a.aabb, d.aabb);
+			a.height = 1 + std::max(c.height, e.height);
+			b.height = 1 + std::max(a.height, d.height);
+		}
+		else
+		{
+			b.child2 = index_e;
+			a.child1 = index_d;
+			d.parent = index_a;
+			a.aabb = AABB::Union(c.aabb, d.aabb);
+			b.aabb = AABB::Union(a.aabb, e.aabb);
+			a.height = 1 + std::max(c.height, d.height);
+			b.height = 1 + std::max(a.height, e.height);
+		}
+
+		return index_b;
+	}
+
+	return index_a;
+}
@@ -0,0 +1,198 @@
+#pragma once
+#ifndef __DYNAMIC_TREE__
+#define __DYNAMIC_TREE__
+#include <vector>
+#include <glm/vec2.hpp>
+#include "AABB.h"
+
+struct TreeNode
+{
+	// Leaves store the fattened box of their proxy, internal nodes the union of their children
+	AABB aabb;
+
+	// Parent index, or the next free node while the node is in the free list
+	int parent = -1;
+	int child1 = -1;
+	int child2 = -1;
+
+	// Leaf = 0, free node = -1
+	int height = -1;
+
+	[[nodiscard]] bool IsLeaf() const
+	{
+		return child1 == -1;
+	}
+};
+
+/*
+ * Dynamic bounding volume tree. Leaves are proxies with a fattened AABB so small movements
+ * do not touch the tree, a proxy is only removed and reinserted once its tight box leaves the fat one.
+ * Inserts use the perimeter heuristic and every node on the way back to the root is rebalanced with rotations
+ */
+class DynamicTree
+{
+public:
+	DynamicTree();
+
+	int CreateProxy(const AABB& aabb);
+	void DestroyProxy(int proxy_id);
+
+	// Returns true if the proxy left its fat box and was reinserted
+	bool MoveProxy(int proxy_id, const AABB& aabb);
+
+	// Calls callback(proxy_id) for every leaf overlapping the box, stops when the callback returns false
+	template <typename T>
+	void Query(const AABB& aabb, T&& callback) const;
+
+	// Calls callback(proxy_id, max_fraction) for every leaf whose box, grown by radius, the move from start by
+	// translation enters before max_fraction, nearer children first. The callback returns the fraction to clip
+	// the move to, so a hit skips everything behind it, and 0 stops the walk
+	template <typename T>
+	void RayCast(glm::vec2 start, glm::vec2 translation, float radius, float max_fraction, T&& callback) const;
+
+	[[nodiscard]] const AABB& GetFatAABB(int proxy_id) const;
+	[[nodiscard]] const TreeNode& GetNode(int node_id) const;
+	[[nodiscard]] int GetRoot() const;
+	[[nodiscard]] int GetHeight() const;
+	[[nodiscard]] int GetNodeCapacity() const;
+
+	void SetMargin(float margin);
+	[[nodiscard]] float GetMargin() const;
+
+private:
+	int AllocateNode();
+	void FreeNode(int node_id);
+
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int index);
+
+	std::vector<TreeNode> m_nodes;
+	int m_root = -1;
+	int m_freeList = -1;
+	float m_margin = 8.0f;
+
+	// Nodes left to visit in a walk. The first FIXED_SIZE live in the walk's stack frame, a degenerate tree
+	// deeper than that spills into the heap instead of losing nodes
+	class NodeStack
+	{
+	public:
+		void Push(const int node_id)
+		{
+			if (m_count < FIXED_SIZE)
+			{
+				m_fixed[m_count] = node_id;
+			}
+			else
+			{
+				m_overflow.push_back(node_id);
+			}
+			m_count++;
+		}
+
+		int Pop()
+		{
+			m_count--;
+			if (m_count < FIXED_SIZE)
+			{
+				return m_fixed[m_count];
+			}
+
+			const int node_id = m_overflow.back();
+			m_overflow.pop_back();
+			return node_id;
+		}
+
+		[[nodiscard]] bool IsEmpty() const
+		{
+			return m_count == 0;
+		}
+
+	private:
+		static constexpr int FIXED_SIZE = 256;
+		int m_fixed[FIXED_SIZE];
+		std::vector<int> m_overflow;
+		int m_count = 0;
+	};
+};
+
+template <typename T>
+void DynamicTree::Query(const AABB& aabb, T&& callback) const
+{
+	NodeStack stack;
+	stack.Push(m_root);
+
+	while (!stack.IsEmpty())
+	{
+		const int node_id = stack.Pop();
+		if (node_id == -1)
+		{
+			continue;
+		}
+
+		const TreeNode& node = m_nodes[node_id];
+		if (!node.aabb.Overlaps(aabb))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			if (!callback(node_id))
+			{
+				return;
+			}
+		}
+		else
+		{
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+	}
+}
+
+template <typename T>
+void DynamicTree::RayCast(const glm::vec2 start, const glm::vec2 translation, const float radius, float max_fraction, T&& callback) const
+{
+	NodeStack stack;
+	stack.Push(m_root);
+
+	while (!stack.IsEmpty())
+	{
+		const int node_id = stack.Pop();
+		if (node_id == -1)
+		{
+			continue;
+		}
+
+		// Boxes pushed before a closer hit was found may be behind it by now
+		const TreeNode& node = m_nodes[node_id];
+		float enter;
+		if (!node.aabb.Grow(radius).RayCast(start, translation, max_fraction, enter))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			max_fraction = callback(node_id, max_fraction);
+			if (max_fraction <= 0.0f)
+			{
+				return;
+			}
+		}
+		else
+		{
+			// The child the move enters first is popped first
+			float enter1;
+			float enter2;
+			const bool hit1 = m_nodes[node.child1].aabb.Grow(radius).RayCast(start, translation, max_fraction, enter1);
+			const bool hit2 = m_nodes[node.child2].aabb.Grow(radius).RayCast(start, translation, max_fraction, enter2);
+			const bool first_is_nearer = hit1 && (!hit2 || enter1 <= enter2);
+			stack.Push(first_is_nearer ? node.child2 : node.child1);
+			stack.Push(first_is_nearer ? node.child1 : node.child2);
+		}
+	}
+}
+
+#endif /* defined (__DYNAMIC_TREE__) */
@@ -0,0 +1,169 @@
+#include "DynamicTreeBroadphase.h"
+#include <algorithm>
+#include <iterator>
+
+int DynamicTreeBroadphase::CreateProxy(const AABB& aabb)
+{
+	const int proxy_id = m_tree.CreateProxy(aabb);
+
+	if (proxy_id >= static_cast<int>(m_aabbs.size()))
+	{
+		m_aabbs.resize(proxy_id + 1);
+		m_moved.resize(proxy_id + 1, false);
+	}
+
+	m_aabbs[proxy_id] = aabb;
+	m_moved[proxy_id] = false;
+	BufferMove(proxy_id);
+	m_proxyCount++;
+
+	return proxy_id;
+}
+
+void DynamicTreeBroadphase::DestroyProxy(const int proxy_id)
+{
+	// The node id can be handed out again, so forget everything about the proxy now
+	if (m_moved[proxy_id])
+	{
+		std::replace(m_moveBuffer.begin(), m_moveBuffer.end(), proxy_id, -1);
+		m_moved[proxy_id] = false;
+	}
+
+	m_pairs.erase(std::remove_if(m_pairs.begin(), m_pairs.end(), [proxy_id](const BroadphasePair& pair)
+	{
+		return pair.proxyA == proxy_id || pair.proxyB == proxy_id;
+	}), m_pairs.end());
+
+	m_tree.DestroyProxy(proxy_id);
+	m_proxyCount--;
+}
+
+void DynamicTreeBroadphase::MoveProxy(const int proxy_id, const AABB& aabb)
+{
+	m_aabbs[proxy_id] = aabb;
+
+	if (m_tree.MoveProxy(proxy_id, aabb))
+	{
+		BufferMove(proxy_id);
+	}
+}
+
+void DynamicTreeBroadphase::UpdatePairs(std::vector<BroadphasePair>& pairs)
+{
+	// Find the new pairs of every proxy that was reinserted since the last update
+	m_newPairs.clear();
+	for (const int proxy_id : m_moveBuffer)
+	{
+		if (proxy_id == -1)
+		{
+			continue;
+		}
+
+		m_tree.Query(m_tree.GetFatAABB(proxy_id), [this, proxy_id](const int other)
+		{
+			// When both proxies moved the pair is reported by the query of the lower id only
+			if (other == proxy_id || (m_moved[other] && other < proxy_id))
+			{
+				return true;
+			}
+
+			m_newPairs.push_back({ std::min(proxy_id, other), std::max(proxy_id, other) });
+			return true;
+		});
+	}
+
+	for (const int proxy_id : m_moveBuffer)
+	{
+		if (proxy_id != -1)
+		{
+			m_moved[proxy_id] = false;
+		}
+	}
+	m_lastMoveCount = static_cast<int>(m_moveBuffer.size());
+	m_moveBuffer.clear();
+
+	std::sort(m_newPairs.begin(), m_newPairs.end());
+	m_newPairs.erase(std::unique(m_newPairs.begin(), m_newPairs.end()), m_newPairs.end());
+
+	// Drop the kept pairs whose fat boxes separated
+	m_pairs.erase(std::remove_if(m_pairs.begin(), m_pairs.end(), [this](const BroadphasePair& pair)
+	{
+		return !m_tree.GetFatAABB(pair.proxyA).Overlaps(m_tree.GetFatAABB(pair.proxyB));
+	}), m_pairs.end());
+
+	m_mergedPairs.clear();
+	std::set_union(m_pairs.begin(), m_pairs.end(), m_newPairs.begin(), m_newPairs.end(), std::back_inserter(m_mergedPairs));
+	m_pairs.swap(m_mergedPairs);
+
+	// Only the pairs whose tight boxes overlap go to the narrowphase
+	pairs.clear();
+	for (const auto& pair : m_pairs)
+	{
+		if (m_aabbs[pair.proxyA].Overlaps(m_aabbs[pair.proxyB]))
+		{
+			pairs.push_back(pair);
+		}
+	}
+}
+
+void DynamicTreeBroadphase::Query(const AABB& aabb, std::vector<int>& proxies) const
+{
+	proxies.clear();
+
+	// The tree holds fat boxes, check the tight one before reporting
+	m_tree.Query(aabb, [this, &aabb, &proxies](const int proxy_id)
+	{
+		if (m_aabbs[proxy_id].Overlaps(aabb))
+		{
+			proxies.push_back(proxy_id);
+		}
+		return true;
+	});
+}
+
+void DynamicTreeBroadphase::RayCast(const RayCastInput& input, const float max_fraction, const RayCastCallback& callback) const
+{
+	m_tree.RayCast(input.start, input.translation, input.radius, max_fraction, [this, &input, &callback](const int proxy_id, const float clip)
+	{
+		float enter;
+		if (!m_aabbs[proxy_id].Grow(input.radius).RayCast(input.start, input.translation, clip, enter))
+		{
+			return clip;
+		}
+		return callback(proxy_id, clip);
+	});
+}
+
+int DynamicTreeBroadphase::GetProxyCount() const
+{
+	return m_proxyCount;
+}
+
+BroadphaseType DynamicTreeBroadphase::GetType() const
+{
+	return BroadphaseType::DYNAMIC_TREE;
+}
+
+const DynamicTree& DynamicTreeBroadphase::GetTree() const
+{
+	return m_tree;
+}
+
+int DynamicTreeBroadphase::GetMoveCount() const
+{
+	return m_lastMoveCount;
+}
+
+void DynamicTreeBroadphase::SetMargin(const float margin)
+{
+	m_tree.SetMargin(margin);
+}
+
+void DynamicTreeBroadphase::BufferMove(const int proxy_id)
+{
+	if (!m_moved[proxy_id])
+	{
+		m_moved[proxy_id] = true;
+		m_moveBuffer.push_back(proxy_id);
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#ifndef __DYNAMIC_TREE_BROADPHASE__
+#define __DYNAMIC_TREE_BROADPHASE__
+#include "Broadphase.h"
+#include "DynamicTree.h"
+
+/*
+ * Broadphase on top of a DynamicTree. Overlapping pairs are kept between updates and only the proxies
+ * that left their fat box are queried again, so a resting scene costs almost nothing.
+ * Handles large static bodies next to small debris much better than a uniform grid
+ */
+class DynamicTreeBroadphase final : public Broadphase
+{
+public:
+	int CreateProxy(const AABB& aabb) override;
+	void DestroyProxy(int proxy_id) override;
+	void MoveProxy(int proxy_id, const AABB& aabb) override;
+	void UpdatePairs(std::vector<BroadphasePair>& pairs) override;
+	void Query(const AABB& aabb, std::vector<int>& proxies) const override;
+	void RayCast(const RayCastInput& input, float max_fraction, const RayCastCallback& callback) const override;
+
+	[[nodiscard]] int GetProxyCount() const override;
+	[[nodiscard]] BroadphaseType GetType() const override;
+
+	[[nodiscard]] const DynamicTree& GetTree() const;
+	[[nodiscard]] int GetMoveCount() const;
+	void SetMargin(float margin);
+
+private:
+	void BufferMove(int proxy_id);
+
+	DynamicTree m_tree;
+
+	// Tight boxes of the proxies, indexed by tree node
+	std::vector<AABB> m_aabbs;
+	std::vector<bool> m_moved;
+	std::vector<int> m_moveBuffer;
+
+	// Pairs whose fat boxes overlap, sorted
+	std::vector<BroadphasePair> m_pairs;
+	std::vector<BroadphasePair> m_newPairs;
+	std::vector<BroadphasePair> m_mergedPairs;
+
+	int m_proxyCount = 0;
+	int m_lastMoveCount = 0;
+};
+
+#endif /* defined (__DYNAMIC_TREE_BROADPHASE__) */
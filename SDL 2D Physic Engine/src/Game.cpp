@@ -4,6 +4,7 @@
 #include <iomanip>
 #include "glm/gtx/string_cast.hpp"
 #include "Renderer.h"
+#include "SpriteBatch.h"
 #include "EventManager.h"
 
 
@@ -192,6 +193,7 @@ void Game::Render() const
 	SDL_RenderClear(Renderer::Instance().GetRenderer()); // clear the renderer to the draw colour
 
 	m_pCurrentScene->Draw();
+	SpriteBatch::Instance().Flush();
 
 	SDL_RenderPresent(Renderer::Instance().GetRenderer()); // draw to the screen
 
@@ -1,7 +1,7 @@
 #include "GameObject.h"
 
 GameObject::GameObject() :
-	m_width(0), m_height(0), m_type(GameObjectType::NONE), m_enabled(true), m_visible(true)
+	m_width(0), m_height(0), m_type(GameObjectType::NONE), m_enabled(true), m_visible(true), m_colliding(false)
 {
 	m_rigidBody.gameObject = this;
 }
@@ -69,6 +69,16 @@ bool GameObject::IsVisible() const
 	return m_visible;
 }
 
+void GameObject::SetColliding(const bool state)
+{
+	m_colliding = state;
+}
+
+bool GameObject::IsColliding() const
+{
+	return m_colliding;
+}
+
 void GameObject::ResetTime()
 {
 	time = 0;
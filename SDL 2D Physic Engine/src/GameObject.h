@@ -38,12 +38,16 @@ public:
 	[[nodiscard]] GameObjectType GetType() const;
 	void SetType(GameObjectType new_type);
 
-	void SetEnabled(bool state);
+	virtual void SetEnabled(bool state);
 	[[nodiscard]] bool IsEnabled() const;
 
-	void SetVisible(bool state);
+	virtual void SetVisible(bool state);
 	[[nodiscard]] bool IsVisible() const;
 
+	// Set by the CollisionManager checks while the object overlaps what it was checked against
+	void SetColliding(bool state);
+	[[nodiscard]] bool IsColliding() const;
+
 	void ResetTime();
 	void SetTime(float t);
 	float GetTime();
@@ -61,6 +65,7 @@ private:
 
 	bool m_enabled;
 	bool m_visible;
+	bool m_colliding;
 	float time = 0.0;
 };
 
@@ -15,7 +15,7 @@ Ground::Ground(int w, int h)
 	GetTransform()->position = glm::vec2(300.0f, 300.0f);
 
 	SetType(GameObjectType::OBSTACLE);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 
 }
 
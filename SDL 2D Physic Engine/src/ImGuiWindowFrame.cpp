@@ -1,4 +1,6 @@
 #include "ImGuiWindowFrame.h"
+#include <cfloat>
+#include <cstdio>
 #include <iostream>
 #include "imgui.h"
 #include "imgui_sdl.h"
@@ -79,6 +81,55 @@ void ImGuiWindowFrame::ClearWindow() const
 	SDL_RenderClear(GetRenderer());
 }
 
+void ImGuiWindowFrame::PhysicsProfilerPanel(PhysicsProfiler& profiler, bool* open) const
+{
+	const bool window_shown = (SDL_GetWindowFlags(GetWindow()) & SDL_WINDOW_HIDDEN) == 0;
+	profiler.SetEnabled(PHYSICS_PROFILING && *open && window_shown);
+
+	if (!*open)
+	{
+		return;
+	}
+
+	ImGui::Begin("Physics Profiler", open, ImGuiWindowFlags_AlwaysAutoResize);
+
+#if PHYSICS_PROFILING
+	const int offset = profiler.GetHistoryOffset();
+	const ImVec2 graph_size = ImVec2(300, 40);
+	char overlay[64];
+
+	ImGui::Text("Last %d steps, milliseconds", profiler.GetSampleCount());
+
+	const PhysicsProfiler::Stats step_stats = profiler.GetStepStats();
+	sprintf(overlay, "min %.3f avg %.3f p99 %.3f", step_stats.min, step_stats.average, step_stats.p99);
+	ImGui::PlotLines("Step", profiler.GetStepHistory(), PhysicsProfiler::HISTORY_SIZE, offset, overlay, 0.0f, FLT_MAX, graph_size);
+
+	ImGui::Separator();
+
+	for (int i = 0; i < PhysicsProfiler::PHASE_COUNT; i++)
+	{
+		const auto phase = static_cast<ProfilerPhase>(i);
+		const PhysicsProfiler::Stats stats = profiler.GetStats(phase);
+		sprintf(overlay, "min %.3f avg %.3f p99 %.3f", stats.min, stats.average, stats.p99);
+		ImGui::PlotLines(PhysicsProfiler::GetName(phase), profiler.GetHistory(phase), PhysicsProfiler::HISTORY_SIZE, offset, overlay, 0.0f, FLT_MAX, graph_size);
+	}
+
+	ImGui::Separator();
+
+	for (int i = 0; i < PhysicsProfiler::COUNTER_COUNT; i++)
+	{
+		const auto counter = static_cast<ProfilerCounter>(i);
+		const PhysicsProfiler::Stats stats = profiler.GetStats(counter);
+		sprintf(overlay, "min %.0f avg %.1f p99 %.0f", stats.min, stats.average, stats.p99);
+		ImGui::PlotLines(PhysicsProfiler::GetName(counter), profiler.GetHistory(counter), PhysicsProfiler::HISTORY_SIZE, offset, overlay, 0.0f, FLT_MAX, graph_size);
+	}
+#else
+	ImGui::Text("Profiling is compiled out of this build, define PHYSICS_PROFILING to 1 to keep it");
+#endif
+
+	ImGui::End();
+}
+
 void ImGuiWindowFrame::DefaultGuiFunction()
 {
 	// Always open with a NewFrame
@@ -3,6 +3,7 @@
 #define __IMGUI_WINDOW_FRAME__
 #include <SDL.h>
 #include "Config.h"
+#include "PhysicsProfiler.h"
 #include <functional>
 
 /* Singleton */
@@ -29,6 +30,10 @@ public:
 	void SetGuiFunction(const Callback& callback);
 	void SetDefaultGuiFunction();
 	void ClearWindow() const;
+
+	// Rolling graphs and min / avg / p99 of every physics phase, call from a GUI function. The profiler
+	// only records while the panel is open and the window is shown
+	void PhysicsProfilerPanel(PhysicsProfiler& profiler, bool* open) const;
 	
 
 private:
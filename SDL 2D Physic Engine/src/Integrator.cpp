@@ -0,0 +1,326 @@
+#include "Integrator.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define INTEGRATOR_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX inside functions marked for it, MSVC accepts the intrinsics anywhere
+#if defined(INTEGRATOR_X86) && (defined(__GNUC__) || defined(__clang__))
+#define INTEGRATOR_TARGET_AVX __attribute__((target("avx")))
+#else
+#define INTEGRATOR_TARGET_AVX
+#endif
+
+namespace
+{
+	bool CpuSupportsAVX()
+	{
+#if defined(INTEGRATOR_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+		return os_saves_ymm && (info[2] & (1 << 28)) != 0;
+#elif defined(INTEGRATOR_X86)
+		return __builtin_cpu_supports("avx");
+#else
+		return false;
+#endif
+	}
+
+	bool CpuSupportsSSE()
+	{
+		// SSE2 is part of every x64 CPU and of the 32 bit targets the game builds for
+#if defined(INTEGRATOR_X86)
+		return true;
+#else
+		return false;
+#endif
+	}
+}
+
+void Integrator::Integrate(const IntegratorType type, const IntegrationBatch& batch, const float gravity, const float air_friction, const float delta_time)
+{
+	IntegrateVelocities(type, batch, gravity, air_friction, delta_time);
+	IntegratePositions(type, batch, delta_time);
+}
+
+void Integrator::IntegrateVelocities(const IntegratorType type, const IntegrationBatch& batch, const float gravity, const float air_friction, const float delta_time)
+{
+	int first = 0;
+
+	switch (type)
+	{
+	case IntegratorType::AVX:
+		if (IsSupported(IntegratorType::AVX))
+		{
+			first = IntegrateVelocitiesAVX(batch, gravity, air_friction, delta_time);
+		}
+		break;
+	case IntegratorType::SSE:
+		if (IsSupported(IntegratorType::SSE))
+		{
+			first = IntegrateVelocitiesSSE(batch, gravity, air_friction, delta_time);
+		}
+		break;
+	default:
+		break;
+	}
+
+	// Tail that does not fill a register, or everything on the scalar path
+	IntegrateVelocitiesScalar(batch, first, gravity, air_friction, delta_time);
+}
+
+void Integrator::IntegratePositions(const IntegratorType type, const IntegrationBatch& batch, const float delta_time)
+{
+	int first = 0;
+
+	switch (type)
+	{
+	case IntegratorType::AVX:
+		if (IsSupported(IntegratorType::AVX))
+		{
+			first = IntegratePositionsAVX(batch, delta_time);
+		}
+		break;
+	case IntegratorType::SSE:
+		if (IsSupported(IntegratorType::SSE))
+		{
+			first = IntegratePositionsSSE(batch, delta_time);
+		}
+		break;
+	default:
+		break;
+	}
+
+	IntegratePositionsScalar(batch, first, delta_time);
+}
+
+IntegratorType Integrator::GetBestType()
+{
+	static const IntegratorType best = CpuSupportsAVX() ? IntegratorType::AVX :
+		(CpuSupportsSSE() ? IntegratorType::SSE : IntegratorType::SCALAR);
+	return best;
+}
+
+bool Integrator::IsSupported(const IntegratorType type)
+{
+	switch (type)
+	{
+	case IntegratorType::SCALAR:
+		return true;
+	case IntegratorType::SSE:
+		return GetBestType() != IntegratorType::SCALAR;
+	case IntegratorType::AVX:
+		return GetBestType() == IntegratorType::AVX;
+	default:
+		return false;
+	}
+}
+
+const char* Integrator::GetName(const IntegratorType type)
+{
+	switch (type)
+	{
+	case IntegratorType::SCALAR:
+		return "Scalar";
+	case IntegratorType::SSE:
+		return "SSE";
+	case IntegratorType::AVX:
+		return "AVX";
+	default:
+		return "Unknown";
+	}
+}
+
+void Integrator::IntegrateVelocitiesScalar(const IntegrationBatch& batch, const int first, const float gravity, const float air_friction, const float delta_time)
+{
+	for (int i = first; i < batch.count; i++)
+	{
+		if (!batch.enableGravity[i] || !batch.awake[i])
+		{
+			continue;
+		}
+
+		// Apply gravity force
+		const float fGravityX = gravity * batch.gravityScaleX[i] * batch.mass[i];
+		const float fGravityY = gravity * batch.gravityScaleY[i] * batch.mass[i];
+
+		const float accelerationX = (batch.forceX[i] + fGravityX) * batch.inverseMass[i];
+		const float accelerationY = (batch.forceY[i] + fGravityY) * batch.inverseMass[i];
+
+		// Apply Friction, then the gravity acceleretation to velocity
+		batch.velocityX[i] = batch.velocityX[i] * air_friction + accelerationX * delta_time;
+		batch.velocityY[i] = batch.velocityY[i] * air_friction + accelerationY * delta_time;
+		batch.forceX[i] = 0.0f;
+		batch.forceY[i] = 0.0f;
+	}
+}
+
+void Integrator::IntegratePositionsScalar(const IntegrationBatch& batch, const int first, const float delta_time)
+{
+	for (int i = first; i < batch.count; i++)
+	{
+		if (batch.bodyType[i] == BodyType::STATIC || !batch.awake[i])
+		{
+			continue;
+		}
+
+		// Apply velocity to the position
+		batch.positionX[i] += batch.velocityX[i] * delta_time;
+		batch.positionY[i] += batch.velocityY[i] * delta_time;
+	}
+}
+
+int Integrator::IntegrateVelocitiesSSE(const IntegrationBatch& batch, const float gravity, const float air_friction, const float delta_time)
+{
+#if defined(INTEGRATOR_X86)
+	const __m128 friction = _mm_set1_ps(air_friction);
+	const __m128 g = _mm_set1_ps(gravity);
+	const __m128 dt = _mm_set1_ps(delta_time);
+
+	int i = 0;
+	for (; i + 4 <= batch.count; i += 4)
+	{
+		// All ones in the lanes of bodies with gravity, the others keep their old values
+		const __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.enableGravity + i));
+		const __m128i awake = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.awake + i));
+		const __m128 mask = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(flags, _mm_setzero_si128()), _mm_cmpgt_epi32(awake, _mm_setzero_si128())));
+
+		const __m128 mass = _mm_loadu_ps(batch.mass + i);
+		const __m128 inverse_mass = _mm_loadu_ps(batch.inverseMass + i);
+
+		const __m128 velocity_x = _mm_loadu_ps(batch.velocityX + i);
+		const __m128 velocity_y = _mm_loadu_ps(batch.velocityY + i);
+		const __m128 force_x = _mm_loadu_ps(batch.forceX + i);
+		const __m128 force_y = _mm_loadu_ps(batch.forceY + i);
+
+		const __m128 gravity_x = _mm_mul_ps(_mm_mul_ps(g, _mm_loadu_ps(batch.gravityScaleX + i)), mass);
+		const __m128 gravity_y = _mm_mul_ps(_mm_mul_ps(g, _mm_loadu_ps(batch.gravityScaleY + i)), mass);
+
+		const __m128 acceleration_x = _mm_mul_ps(_mm_add_ps(force_x, gravity_x), inverse_mass);
+		const __m128 acceleration_y = _mm_mul_ps(_mm_add_ps(force_y, gravity_y), inverse_mass);
+
+		const __m128 new_velocity_x = _mm_add_ps(_mm_mul_ps(velocity_x, friction), _mm_mul_ps(acceleration_x, dt));
+		const __m128 new_velocity_y = _mm_add_ps(_mm_mul_ps(velocity_y, friction), _mm_mul_ps(acceleration_y, dt));
+
+		_mm_storeu_ps(batch.velocityX + i, _mm_or_ps(_mm_and_ps(mask, new_velocity_x), _mm_andnot_ps(mask, velocity_x)));
+		_mm_storeu_ps(batch.velocityY + i, _mm_or_ps(_mm_and_ps(mask, new_velocity_y), _mm_andnot_ps(mask, velocity_y)));
+		_mm_storeu_ps(batch.forceX + i, _mm_andnot_ps(mask, force_x));
+		_mm_storeu_ps(batch.forceY + i, _mm_andnot_ps(mask, force_y));
+	}
+
+	return i;
+#else
+	return 0;
+#endif
+}
+
+int Integrator::IntegratePositionsSSE(const IntegrationBatch& batch, const float delta_time)
+{
+#if defined(INTEGRATOR_X86)
+	const __m128 dt = _mm_set1_ps(delta_time);
+
+	int i = 0;
+	for (; i + 4 <= batch.count; i += 4)
+	{
+		// Every body but the static ones, their type is 0
+		const __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.bodyType + i));
+		const __m128i awake = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.awake + i));
+		const __m128 mask = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(flags, _mm_setzero_si128()), _mm_cmpgt_epi32(awake, _mm_setzero_si128())));
+
+		// Masked lanes add zero
+		const __m128 step_x = _mm_and_ps(mask, _mm_mul_ps(_mm_loadu_ps(batch.velocityX + i), dt));
+		const __m128 step_y = _mm_and_ps(mask, _mm_mul_ps(_mm_loadu_ps(batch.velocityY + i), dt));
+
+		_mm_storeu_ps(batch.positionX + i, _mm_add_ps(_mm_loadu_ps(batch.positionX + i), step_x));
+		_mm_storeu_ps(batch.positionY + i, _mm_add_ps(_mm_loadu_ps(batch.positionY + i), step_y));
+	}
+
+	return i;
+#else
+	return 0;
+#endif
+}
+
+INTEGRATOR_TARGET_AVX int Integrator::IntegrateVelocitiesAVX(const IntegrationBatch& batch, const float gravity, const float air_friction, const float delta_time)
+{
+#if defined(INTEGRATOR_X86)
+	const __m256 friction = _mm256_set1_ps(air_friction);
+	const __m256 g = _mm256_set1_ps(gravity);
+	const __m256 dt = _mm256_set1_ps(delta_time);
+	const __m256 zero = _mm256_setzero_ps();
+
+	int i = 0;
+	for (; i + 8 <= batch.count; i += 8)
+	{
+		// AVX has no 256 bit integer compare, the flags are 0 or 1 so compare them as floats
+		const __m256i flags = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.enableGravity + i));
+		const __m256i awake = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.awake + i));
+		const __m256 mask = _mm256_and_ps(_mm256_cmp_ps(_mm256_cvtepi32_ps(flags), zero, _CMP_GT_OQ),
+			_mm256_cmp_ps(_mm256_cvtepi32_ps(awake), zero, _CMP_GT_OQ));
+
+		const __m256 mass = _mm256_loadu_ps(batch.mass + i);
+		const __m256 inverse_mass = _mm256_loadu_ps(batch.inverseMass + i);
+
+		const __m256 velocity_x = _mm256_loadu_ps(batch.velocityX + i);
+		const __m256 velocity_y = _mm256_loadu_ps(batch.velocityY + i);
+		const __m256 force_x = _mm256_loadu_ps(batch.forceX + i);
+		const __m256 force_y = _mm256_loadu_ps(batch.forceY + i);
+
+		const __m256 gravity_x = _mm256_mul_ps(_mm256_mul_ps(g, _mm256_loadu_ps(batch.gravityScaleX + i)), mass);
+		const __m256 gravity_y = _mm256_mul_ps(_mm256_mul_ps(g, _mm256_loadu_ps(batch.gravityScaleY + i)), mass);
+
+		const __m256 acceleration_x = _mm256_mul_ps(_mm256_add_ps(force_x, gravity_x), inverse_mass);
+		const __m256 acceleration_y = _mm256_mul_ps(_mm256_add_ps(force_y, gravity_y), inverse_mass);
+
+		const __m256 new_velocity_x = _mm256_add_ps(_mm256_mul_ps(velocity_x, friction), _mm256_mul_ps(acceleration_x, dt));
+		const __m256 new_velocity_y = _mm256_add_ps(_mm256_mul_ps(velocity_y, friction), _mm256_mul_ps(acceleration_y, dt));
+
+		_mm256_storeu_ps(batch.velocityX + i, _mm256_blendv_ps(velocity_x, new_velocity_x, mask));
+		_mm256_storeu_ps(batch.velocityY + i, _mm256_blendv_ps(velocity_y, new_velocity_y, mask));
+		_mm256_storeu_ps(batch.forceX + i, _mm256_blendv_ps(force_x, zero, mask));
+		_mm256_storeu_ps(batch.forceY + i, _mm256_blendv_ps(force_y, zero, mask));
+	}
+
+	// Avoid the AVX to SSE transition penalty in the scalar tail
+	_mm256_zeroupper();
+
+	return i;
+#else
+	return 0;
+#endif
+}
+
+INTEGRATOR_TARGET_AVX int Integrator::IntegratePositionsAVX(const IntegrationBatch& batch, const float delta_time)
+{
+#if defined(INTEGRATOR_X86)
+	const __m256 dt = _mm256_set1_ps(delta_time);
+	const __m256 zero = _mm256_setzero_ps();
+
+	int i = 0;
+	for (; i + 8 <= batch.count; i += 8)
+	{
+		const __m256i flags = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.bodyType + i));
+		const __m256i awake = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.awake + i));
+		const __m256 mask = _mm256_and_ps(_mm256_cmp_ps(_mm256_cvtepi32_ps(flags), zero, _CMP_GT_OQ),
+			_mm256_cmp_ps(_mm256_cvtepi32_ps(awake), zero, _CMP_GT_OQ));
+
+		// Masked lanes add zero
+		const __m256 step_x = _mm256_and_ps(mask, _mm256_mul_ps(_mm256_loadu_ps(batch.velocityX + i), dt));
+		const __m256 step_y = _mm256_and_ps(mask, _mm256_mul_ps(_mm256_loadu_ps(batch.velocityY + i), dt));
+
+		_mm256_storeu_ps(batch.positionX + i, _mm256_add_ps(_mm256_loadu_ps(batch.positionX + i), step_x));
+		_mm256_storeu_ps(batch.positionY + i, _mm256_add_ps(_mm256_loadu_ps(batch.positionY + i), step_y));
+	}
+
+	_mm256_zeroupper();
+
+	return i;
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,62 @@
+#pragma once
+#ifndef __INTEGRATOR__
+#define __INTEGRATOR__
+#include <cstdint>
+#include "BodyType.h"
+#include "IntegratorType.h"
+
+// Columns the integrator reads and writes, count entries each
+struct IntegrationBatch
+{
+	float* positionX = nullptr;
+	float* positionY = nullptr;
+	float* velocityX = nullptr;
+	float* velocityY = nullptr;
+	float* forceX = nullptr;
+	float* forceY = nullptr;
+	const float* mass = nullptr;
+	const float* inverseMass = nullptr;
+	const float* gravityScaleX = nullptr;
+	const float* gravityScaleY = nullptr;
+	const BodyType* bodyType = nullptr;
+	const uint32_t* enableGravity = nullptr;
+	const uint32_t* awake = nullptr;
+	int count = 0;
+};
+
+/*
+ * Semi-implicit Euler for every awake body with gravity enabled. The velocity pass applies air friction, gravity
+ * and the accumulated force, then clears the force. The position pass moves the bodies by their velocity,
+ * so the contact solver can run in between and resting bodies are not pushed into what they rest on.
+ * Kinematic bodies skip the velocity pass and are moved by the position pass.
+ *
+ * The SSE and AVX kernels do the same operations in the same order on 4 or 8 bodies at a time, the bodies
+ * without gravity or asleep are masked out, and the remainder goes through the scalar loop. The paths agree to
+ * within float rounding
+ */
+class Integrator
+{
+public:
+	// Velocity pass followed by the position pass
+	static void Integrate(IntegratorType type, const IntegrationBatch& batch, float gravity, float air_friction, float delta_time);
+
+	static void IntegrateVelocities(IntegratorType type, const IntegrationBatch& batch, float gravity, float air_friction, float delta_time);
+	static void IntegratePositions(IntegratorType type, const IntegrationBatch& batch, float delta_time);
+
+	// Widest kernel the CPU running the game supports, checked once
+	[[nodiscard]] static IntegratorType GetBestType();
+	[[nodiscard]] static bool IsSupported(IntegratorType type);
+	[[nodiscard]] static const char* GetName(IntegratorType type);
+
+private:
+	static void IntegrateVelocitiesScalar(const IntegrationBatch& batch, int first, float gravity, float air_friction, float delta_time);
+	static void IntegratePositionsScalar(const IntegrationBatch& batch, int first, float delta_time);
+
+	// Return the index of the first body left for the scalar tail
+	static int IntegrateVelocitiesSSE(const IntegrationBatch& batch, float gravity, float air_friction, float delta_time);
+	static int IntegratePositionsSSE(const IntegrationBatch& batch, float delta_time);
+	static int IntegrateVelocitiesAVX(const IntegrationBatch& batch, float gravity, float air_friction, float delta_time);
+	static int IntegratePositionsAVX(const IntegrationBatch& batch, float delta_time);
+};
+
+#endif /* defined (__INTEGRATOR__) */
@@ -0,0 +1,13 @@
+#pragma once
+#ifndef __INTEGRATOR_TYPE__
+#define __INTEGRATOR_TYPE__
+
+enum class IntegratorType
+{
+	SCALAR,
+	SSE,
+	AVX,
+	NUM_OF_TYPES
+};
+
+#endif /* defined (__INTEGRATOR_TYPE__) */
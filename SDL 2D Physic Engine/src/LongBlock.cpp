@@ -2,6 +2,7 @@
 
 
 #include "SoundManager.h"
+#include "SpriteBatch.h"
 #include "TextureManager.h"
 
 LongBlock::LongBlock(int w, int h)
@@ -21,7 +22,7 @@ LongBlock::LongBlock(int w, int h)
 	GetTransform()->position = glm::vec2(300.0f, 300.0f);
 
 	SetType(GameObjectType::OBSTACLE);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 
 
 }
@@ -31,7 +32,7 @@ LongBlock::~LongBlock()
 
 void LongBlock::Draw()
 {
-	TextureManager::Instance().Draw("LongBlock", GetTransform()->position, 0, 255, true);
+	SpriteBatch::Instance().Draw("LongBlock", GetTransform()->position, 0, 255, true);
 }
 
 void LongBlock::Update()
@@ -1,5 +1,6 @@
 #include "MediumPig.h"
 #include "SoundManager.h"
+#include "SpriteBatch.h"
 #include "TextureManager.h"
 
 MediumPig::MediumPig(int w, int h)
@@ -19,7 +20,7 @@ MediumPig::MediumPig(int w, int h)
 	GetTransform()->position = glm::vec2(300.0f, 300.0f);
 
 	SetType(GameObjectType::PIG);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 }
 
 MediumPig::~MediumPig()
@@ -27,7 +28,7 @@ MediumPig::~MediumPig()
 
 void MediumPig::Draw()
 {
-	TextureManager::Instance().Draw("MediumPig", GetTransform()->position, 0, 255, true);
+	SpriteBatch::Instance().Draw("MediumPig", GetTransform()->position, 0, 255, true);
 }
 
 void MediumPig::Update()
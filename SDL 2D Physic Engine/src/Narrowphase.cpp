@@ -0,0 +1,627 @@
+#include "Narrowphase.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	constexpr int GJK_MAX_ITERATIONS = 20;
+	constexpr int EPA_MAX_ITERATIONS = 32;
+	constexpr int EPA_MAX_VERTICES = EPA_MAX_ITERATIONS + 4;
+
+	// Cores closer than this overlap as far as GJK is concerned
+	constexpr float GJK_TOLERANCE = 1e-4f;
+
+	// EPA stops once a new support point gets the polytope less than this much closer to the surface, in pixels
+	constexpr float EPA_TOLERANCE = 0.01f;
+
+	float Sign(const float value)
+	{
+		return (value < 0.0f) ? -1.0f : 1.0f;
+	}
+
+	float Dot(const glm::vec2 lhs, const glm::vec2 rhs)
+	{
+		return lhs.x * rhs.x + lhs.y * rhs.y;
+	}
+
+	float Cross(const glm::vec2 lhs, const glm::vec2 rhs)
+	{
+		return lhs.x * rhs.y - lhs.y * rhs.x;
+	}
+
+	// Point of the Minkowski difference B - A, with the support points it came from
+	struct SupportPoint
+	{
+		glm::vec2 a;
+		glm::vec2 b;
+		glm::vec2 w;
+		int indexA;
+		int indexB;
+		float weight;
+	};
+
+	struct ConvexPair
+	{
+		const ConvexShape& shapeA;
+		glm::vec2 positionA;
+		const ConvexShape& shapeB;
+		glm::vec2 positionB;
+
+		[[nodiscard]] SupportPoint GetPoint(const int index_a, const int index_b) const
+		{
+			SupportPoint point;
+			point.indexA = index_a;
+			point.indexB = index_b;
+			point.a = positionA + shapeA.vertices[index_a];
+			point.b = positionB + shapeB.vertices[index_b];
+			point.w = point.b - point.a;
+			point.weight = 1.0f;
+			return point;
+		}
+
+		// Furthest point of B - A along direction
+		[[nodiscard]] SupportPoint GetSupport(const glm::vec2 direction) const
+		{
+			return GetPoint(shapeA.GetSupport(-direction), shapeB.GetSupport(direction));
+		}
+	};
+
+	// Up to three points of B - A and the barycentric weights of the point closest to the origin
+	struct Simplex
+	{
+		SupportPoint points[3];
+		int count = 0;
+
+		// Closest point of a segment, drops the end that does not contribute
+		void Solve2()
+		{
+			const glm::vec2 w1 = points[0].w;
+			const glm::vec2 w2 = points[1].w;
+			const glm::vec2 edge = w2 - w1;
+
+			const float weight_2 = -Dot(w1, edge);
+			if (weight_2 <= 0.0f)
+			{
+				points[0].weight = 1.0f;
+				count = 1;
+				return;
+			}
+
+			const float weight_1 = Dot(w2, edge);
+			if (weight_1 <= 0.0f)
+			{
+				points[0] = points[1];
+				points[0].weight = 1.0f;
+				count = 1;
+				return;
+			}
+
+			const float inverse = 1.0f / (weight_1 + weight_2);
+			points[0].weight = weight_1 * inverse;
+			points[1].weight = weight_2 * inverse;
+			count = 2;
+		}
+
+		// Closest point of a triangle, reduced to the vertex or edge it lies on when the origin is outside
+		void Solve3()
+		{
+			const glm::vec2 w1 = points[0].w;
+			const glm::vec2 w2 = points[1].w;
+			const glm::vec2 w3 = points[2].w;
+
+			const glm::vec2 e12 = w2 - w1;
+			const float d12_1 = Dot(w2, e12);
+			const float d12_2 = -Dot(w1, e12);
+
+			const glm::vec2 e13 = w3 - w1;
+			const float d13_1 = Dot(w3, e13);
+			const float d13_2 = -Dot(w1, e13);
+
+			const glm::vec2 e23 = w3 - w2;
+			const float d23_1 = Dot(w3, e23);
+			const float d23_2 = -Dot(w2, e23);
+
+			const float area = Cross(e12, e13);
+			const float d123_1 = area * Cross(w2, w3);
+			const float d123_2 = area * Cross(w3, w1);
+			const float d123_3 = area * Cross(w1, w2);
+
+			if (d12_2 <= 0.0f && d13_2 <= 0.0f)
+			{
+				points[0].weight = 1.0f;
+				count = 1;
+				return;
+			}
+
+			if (d12_1 > 0.0f && d12_2 > 0.0f && d123_3 <= 0.0f)
+			{
+				const float inverse = 1.0f / (d12_1 + d12_2);
+				points[0].weight = d12_1 * inverse;
+				points[1].weight = d12_2 * inverse;
+				count = 2;
+				return;
+			}
+
+			if (d13_1 > 0.0f && d13_2 > 0.0f && d123_2 <= 0.0f)
+			{
+				const float inverse = 1.0f / (d13_1 + d13_2);
+				points[0].weight = d13_1 * inverse;
+				points[1] = points[2];
+				points[1].weight = d13_2 * inverse;
+				count = 2;
+				return;
+			}
+
+			if (d12_1 <= 0.0f && d23_2 <= 0.0f)
+			{
+				points[0] = points[1];
+				points[0].weight = 1.0f;
+				count = 1;
+				return;
+			}
+
+			if (d13_1 <= 0.0f && d23_1 <= 0.0f)
+			{
+				points[0] = points[2];
+				points[0].weight = 1.0f;
+				count = 1;
+				return;
+			}
+
+			if (d23_1 > 0.0f && d23_2 > 0.0f && d123_1 <= 0.0f)
+			{
+				const float inverse = 1.0f / (d23_1 + d23_2);
+				points[0] = points[2];
+				points[0].weight = d23_2 * inverse;
+				points[1].weight = d23_1 * inverse;
+				count = 2;
+				return;
+			}
+
+			const float sum = d123_1 + d123_2 + d123_3;
+			if (sum <= 0.0f)
+			{
+				// Flat triangle from a stale cache, the first edge is as good a start as any
+				count = 2;
+				Solve2();
+				return;
+			}
+
+			const float inverse = 1.0f / sum;
+			points[0].weight = d123_1 * inverse;
+			points[1].weight = d123_2 * inverse;
+			points[2].weight = d123_3 * inverse;
+			count = 3;
+		}
+
+		[[nodiscard]] glm::vec2 GetSearchDirection() const
+		{
+			if (count == 1)
+			{
+				return -points[0].w;
+			}
+
+			// Perpendicular to the edge, on the side of the origin
+			const glm::vec2 edge = points[1].w - points[0].w;
+			return (Cross(edge, -points[0].w) > 0.0f) ? glm::vec2(-edge.y, edge.x) : glm::vec2(edge.y, -edge.x);
+		}
+
+		void GetWitnessPoints(glm::vec2& point_a, glm::vec2& point_b) const
+		{
+			point_a = glm::vec2(0, 0);
+			point_b = glm::vec2(0, 0);
+			for (int i = 0; i < count; i++)
+			{
+				point_a += points[i].a * points[i].weight;
+				point_b += points[i].b * points[i].weight;
+			}
+		}
+
+		[[nodiscard]] uint32_t GetFeatureId() const
+		{
+			return FeatureId(points[0], points[count > 1 ? 1 : 0]);
+		}
+
+		// Four bits per support index, low and high of A then of B, so the order the points were found in
+		// does not change the id
+		static uint32_t FeatureId(const SupportPoint& first, const SupportPoint& second)
+		{
+			const uint32_t low_a = static_cast<uint32_t>(std::min(first.indexA, second.indexA));
+			const uint32_t high_a = static_cast<uint32_t>(std::max(first.indexA, second.indexA));
+			const uint32_t low_b = static_cast<uint32_t>(std::min(first.indexB, second.indexB));
+			const uint32_t high_b = static_cast<uint32_t>(std::max(first.indexB, second.indexB));
+			return (low_a << 12) | (high_a << 8) | (low_b << 4) | high_b;
+		}
+	};
+
+	// Depth of the overlap of two cores, walks out from a simplex containing the origin to the face of B - A
+	// closest to it. Normal points from A to B
+	void Penetrate(const ConvexPair& pair, const Simplex& simplex, glm::vec2& normal, float& depth, uint32_t& feature)
+	{
+		SupportPoint polytope[EPA_MAX_VERTICES];
+		int count = 0;
+
+		if (simplex.count == 3)
+		{
+			std::copy(simplex.points, simplex.points + 3, polytope);
+			count = 3;
+		}
+		else if (simplex.count == 2)
+		{
+			// Origin on a segment of B - A, grow it both ways across the segment
+			const glm::vec2 edge = simplex.points[1].w - simplex.points[0].w;
+			const float length = std::sqrt(Dot(edge, edge));
+			const glm::vec2 across = (length > 0.0f) ? glm::vec2(-edge.y, edge.x) / length : glm::vec2(0, 1);
+
+			const SupportPoint left = pair.GetSupport(across);
+			const SupportPoint right = pair.GetSupport(-across);
+
+			// B - A is flat, the cores only touch along the line
+			if (Dot(left.w, across) <= GJK_TOLERANCE || Dot(right.w, -across) <= GJK_TOLERANCE)
+			{
+				const bool flat_left = Dot(left.w, across) <= Dot(right.w, -across);
+				normal = flat_left ? -across : across;
+				depth = 0.0f;
+				feature = simplex.GetFeatureId();
+				return;
+			}
+
+			polytope[0] = simplex.points[0];
+			polytope[1] = right;
+			polytope[2] = simplex.points[1];
+			polytope[3] = left;
+			count = 4;
+		}
+		else
+		{
+			// The cores touch at a single point, the centers give the direction
+			const glm::vec2 offset = pair.positionB - pair.positionA;
+			const float length = std::sqrt(Dot(offset, offset));
+			normal = (length > 0.0f) ? offset / length : glm::vec2(0, 1);
+			depth = 0.0f;
+			feature = simplex.GetFeatureId();
+			return;
+		}
+
+		// Edges are walked counter clockwise so the outward normal of an edge is its direction turned right
+		if (Cross(polytope[1].w - polytope[0].w, polytope[2].w - polytope[0].w) < 0.0f)
+		{
+			std::reverse(polytope, polytope + count);
+		}
+
+		for (int iteration = 0; ; iteration++)
+		{
+			int closest = 0;
+			float closest_distance = std::numeric_limits<float>::max();
+			glm::vec2 closest_normal = glm::vec2(0, 1);
+
+			for (int i = 0; i < count; i++)
+			{
+				const glm::vec2 edge = polytope[(i + 1) % count].w - polytope[i].w;
+				const float length = std::sqrt(Dot(edge, edge));
+				if (length <= 0.0f)
+				{
+					continue;
+				}
+
+				const glm::vec2 outward = glm::vec2(edge.y, -edge.x) / length;
+				const float distance = Dot(outward, polytope[i].w);
+				if (distance < closest_distance)
+				{
+					closest = i;
+					closest_distance = distance;
+					closest_normal = outward;
+				}
+			}
+
+			const SupportPoint support = pair.GetSupport(closest_normal);
+			if (Dot(support.w, closest_normal) - closest_distance < EPA_TOLERANCE || iteration == EPA_MAX_ITERATIONS || count == EPA_MAX_VERTICES)
+			{
+				// Pushing B out along the face normal separates them, so A to B is the other way
+				normal = -closest_normal;
+				depth = std::max(closest_distance, 0.0f);
+				feature = Simplex::FeatureId(polytope[closest], polytope[(closest + 1) % count]);
+				return;
+			}
+
+			std::copy_backward(polytope + closest + 1, polytope + count, polytope + count + 1);
+			polytope[closest + 1] = support;
+			count++;
+		}
+	}
+
+	// Column and row of the 3x3 grid around a box, 0 below the min, 1 inside, 2 above the max
+	uint32_t Region(const float value, const float half)
+	{
+		if (value < -half)
+		{
+			return 0;
+		}
+		return (value > half) ? 2 : 1;
+	}
+}
+
+template <CollisionShape ShapeA, CollisionShape ShapeB>
+bool Narrowphase::CollidePair(const BodyStore& bodies, const int a, const int b, const float margin, ContactManifold& manifold)
+{
+	if constexpr (ShapeA == CollisionShape::NO_COLLIDER || ShapeB == CollisionShape::NO_COLLIDER)
+	{
+		return false;
+	}
+	else if constexpr (ShapeA == CollisionShape::CIRCLE && ShapeB == CollisionShape::CIRCLE)
+	{
+		return CollideCircles(bodies, a, b, margin, manifold);
+	}
+	else if constexpr (ShapeA == CollisionShape::RECTANGLE && ShapeB == CollisionShape::RECTANGLE)
+	{
+		return CollideBoxes(bodies, a, b, margin, manifold);
+	}
+	else if constexpr (ShapeA == CollisionShape::RECTANGLE && ShapeB == CollisionShape::CIRCLE)
+	{
+		return CollideBoxCircle(bodies, a, b, margin, manifold);
+	}
+	else if constexpr (ShapeA == CollisionShape::CIRCLE && ShapeB == CollisionShape::RECTANGLE)
+	{
+		if (!CollideBoxCircle(bodies, b, a, margin, manifold))
+		{
+			return false;
+		}
+
+		// Keep the normal going from A to B
+		manifold.normal = -manifold.normal;
+		return true;
+	}
+	else
+	{
+		return CollideConvex(bodies.convex[a], bodies.GetPosition(a), bodies.convex[b], bodies.GetPosition(b), margin, manifold);
+	}
+}
+
+template <size_t... Pairs>
+constexpr std::array<Narrowphase::CollideFunction, sizeof...(Pairs)> Narrowphase::MakeDispatchTable(std::index_sequence<Pairs...>)
+{
+	return { { &CollidePair<static_cast<CollisionShape>(Pairs / SHAPE_COUNT), static_cast<CollisionShape>(Pairs % SHAPE_COUNT)>... } };
+}
+
+bool Narrowphase::Collide(const BodyStore& bodies, const int a, const int b, const float margin, ContactManifold& manifold)
+{
+	static constexpr std::array<CollideFunction, SHAPE_COUNT * SHAPE_COUNT> DISPATCH =
+		MakeDispatchTable(std::make_index_sequence<SHAPE_COUNT * SHAPE_COUNT>());
+
+	manifold.bodyA = a;
+	manifold.bodyB = b;
+	manifold.pointCount = 0;
+
+	const size_t shape_a = static_cast<size_t>(bodies.shape[a]);
+	const size_t shape_b = static_cast<size_t>(bodies.shape[b]);
+	return DISPATCH[shape_a * SHAPE_COUNT + shape_b](bodies, a, b, margin, manifold);
+}
+
+bool Narrowphase::CollideConvex(const ConvexShape& shape_a, const glm::vec2 position_a, const ConvexShape& shape_b,
+	const glm::vec2 position_b, const float margin, ContactManifold& manifold)
+{
+	const ConvexPair pair = { shape_a, position_a, shape_b, position_b };
+	SimplexCache& cache = manifold.simplexCache;
+
+	// Last step's simplex, unless the shapes it indexes are not these. Its points were support points, and the
+	// shapes do not turn, so they are still on the surface of B - A wherever the bodies moved
+	Simplex simplex;
+	for (int i = 0; i < cache.count; i++)
+	{
+		if (cache.indexA[i] >= shape_a.count || cache.indexB[i] >= shape_b.count)
+		{
+			simplex.count = 0;
+			break;
+		}
+		simplex.points[simplex.count++] = pair.GetPoint(cache.indexA[i], cache.indexB[i]);
+	}
+
+	if (simplex.count == 0)
+	{
+		// Start from a support point too, EPA needs every point it is handed on the surface to stay convex
+		const glm::vec2 offset = position_b - position_a;
+		simplex.points[0] = pair.GetSupport((Dot(offset, offset) > 0.0f) ? -offset : glm::vec2(0, 1));
+		simplex.count = 1;
+	}
+
+	// GJK, the simplex closes in on the point of B - A closest to the origin until it stops getting closer
+	// or surrounds the origin
+	for (int iteration = 0; iteration < GJK_MAX_ITERATIONS; iteration++)
+	{
+		int previous_a[3];
+		int previous_b[3];
+		const int previous_count = simplex.count;
+		for (int i = 0; i < previous_count; i++)
+		{
+			previous_a[i] = simplex.points[i].indexA;
+			previous_b[i] = simplex.points[i].indexB;
+		}
+
+		if (simplex.count == 2)
+		{
+			simplex.Solve2();
+		}
+		else if (simplex.count == 3)
+		{
+			simplex.Solve3();
+		}
+
+		if (simplex.count == 3)
+		{
+			break;
+		}
+
+		const glm::vec2 direction = simplex.GetSearchDirection();
+		if (Dot(direction, direction) < GJK_TOLERANCE * GJK_TOLERANCE)
+		{
+			break;
+		}
+
+		const SupportPoint support = pair.GetSupport(direction);
+
+		// A point the simplex just had means it cannot get any closer
+		bool duplicate = false;
+		for (int i = 0; i < previous_count; i++)
+		{
+			duplicate = duplicate || (support.indexA == previous_a[i] && support.indexB == previous_b[i]);
+		}
+		if (duplicate)
+		{
+			break;
+		}
+
+		simplex.points[simplex.count++] = support;
+	}
+
+	// Out of iterations right after a point was added, weigh it in
+	if (simplex.count == 2)
+	{
+		simplex.Solve2();
+	}
+	else if (simplex.count == 3)
+	{
+		simplex.Solve3();
+	}
+
+	cache.count = static_cast<uint8_t>(simplex.count);
+	for (int i = 0; i < simplex.count; i++)
+	{
+		cache.indexA[i] = static_cast<uint8_t>(simplex.points[i].indexA);
+		cache.indexB[i] = static_cast<uint8_t>(simplex.points[i].indexB);
+	}
+
+	glm::vec2 point_a;
+	glm::vec2 point_b;
+	simplex.GetWitnessPoints(point_a, point_b);
+	const glm::vec2 offset = point_b - point_a;
+	const float distance = std::sqrt(Dot(offset, offset));
+	const float radii = shape_a.radius + shape_b.radius;
+
+	glm::vec2 normal;
+	float separation;
+	uint32_t feature;
+
+	if (simplex.count < 3 && distance > GJK_TOLERANCE)
+	{
+		// Cores apart, the radii may still make the shapes overlap
+		separation = distance - radii;
+		if (separation > margin)
+		{
+			return false;
+		}
+
+		normal = offset / distance;
+		feature = simplex.GetFeatureId();
+	}
+	else
+	{
+		float depth;
+		Penetrate(pair, simplex, normal, depth, feature);
+		separation = -depth - radii;
+	}
+
+	manifold.normal = normal;
+	manifold.points[0].separation = separation;
+	manifold.points[0].featureId = feature;
+	manifold.pointCount = 1;
+	return true;
+}
+
+bool Narrowphase::CollideCircles(const BodyStore& bodies, const int a, const int b, const float margin, ContactManifold& manifold)
+{
+	const glm::vec2 displacement = bodies.GetPosition(b) - bodies.GetPosition(a);
+	const float distance = std::sqrt(displacement.x * displacement.x + displacement.y * displacement.y);
+	const float separation = distance - (bodies.radius[a] + bodies.radius[b]);
+
+	if (separation > margin)
+	{
+		return false;
+	}
+
+	// Concentric circles have no direction, push them apart vertically
+	manifold.normal = (distance > 0.0f) ? displacement / distance : glm::vec2(0, 1);
+	manifold.points[0].separation = separation;
+	manifold.points[0].featureId = 0;
+	manifold.pointCount = 1;
+	return true;
+}
+
+bool Narrowphase::CollideBoxes(const BodyStore& bodies, const int a, const int b, const float margin, ContactManifold& manifold)
+{
+	const glm::vec2 displacement = bodies.GetPosition(b) - bodies.GetPosition(a);
+	const float overlap_x = bodies.halfWidth[a] + bodies.halfWidth[b] - std::abs(displacement.x);
+	const float overlap_y = bodies.halfHeight[a] + bodies.halfHeight[b] - std::abs(displacement.y);
+
+	if (overlap_x < -margin || overlap_y < -margin)
+	{
+		return false;
+	}
+
+	// Separate along the axis with the least overlap, the feature is the face of A it goes through
+	if (overlap_x < overlap_y)
+	{
+		manifold.normal = glm::vec2(Sign(displacement.x), 0);
+		manifold.points[0].separation = -overlap_x;
+		manifold.points[0].featureId = (displacement.x < 0.0f) ? 0 : 1;
+	}
+	else
+	{
+		manifold.normal = glm::vec2(0, Sign(displacement.y));
+		manifold.points[0].separation = -overlap_y;
+		manifold.points[0].featureId = (displacement.y < 0.0f) ? 2 : 3;
+	}
+
+	manifold.pointCount = 1;
+	return true;
+}
+
+bool Narrowphase::CollideBoxCircle(const BodyStore& bodies, const int box, const int circle, const float margin, ContactManifold& manifold)
+{
+	const glm::vec2 half = glm::vec2(bodies.halfWidth[box], bodies.halfHeight[box]);
+	const glm::vec2 local = bodies.GetPosition(circle) - bodies.GetPosition(box);
+	const float radius = bodies.radius[circle];
+
+	const uint32_t column = Region(local.x, half.x);
+	const uint32_t row = Region(local.y, half.y);
+
+	if (column != 1 || row != 1)
+	{
+		// Center outside the box, the closest point is on a face or a corner
+		const glm::vec2 closest = glm::vec2(std::fmax(-half.x, std::fmin(local.x, half.x)), std::fmax(-half.y, std::fmin(local.y, half.y)));
+		const glm::vec2 delta = local - closest;
+		const float distance = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+		const float separation = distance - radius;
+
+		if (separation > margin)
+		{
+			return false;
+		}
+
+		manifold.normal = delta / distance;
+		manifold.points[0].separation = separation;
+		manifold.points[0].featureId = row * 3 + column;
+	}
+	else
+	{
+		// Center inside the box, push it out through the closest face
+		const float depth_x = half.x - std::abs(local.x);
+		const float depth_y = half.y - std::abs(local.y);
+
+		if (depth_x < depth_y)
+		{
+			manifold.normal = glm::vec2(Sign(local.x), 0);
+			manifold.points[0].separation = -(depth_x + radius);
+			manifold.points[0].featureId = (local.x < 0.0f) ? 3 : 5;
+		}
+		else
+		{
+			manifold.normal = glm::vec2(0, Sign(local.y));
+			manifold.points[0].separation = -(depth_y + radius);
+			manifold.points[0].featureId = (local.y < 0.0f) ? 1 : 7;
+		}
+	}
+
+	manifold.pointCount = 1;
+	return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef __NARROWPHASE__
+#define __NARROWPHASE__
+#include <array>
+#include <utility>
+#include "BodyStore.h"
+#include "ContactManifold.h"
+#include "ConvexShape.h"
+
+/*
+ * Contact generation for the shapes the engine simulates. Bodies do not spin, so every pair touches along a
+ * single normal and one point per manifold is enough to stop them. Circles and axis aligned boxes have
+ * their own routines, every other pair goes through GJK for the distance between the shapes and EPA for
+ * the depth once they overlap. Contacts up to margin apart are kept so the solver can stop bodies before
+ * they overlap.
+ *
+ * The routine for each pair of shapes is picked at compile time, Collide only looks it up in a table
+ * indexed by the two shapes
+ */
+class Narrowphase
+{
+public:
+	// Fills the normal and points of the manifold for bodies a and b, returns false if they are too far apart
+	static bool Collide(const BodyStore& bodies, int a, int b, float margin, ContactManifold& manifold);
+
+	// Any two convex shapes at the given positions. Starts from the simplex in manifold.simplexCache and
+	// leaves the final one there
+	static bool CollideConvex(const ConvexShape& shape_a, glm::vec2 position_a, const ConvexShape& shape_b,
+		glm::vec2 position_b, float margin, ContactManifold& manifold);
+
+private:
+	using CollideFunction = bool (*)(const BodyStore& bodies, int a, int b, float margin, ContactManifold& manifold);
+
+	static constexpr size_t SHAPE_COUNT = static_cast<size_t>(CollisionShape::NUM_OF_TYPES);
+
+	template <CollisionShape ShapeA, CollisionShape ShapeB>
+	static bool CollidePair(const BodyStore& bodies, int a, int b, float margin, ContactManifold& manifold);
+
+	// One CollidePair per shape pair, row shape A and column shape B
+	template <size_t... Pairs>
+	static constexpr std::array<CollideFunction, sizeof...(Pairs)> MakeDispatchTable(std::index_sequence<Pairs...>);
+
+	static bool CollideCircles(const BodyStore& bodies, int a, int b, float margin, ContactManifold& manifold);
+	static bool CollideBoxes(const BodyStore& bodies, int a, int b, float margin, ContactManifold& manifold);
+
+	// Normal points from the box to the circle
+	static bool CollideBoxCircle(const BodyStore& bodies, int box, int circle, float margin, ContactManifold& manifold);
+};
+
+#endif /* defined (__NARROWPHASE__) */
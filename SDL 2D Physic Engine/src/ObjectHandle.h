@@ -0,0 +1,35 @@
+#pragma once
+#ifndef __OBJECT_HANDLE__
+#define __OBJECT_HANDLE__
+#include <cstdint>
+
+/*
+ * Stable reference to an object in an ObjectPool<T>. Works like BodyHandle: the generation is bumped every
+ * time the slot is freed, so a handle kept past the object's despawn resolves to nullptr instead of to
+ * whatever was spawned into the slot next
+ */
+template <typename T>
+struct ObjectHandle
+{
+	static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFF;
+
+	uint32_t slot = INVALID_SLOT;
+	uint32_t generation = 0;
+
+	[[nodiscard]] bool IsValid() const
+	{
+		return slot != INVALID_SLOT;
+	}
+
+	bool operator==(const ObjectHandle& other) const
+	{
+		return slot == other.slot && generation == other.generation;
+	}
+
+	bool operator!=(const ObjectHandle& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+#endif /* defined (__OBJECT_HANDLE__) */
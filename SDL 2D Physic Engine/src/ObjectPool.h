@@ -0,0 +1,168 @@
+#pragma once
+#ifndef __OBJECT_POOL__
+#define __OBJECT_POOL__
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "DisplayObject.h"
+#include "ObjectHandle.h"
+
+// What Scene::RemoveChild hands a pooled child back to instead of deleting it
+class DisplayObjectPool
+{
+public:
+	virtual ~DisplayObjectPool() = default;
+	virtual void Release(DisplayObject* object) = 0;
+};
+
+/*
+ * Fixed size slots for one type of display object, allocated CHUNK_SIZE at a time and never moved, so
+ * pointers stay good while the object lives. Spawning takes a free slot and despawning runs the destructor
+ * and frees it again, neither touches the heap once enough slots are reserved.
+ *
+ * Objects are added to a Scene like any other. The scene gives them back here when they are removed, and
+ * handles taken before that stop resolving
+ */
+template <typename T>
+class ObjectPool final : public DisplayObjectPool
+{
+	static_assert(std::is_base_of_v<DisplayObject, T>, "ObjectPool only holds display objects");
+
+public:
+	static constexpr uint32_t CHUNK_SIZE = 256;
+
+	ObjectPool() = default;
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	// Objects still alive are destroyed, take them out of their scene first
+	~ObjectPool() override
+	{
+		Clear();
+	}
+
+	// Allocates slots for count objects in all
+	void Reserve(const int count)
+	{
+		while (GetCapacity() < count)
+		{
+			AddChunk();
+		}
+	}
+
+	template <typename... Args>
+	ObjectHandle<T> Create(Args&&... args)
+	{
+		if (m_freeSlots.empty())
+		{
+			AddChunk();
+		}
+
+		const uint32_t slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+
+		Slot& entry = GetSlot(slot);
+		T* object = new (entry.storage) T(std::forward<Args>(args)...);
+		object->m_pPool = this;
+		object->m_poolSlot = slot;
+		entry.alive = true;
+		m_count++;
+
+		return { slot, entry.generation };
+	}
+
+	// nullptr once the object is despawned
+	[[nodiscard]] T* Get(const ObjectHandle<T> handle) const
+	{
+		if (handle.slot >= static_cast<uint32_t>(GetCapacity()))
+		{
+			return nullptr;
+		}
+
+		Slot& entry = GetSlot(handle.slot);
+		return (entry.alive && entry.generation == handle.generation) ? GetObject(entry) : nullptr;
+	}
+
+	[[nodiscard]] ObjectHandle<T> GetHandle(const T* object) const
+	{
+		return { object->m_poolSlot, GetSlot(object->m_poolSlot).generation };
+	}
+
+	void Destroy(const ObjectHandle<T> handle)
+	{
+		if (Get(handle) == nullptr)
+		{
+			return;
+		}
+
+		Slot& entry = GetSlot(handle.slot);
+		GetObject(entry)->~T();
+		entry.alive = false;
+		entry.generation++;
+		m_freeSlots.push_back(handle.slot);
+		m_count--;
+	}
+
+	void Release(DisplayObject* object) override
+	{
+		Destroy(GetHandle(static_cast<T*>(object)));
+	}
+
+	// Destroys every object, the slots stay allocated
+	void Clear()
+	{
+		for (uint32_t slot = 0; slot < static_cast<uint32_t>(GetCapacity()) && m_count > 0; slot++)
+		{
+			Destroy({ slot, GetSlot(slot).generation });
+		}
+	}
+
+	[[nodiscard]] int GetCount() const
+	{
+		return m_count;
+	}
+
+	[[nodiscard]] int GetCapacity() const
+	{
+		return static_cast<int>(m_chunks.size() * CHUNK_SIZE);
+	}
+
+private:
+	struct Slot
+	{
+		alignas(T) unsigned char storage[sizeof(T)];
+		uint32_t generation = 0;
+		bool alive = false;
+	};
+
+	[[nodiscard]] Slot& GetSlot(const uint32_t slot) const
+	{
+		return m_chunks[slot / CHUNK_SIZE][slot % CHUNK_SIZE];
+	}
+
+	static T* GetObject(Slot& entry)
+	{
+		return std::launder(reinterpret_cast<T*>(entry.storage));
+	}
+
+	// The new slots go under the ones already free with the lowest on top, so a fresh pool fills up from slot 0
+	void AddChunk()
+	{
+		const uint32_t first = static_cast<uint32_t>(GetCapacity());
+		m_chunks.push_back(std::make_unique<Slot[]>(CHUNK_SIZE));
+		m_freeSlots.reserve(GetCapacity());
+		m_freeSlots.insert(m_freeSlots.begin(), CHUNK_SIZE, 0);
+		for (uint32_t i = 0; i < CHUNK_SIZE; i++)
+		{
+			m_freeSlots[i] = first + CHUNK_SIZE - 1 - i;
+		}
+	}
+
+	std::vector<std::unique_ptr<Slot[]>> m_chunks;
+	std::vector<uint32_t> m_freeSlots;
+	int m_count = 0;
+};
+
+#endif /* defined (__OBJECT_POOL__) */
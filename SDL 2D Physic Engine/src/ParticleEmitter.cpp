@@ -0,0 +1,153 @@
+#include "ParticleEmitter.h"
+#include "TextureManager.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr float DEGREES_TO_RADIANS = 3.14159265358979f / 180.0f;
+
+	// Corners of a quad in drawing order, as multiples of the half size
+	constexpr float CORNERS[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+}
+
+ParticleEmitter::ParticleEmitter(const int capacity)
+	: m_pool(capacity)
+{
+	const int count = m_pool.GetCapacity();
+	m_positions.resize(count * 8);
+	m_colours.resize(count * 4);
+	m_textureCoordinates.resize(count * 8);
+	m_indices.resize(count * 6);
+
+	for (int i = 0; i < count; i++)
+	{
+		for (int corner = 0; corner < 4; corner++)
+		{
+			m_textureCoordinates[i * 8 + corner * 2] = (CORNERS[corner][0] + 1.0f) * 0.5f;
+			m_textureCoordinates[i * 8 + corner * 2 + 1] = (CORNERS[corner][1] + 1.0f) * 0.5f;
+		}
+
+		// Two triangles per quad
+		const int first = i * 4;
+		const int quad[6] = { first, first + 1, first + 2, first, first + 2, first + 3 };
+		std::copy(quad, quad + 6, m_indices.begin() + i * 6);
+	}
+}
+
+void ParticleEmitter::SetSettings(const Settings& settings)
+{
+	m_settings = settings;
+}
+
+const ParticleEmitter::Settings& ParticleEmitter::GetSettings() const
+{
+	return m_settings;
+}
+
+int ParticleEmitter::Burst(const glm::vec2 position, const int count, const glm::vec2 velocity)
+{
+	const float length = std::sqrt(m_settings.direction.x * m_settings.direction.x + m_settings.direction.y * m_settings.direction.y);
+	const float heading = (length > 0.0f) ? std::atan2(m_settings.direction.y, m_settings.direction.x) : 0.0f;
+	const float half_spread = m_settings.spread * 0.5f * DEGREES_TO_RADIANS;
+
+	int spawned = 0;
+	for (; spawned < count; spawned++)
+	{
+		const float angle = heading + Random(-half_spread, half_spread);
+		const float speed = Random(m_settings.minSpeed, m_settings.maxSpeed);
+		const glm::vec2 particle_velocity = velocity + glm::vec2(std::cos(angle), std::sin(angle)) * speed;
+
+		if (!m_pool.Spawn(position, particle_velocity, Random(m_settings.minLifetime, m_settings.maxLifetime),
+			Random(m_settings.minSize, m_settings.maxSize)))
+		{
+			break;
+		}
+	}
+
+	return spawned;
+}
+
+void ParticleEmitter::Update(const float delta_time)
+{
+	if (m_pool.GetCount() == 0)
+	{
+		return;
+	}
+
+	const float drag = std::pow(m_settings.drag, delta_time);
+	m_pool.Update(m_updateType, m_settings.gravity, drag, m_settings.growth, delta_time);
+}
+
+void ParticleEmitter::Draw(SDL_Renderer* renderer)
+{
+	const int count = m_pool.GetCount();
+	if (count == 0)
+	{
+		return;
+	}
+
+	SDL_Texture* texture = m_settings.textureId.empty() ? nullptr : TextureManager::Instance().GetTexture(m_settings.textureId);
+	const Uint8 red = static_cast<Uint8>(m_settings.colour.r * 255.0f);
+	const Uint8 green = static_cast<Uint8>(m_settings.colour.g * 255.0f);
+	const Uint8 blue = static_cast<Uint8>(m_settings.colour.b * 255.0f);
+	const float alpha_scale = m_settings.colour.a * 255.0f;
+
+	const float* position_x = m_pool.positionX.data();
+	const float* position_y = m_pool.positionY.data();
+	const float* size = m_pool.size.data();
+	const float* alpha = m_pool.alpha.data();
+
+	for (int i = 0; i < count; i++)
+	{
+		const float half_size = size[i] * 0.5f;
+		float* corners = &m_positions[i * 8];
+		for (int corner = 0; corner < 4; corner++)
+		{
+			corners[corner * 2] = position_x[i] + CORNERS[corner][0] * half_size;
+			corners[corner * 2 + 1] = position_y[i] + CORNERS[corner][1] * half_size;
+		}
+
+		const SDL_Color colour = { red, green, blue, static_cast<Uint8>(alpha[i] * alpha_scale) };
+		std::fill_n(&m_colours[i * 4], 4, colour);
+	}
+
+	SDL_RenderGeometryRaw(renderer, texture, m_positions.data(), 2 * sizeof(float), m_colours.data(), sizeof(SDL_Color),
+		m_textureCoordinates.data(), 2 * sizeof(float), count * 4, m_indices.data(), count * 6, sizeof(int));
+}
+
+void ParticleEmitter::Clear()
+{
+	m_pool.Clear();
+}
+
+void ParticleEmitter::SetUpdateType(const IntegratorType type)
+{
+	m_updateType = type;
+}
+
+IntegratorType ParticleEmitter::GetUpdateType() const
+{
+	return m_updateType;
+}
+
+int ParticleEmitter::GetCount() const
+{
+	return m_pool.GetCount();
+}
+
+const ParticlePool& ParticleEmitter::GetPool() const
+{
+	return m_pool;
+}
+
+float ParticleEmitter::Random(const float min, const float max)
+{
+	m_randomState ^= m_randomState << 13;
+	m_randomState ^= m_randomState >> 17;
+	m_randomState ^= m_randomState << 5;
+
+	// Top 24 bits, exactly representable as a float in [0, 1)
+	const float unit = static_cast<float>(m_randomState >> 8) * (1.0f / 16777216.0f);
+	return min + (max - min) * unit;
+}
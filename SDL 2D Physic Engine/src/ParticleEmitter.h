@@ -0,0 +1,85 @@
+#pragma once
+#ifndef __PARTICLE_EMITTER__
+#define __PARTICLE_EMITTER__
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include "Integrator.h"
+#include "ParticlePool.h"
+#include "Renderer.h"
+
+/*
+ * Bursts of textured particles sharing one look, debris chips or smoke puffs. Every particle of the emitter
+ * is one textured quad of the same SDL_RenderGeometryRaw call, faded by its alpha and tinted by the colour.
+ * The vertex buffers are sized for the whole pool up front, texture coordinates and indices never change
+ * and are filled once
+ */
+class ParticleEmitter
+{
+public:
+	static constexpr int DEFAULT_CAPACITY = 65536;
+
+	struct Settings
+	{
+		// Texture in the TextureManager, none draws plain squares
+		std::string textureId;
+		glm::vec4 colour = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+
+		// Particles leave within spread degrees around direction, 360 is every way
+		glm::vec2 direction = glm::vec2(0.0f, -1.0f);
+		float spread = 360.0f;
+		float minSpeed = 50.0f;
+		float maxSpeed = 200.0f;
+
+		float minLifetime = 0.5f;
+		float maxLifetime = 1.0f;
+		float minSize = 4.0f;
+		float maxSize = 8.0f;
+
+		// Pixels per second squared, down the screen is +y
+		glm::vec2 gravity = glm::vec2(0.0f, 0.0f);
+
+		// Part of the velocity left after a second
+		float drag = 1.0f;
+
+		// Pixels per second the size changes by
+		float growth = 0.0f;
+	};
+
+	explicit ParticleEmitter(int capacity = DEFAULT_CAPACITY);
+
+	void SetSettings(const Settings& settings);
+	[[nodiscard]] const Settings& GetSettings() const;
+
+	// Spawns count particles around position moving with velocity on top of their own, returns how many fit
+	int Burst(glm::vec2 position, int count, glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
+	void Update(float delta_time);
+	void Draw(SDL_Renderer* renderer = Renderer::Instance().GetRenderer());
+	void Clear();
+
+	// Defaults to the widest kernel the CPU supports, like the physics
+	void SetUpdateType(IntegratorType type);
+	[[nodiscard]] IntegratorType GetUpdateType() const;
+
+	[[nodiscard]] int GetCount() const;
+	[[nodiscard]] const ParticlePool& GetPool() const;
+
+private:
+	// xorshift, bursts of thousands of particles are too many for rand
+	float Random(float min, float max);
+
+	ParticlePool m_pool;
+	Settings m_settings;
+	IntegratorType m_updateType = Integrator::GetBestType();
+	uint32_t m_randomState = 0x9E3779B9u;
+
+	// Four corners per particle
+	std::vector<float> m_positions;
+	std::vector<SDL_Color> m_colours;
+	std::vector<float> m_textureCoordinates;
+	std::vector<int> m_indices;
+};
+
+#endif /* defined (__PARTICLE_EMITTER__) */
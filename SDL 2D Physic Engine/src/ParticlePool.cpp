@@ -0,0 +1,190 @@
+#include "ParticlePool.h"
+#include "Integrator.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PARTICLE_X86
+#include <immintrin.h>
+#endif
+
+// Same as the Integrator, GCC and Clang only emit AVX inside functions marked for it
+#if defined(PARTICLE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PARTICLE_TARGET_AVX __attribute__((target("avx")))
+#else
+#define PARTICLE_TARGET_AVX
+#endif
+
+ParticlePool::ParticlePool(const int capacity)
+	: m_capacity(std::max(0, capacity))
+{
+	for (auto* column : { &positionX, &positionY, &velocityX, &velocityY, &age, &inverseLifetime, &size, &alpha })
+	{
+		column->resize(m_capacity, 0.0f);
+	}
+}
+
+bool ParticlePool::Spawn(const glm::vec2 position, const glm::vec2 velocity, const float lifetime, const float particle_size)
+{
+	if (m_count == m_capacity || lifetime <= 0.0f)
+	{
+		return false;
+	}
+
+	const int i = m_count++;
+	positionX[i] = position.x;
+	positionY[i] = position.y;
+	velocityX[i] = velocity.x;
+	velocityY[i] = velocity.y;
+	age[i] = 0.0f;
+	inverseLifetime[i] = 1.0f / lifetime;
+	size[i] = particle_size;
+	alpha[i] = 1.0f;
+	return true;
+}
+
+void ParticlePool::Kill(const int index)
+{
+	const int last = --m_count;
+	positionX[index] = positionX[last];
+	positionY[index] = positionY[last];
+	velocityX[index] = velocityX[last];
+	velocityY[index] = velocityY[last];
+	age[index] = age[last];
+	inverseLifetime[index] = inverseLifetime[last];
+	size[index] = size[last];
+	alpha[index] = alpha[last];
+}
+
+void ParticlePool::Clear()
+{
+	m_count = 0;
+}
+
+void ParticlePool::Update(const IntegratorType type, const glm::vec2 gravity, const float drag, const float growth, const float delta_time)
+{
+	const Step step = { gravity.x, gravity.y, drag, growth, delta_time };
+	int first = 0;
+
+	switch (type)
+	{
+	case IntegratorType::AVX:
+		if (Integrator::IsSupported(IntegratorType::AVX))
+		{
+			first = UpdateAVX(step);
+		}
+		break;
+	case IntegratorType::SSE:
+		if (Integrator::IsSupported(IntegratorType::SSE))
+		{
+			first = UpdateSSE(step);
+		}
+		break;
+	default:
+		break;
+	}
+
+	UpdateScalar(first, step);
+
+	// The particle moved into a dead one's slot has not been checked yet, so the index stays
+	for (int i = 0; i < m_count;)
+	{
+		if (alpha[i] <= 0.0f)
+		{
+			Kill(i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+int ParticlePool::GetCount() const
+{
+	return m_count;
+}
+
+int ParticlePool::GetCapacity() const
+{
+	return m_capacity;
+}
+
+void ParticlePool::UpdateScalar(const int first, const Step& step)
+{
+	for (int i = first; i < m_count; i++)
+	{
+		velocityX[i] = velocityX[i] * step.drag + step.gravityX * step.deltaTime;
+		velocityY[i] = velocityY[i] * step.drag + step.gravityY * step.deltaTime;
+		positionX[i] += velocityX[i] * step.deltaTime;
+		positionY[i] += velocityY[i] * step.deltaTime;
+		age[i] += step.deltaTime;
+		size[i] = std::max(0.0f, size[i] + step.growth * step.deltaTime);
+		alpha[i] = std::max(0.0f, 1.0f - age[i] * inverseLifetime[i]);
+	}
+}
+
+int ParticlePool::UpdateSSE(const Step& step)
+{
+#if defined(PARTICLE_X86)
+	const __m128 drag = _mm_set1_ps(step.drag);
+	const __m128 dt = _mm_set1_ps(step.deltaTime);
+	const __m128 pull_x = _mm_set1_ps(step.gravityX * step.deltaTime);
+	const __m128 pull_y = _mm_set1_ps(step.gravityY * step.deltaTime);
+	const __m128 grow = _mm_set1_ps(step.growth * step.deltaTime);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	int i = 0;
+	for (; i + 4 <= m_count; i += 4)
+	{
+		const __m128 velocity_x = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&velocityX[i]), drag), pull_x);
+		const __m128 velocity_y = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&velocityY[i]), drag), pull_y);
+		const __m128 particle_age = _mm_add_ps(_mm_loadu_ps(&age[i]), dt);
+
+		_mm_storeu_ps(&velocityX[i], velocity_x);
+		_mm_storeu_ps(&velocityY[i], velocity_y);
+		_mm_storeu_ps(&positionX[i], _mm_add_ps(_mm_loadu_ps(&positionX[i]), _mm_mul_ps(velocity_x, dt)));
+		_mm_storeu_ps(&positionY[i], _mm_add_ps(_mm_loadu_ps(&positionY[i]), _mm_mul_ps(velocity_y, dt)));
+		_mm_storeu_ps(&age[i], particle_age);
+		_mm_storeu_ps(&size[i], _mm_max_ps(zero, _mm_add_ps(_mm_loadu_ps(&size[i]), grow)));
+		_mm_storeu_ps(&alpha[i], _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(particle_age, _mm_loadu_ps(&inverseLifetime[i])))));
+	}
+
+	return i;
+#else
+	return 0;
+#endif
+}
+
+PARTICLE_TARGET_AVX int ParticlePool::UpdateAVX(const Step& step)
+{
+#if defined(PARTICLE_X86)
+	const __m256 drag = _mm256_set1_ps(step.drag);
+	const __m256 dt = _mm256_set1_ps(step.deltaTime);
+	const __m256 pull_x = _mm256_set1_ps(step.gravityX * step.deltaTime);
+	const __m256 pull_y = _mm256_set1_ps(step.gravityY * step.deltaTime);
+	const __m256 grow = _mm256_set1_ps(step.growth * step.deltaTime);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	int i = 0;
+	for (; i + 8 <= m_count; i += 8)
+	{
+		const __m256 velocity_x = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&velocityX[i]), drag), pull_x);
+		const __m256 velocity_y = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&velocityY[i]), drag), pull_y);
+		const __m256 particle_age = _mm256_add_ps(_mm256_loadu_ps(&age[i]), dt);
+
+		_mm256_storeu_ps(&velocityX[i], velocity_x);
+		_mm256_storeu_ps(&velocityY[i], velocity_y);
+		_mm256_storeu_ps(&positionX[i], _mm256_add_ps(_mm256_loadu_ps(&positionX[i]), _mm256_mul_ps(velocity_x, dt)));
+		_mm256_storeu_ps(&positionY[i], _mm256_add_ps(_mm256_loadu_ps(&positionY[i]), _mm256_mul_ps(velocity_y, dt)));
+		_mm256_storeu_ps(&age[i], particle_age);
+		_mm256_storeu_ps(&size[i], _mm256_max_ps(zero, _mm256_add_ps(_mm256_loadu_ps(&size[i]), grow)));
+		_mm256_storeu_ps(&alpha[i], _mm256_max_ps(zero, _mm256_sub_ps(one, _mm256_mul_ps(particle_age, _mm256_loadu_ps(&inverseLifetime[i])))));
+	}
+
+	return i;
+#else
+	return 0;
+#endif
+}
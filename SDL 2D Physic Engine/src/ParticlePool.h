@@ -0,0 +1,63 @@
+#pragma once
+#ifndef __PARTICLE_POOL__
+#define __PARTICLE_POOL__
+#include <vector>
+#include <glm/vec2.hpp>
+#include "IntegratorType.h"
+
+/*
+ * A fixed number of particles kept as columns, the live ones packed at the front. Killing a particle moves the
+ * last live one into its place, so the free slots are always the tail, spawning is a store at GetCount() and
+ * nothing is allocated after construction.
+ *
+ * Update runs 4 or 8 particles at a time with the same kernel widths as the Integrator. The columns are packed,
+ * so unlike the bodies no lane is ever masked out
+ */
+class ParticlePool
+{
+public:
+	explicit ParticlePool(int capacity);
+
+	// False once the pool is full, a burst is cut short rather than growing the pool
+	bool Spawn(glm::vec2 position, glm::vec2 velocity, float lifetime, float particle_size);
+	void Kill(int index);
+	void Clear();
+
+	// Velocities are scaled by drag and pulled by gravity, then positions, ages, sizes and alphas move on
+	// and the particles past their lifetime are killed
+	void Update(IntegratorType type, glm::vec2 gravity, float drag, float growth, float delta_time);
+
+	[[nodiscard]] int GetCount() const;
+	[[nodiscard]] int GetCapacity() const;
+
+	// GetCapacity() long, only the first GetCount() are live. Alpha goes from 1 at spawn to 0 at the end of the lifetime
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> age;
+	std::vector<float> inverseLifetime;
+	std::vector<float> size;
+	std::vector<float> alpha;
+
+private:
+	struct Step
+	{
+		float gravityX;
+		float gravityY;
+		float drag;
+		float growth;
+		float deltaTime;
+	};
+
+	void UpdateScalar(int first, const Step& step);
+
+	// Return the index of the first particle left for the scalar tail
+	int UpdateSSE(const Step& step);
+	int UpdateAVX(const Step& step);
+
+	int m_count = 0;
+	int m_capacity;
+};
+
+#endif /* defined (__PARTICLE_POOL__) */
@@ -1,122 +1,151 @@
 #include "PhysicsEngine.h"
-#include "GameObject.h"
-#include "Bird.h"
-#include "Util.h"
-#include "PlayScene.h"
+#include "AllPairsBroadphase.h"
+#include "SpatialHashBroadphase.h"
+#include "DynamicTreeBroadphase.h"
+#include "SweepAndPruneBroadphase.h"
+#include "Narrowphase.h"
+#include "TimeOfImpact.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	float Dot(const glm::vec2 lhs, const glm::vec2 rhs)
+	{
+		return lhs.x * rhs.x + lhs.y * rhs.y;
+	}
+}
 
-double calcTime(clock_t clock1, clock_t clock2)
+PhysicsEngine::PhysicsEngine()
 {
-	double ticks = clock1 - clock2;	// Difference between 2 separate clock ticks.
-	double ticksToMS = (ticks * 10) / CLOCKS_PER_SEC;
-	double msToSec = ticksToMS / 10;
-	return msToSec;
+	broadphase = CreateBroadphase(BroadphaseType::SPATIAL_HASH, broadphaseCellSize);
+	staticTree.SetMargin(0.0f);
+	contactEvents.reserve(CONTACT_EVENT_CAPACITY);
+	dispatchedContactEvents.reserve(CONTACT_EVENT_CAPACITY);
 }
 
-void PhysicsEngine::UpdatePhysics()
+void PhysicsEngine::Step(float frame_delta_time)
 {
-	for (auto it = physicsObjects.begin(); it != physicsObjects.end(); it++)
+	accumulator += std::min(frame_delta_time, MAX_FRAME_TIME);
+
+	stepsLastFrame = 0;
+	while (accumulator >= fixedDeltaTime)
 	{
-		if (onSlingshot == false)
+		if (stepsLastFrame == maxStepsPerFrame)
 		{
-			// Reference iterator to get element
-			RigidBody* rb = (*it);
-
-			if (rb->enableGravity)
-			{
-				// Apply Friction to velocity
-				rb->velocity *= airFriction;
-
-				// Apply gravity force
-				glm::vec2 fGravity = gravity * rb->gravityScale * rb->mass;
-
-				rb->netForce += fGravity;
-				glm::vec2 acceleration = rb->netForce / rb->mass;
-
-				// Apply gravity acceleretation to velocity
-				rb->velocity += acceleration * fixedDeltaTime;
-
-				// Apply velocity to the position
-				rb->gameObject->GetTransform()->position += rb->velocity * fixedDeltaTime;
-				rb->netForce = glm::vec2(0, 0);
-			}
+			// Spiral of death, give up on the whole steps that are left and keep the fraction
+			droppedSteps += static_cast<int>(accumulator / fixedDeltaTime);
+			accumulator = std::fmod(accumulator, fixedDeltaTime);
+			break;
 		}
+
+		bodies.SavePreviousPositions();
+		Simulate(fixedDeltaTime);
+		accumulator -= fixedDeltaTime;
+		stepsLastFrame++;
 	}
+
+	interpolationAlpha = accumulator / fixedDeltaTime;
+	bodies.SyncTransforms(interpolationAlpha);
+	DispatchContactEvents();
 }
 
-void PhysicsEngine::ObjectHalfPlaneCollision(HalfPlane* halfplane)
+void PhysicsEngine::UpdatePhysics()
 {
-	for (auto it = physicsObjects.begin(); it != physicsObjects.end(); it++)
-	{
-		RigidBody* rb = (*it);
-
-		glm::vec2 vectorObject = { rb->gameObject->GetTransform()->position.x - halfplane->GetTransform()->position.x,
-			rb->gameObject->GetTransform()->position.y - halfplane->GetTransform()->position.y };
+	bodies.SavePreviousPositions();
+	Simulate(fixedDeltaTime);
+	bodies.SyncTransforms(1.0f);
+	DispatchContactEvents();
+}
 
-		float dotProduct = (vectorObject.x * halfplane->GetNormal().x) + (vectorObject.y * halfplane->GetNormal().y);
+void PhysicsEngine::Simulate(float delta_time)
+{
+	const float substep_delta_time = delta_time / static_cast<float>(substeps);
+	timeOfImpactCount = 0;
 
-		glm::vec2 vectorProjection = { (dotProduct - rb->radius) * (halfplane->GetNormal().x), 
-			(dotProduct - rb->radius) * (halfplane->GetNormal().y) };
+	// Keep the damping per second the same however the step is cut
+	const float substep_friction = std::pow(airFriction, substep_delta_time / FRICTION_DELTA_TIME);
 
+	PHYSICS_PROFILE_BEGIN_STEP(profiler);
 
-		if (dotProduct < rb->radius)
+	for (int i = 0; i < substeps; i++)
+	{
 		{
-			rb->gameObject->GetTransform()->position += -vectorProjection;
-
-			/********* Lab 9 *******/
-
-			glm::vec2 fGravity = gravity * rb->gravityScale * rb->mass;
-			float gravityDotNormal = Util::Dot(fGravity, halfplane->GetNormal());
-			glm::vec2 fGravityPerpendicular = gravityDotNormal * halfplane->GetNormal();
-			glm::vec2 fGravityParalllel = fGravity - fGravityPerpendicular;
-
-			rb->fParallelGravity = fGravityParalllel;
-			rb->fPerpendicularGravity = fGravityPerpendicular;
-			rb->fNormal = -fGravityPerpendicular;
-			float fNormalMagnitud = abs(gravityDotNormal);
-
-			glm::vec2 frictionDirection = -Util::Normalize(fGravityParalllel);
-
-			// Use a coefficient
-			float k_friction = rb->friction;
-
-			// Ensure friction is never greater than parallel gravity component
-			float frictionMagnitud = Util::Min(k_friction * fNormalMagnitud, Util::Magnitude(fGravityParalllel));
-
-			// Friction force vector is dependent on the direction of gravity parallele to the surface 
-			rb->fFriction = k_friction * frictionMagnitud * (frictionDirection);
-
-			// Apply Friction
-			rb->netForce += rb->fFriction;
-
-			// Apply Normal
-			rb->netForce += rb->fNormal;
+			PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::BROADPHASE);
+			UpdateBroadphase();
+		}
+		UpdateContacts();
 
-			/*************************/
+		// The solver sees the velocities the bodies are about to move with, so resting contacts cancel gravity
+		// before it pushes anything into the ground
+		if (onSlingshot == false)
+		{
+			PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::INTEGRATE_VELOCITIES);
+			Integrator::IntegrateVelocities(integratorType, bodies.GetIntegrationBatch(), gravity, substep_friction, substep_delta_time);
+		}
 
-			rb->isColliding = true;
+		{
+			PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::SOLVE_VELOCITIES);
+			const int impulses = solver.SolveVelocities(bodies, manifolds, substep_delta_time);
+			PHYSICS_PROFILE_COUNT(profiler, ProfilerCounter::IMPULSES, impulses);
 		}
-		else
+
+		if (onSlingshot == false)
 		{
-			rb->fParallelGravity = { 0,0 };
-			rb->fPerpendicularGravity = { 0,0 };
-			rb->fNormal = { 0,0 };
-			rb->fFriction = { 0,0 };
+			SaveSweepStarts();
+			{
+				PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::INTEGRATE_POSITIONS);
+				Integrator::IntegratePositions(integratorType, bodies.GetIntegrationBatch(), substep_delta_time);
+			}
+			PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::TIME_OF_IMPACT);
+			SweepFastBodies();
+		}
 
-			
+		{
+			PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::SOLVE_POSITIONS);
+			solver.SolvePositions(bodies, manifolds);
 		}
+		EmitContactEvents(i == substeps - 1);
+
+		PHYSICS_PROFILE_COUNT(profiler, ProfilerCounter::CANDIDATE_PAIRS, static_cast<int>(candidatePairs.size()));
+		PHYSICS_PROFILE_COUNT(profiler, ProfilerCounter::CONTACTS, static_cast<int>(manifolds.size()));
 	}
+
+	{
+		PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::ISLANDS);
+		UpdateIslands();
+	}
+
+	PHYSICS_PROFILE_COUNT(profiler, ProfilerCounter::TIME_OF_IMPACTS, timeOfImpactCount);
+	PHYSICS_PROFILE_END_STEP(profiler);
 }
 
 void PhysicsEngine::SetGravity(float g)
 {
+	// Sleeping bodies rest against the old gravity
+	if (g != gravity)
+	{
+		WakeAll();
+	}
+
 	gravity = g;
 }
 
+float PhysicsEngine::GetGravity() const
+{
+	return gravity;
+}
+
 void PhysicsEngine::SetFriction(float f)
 {
 	airFriction = f;
 }
 
+float PhysicsEngine::GetFriction() const
+{
+	return airFriction;
+}
+
 void PhysicsEngine::SetOnSlingshot(bool on)
 {
 	onSlingshot = on;
@@ -127,337 +156,1524 @@ bool PhysicsEngine::GetOnSlingshot()
 	return onSlingshot;
 }
 
-void PhysicsEngine::AddCircleObject(RigidBody* circle)
+int PhysicsEngine::AddStaticPlane(glm::vec2 point, glm::vec2 normal, float friction, float restitution)
 {
-	physicsObjects.push_back(circle);
-	circles.push_back(circle);
+	return staticGeometry.AddPlane(point, normal, friction, restitution);
 }
 
-void PhysicsEngine::AddRectangleObject(RigidBody* rectangle)
+int PhysicsEngine::AddStaticSegment(glm::vec2 start, glm::vec2 end, float friction, float restitution)
 {
-	physicsObjects.push_back(rectangle);
-	rectangles.push_back(rectangle);
+	return staticGeometry.AddSegment(start, end, friction, restitution);
 }
 
+void PhysicsEngine::RemoveStaticShape(int id)
+{
+	if (id < 0 || id >= staticGeometry.GetCapacity() || staticGeometry.IsRemoved(id))
+	{
+		return;
+	}
 
-void PhysicsEngine::RemoveCircleObject(RigidBody* object)
+	// Bodies resting on the shape fall, and a shape added later can get the same id
+	const int proxy = StaticGeometry::PROXY_BASE + id;
+	manifolds.erase(std::remove_if(manifolds.begin(), manifolds.end(), [this, proxy](const ContactManifold& manifold)
+	{
+		if (manifold.proxyB != proxy)
+		{
+			return false;
+		}
+
+		bodies.Wake(manifold.bodyA);
+		if (manifold.touching)
+		{
+			PushContactEvent(ContactEventType::END, manifold);
+		}
+		return true;
+	}), manifolds.end());
+
+	staticGeometry.Remove(id);
+}
+
+const StaticGeometry& PhysicsEngine::GetStaticGeometry() const
 {
-	physicsObjects.remove(object);
-	circles.remove(object);
+	return staticGeometry;
 }
 
-void PhysicsEngine::RemoveObject(RigidBody* object)
+void PhysicsEngine::SetStaticPlane(int id, glm::vec2 point, glm::vec2 normal)
 {
-	physicsObjects.remove(object);
+	staticGeometry.SetPlane(id, point, normal);
 }
 
-void PhysicsEngine::CircleCircleCollision()
+void PhysicsEngine::AddCircleObject(RigidBody* circle)
 {
-	for (auto it = circles.begin(); it != circles.end(); it++)
-	{
-		auto it2 = it;
-		it2++;
-		for (; it2 != circles.end(); it2++)
-		{
-			// Deference iterator to get the element
-			RigidBody* rb = (*it);
-			RigidBody* rb2 = (*it2);
+	AddBody(circle, CollisionShape::CIRCLE);
+}
 
-			//Find the distance between 2 object
-			float m_distance = sqrt(pow(abs(rb->gameObject->GetTransform()->position.x - rb2->gameObject->GetTransform()->position.x), 2) +
-				pow(abs(rb->gameObject->GetTransform()->position.y - rb2->gameObject->GetTransform()->position.y), 2));
+void PhysicsEngine::AddRectangleObject(RigidBody* rectangle)
+{
+	AddBody(rectangle, CollisionShape::RECTANGLE);
+}
 
-			//if distanceBetween < sum of radius then they are overlapping. Print name of who collided?
-			if (m_distance <= (rb->radius + rb2->radius))
-			{
+void PhysicsEngine::AddLineObject(RigidBody* line)
+{
+	AddBody(line, CollisionShape::LINE);
+}
 
-				glm::vec2 displacementBRelativeA = rb2->gameObject->GetTransform()->position - rb->gameObject->GetTransform()->position;
-				float distanceAB = Util::Magnitude(displacementBRelativeA);
+void PhysicsEngine::AddCapsuleObject(RigidBody* capsule)
+{
+	AddBody(capsule, CollisionShape::CAPSULE);
+}
 
-				// check distance between agains radius
+bool PhysicsEngine::AddPolygonObject(RigidBody* polygon, const std::vector<glm::vec2>& corners)
+{
+	ConvexShape hull;
+	if (!ConvexShape::MakeHull(corners, hull))
+	{
+		return false;
+	}
 
-				float overlap = distanceAB - (rb->radius + rb2->radius);
+	AddBody(polygon, CollisionShape::POLYGON, hull);
+	return true;
+}
 
-				if (overlap > 0)
-				{
-					continue;
-				}
+void PhysicsEngine::RemoveCircleObject(RigidBody* object)
+{
+	RemoveObject(object);
+}
 
-				glm::vec2  collisionNormalAtoB = displacementBRelativeA / distanceAB;
-				// get ralative velocity projected along normal
-				glm::vec2 velocityBRelativeA = rb2->velocity - rb->velocity;
+void PhysicsEngine::RemoveObject(RigidBody* object)
+{
+	RemoveBody(object);
+	ForgetOwner(object);
+}
 
-				//ARE THEY MOVING TOWARD OR AWAY FROM EACH OTHER
-				float closingRate = Util::Dot(velocityBRelativeA, collisionNormalAtoB);
+void PhysicsEngine::DisableObject(RigidBody* object)
+{
+	RemoveBody(object);
+}
 
-				//Separate the circles by minium translation vector
-				glm::vec2 minimumTranslationVector = collisionNormalAtoB * overlap;
+void PhysicsEngine::SetIntegratorType(IntegratorType type)
+{
+	integratorType = Integrator::IsSupported(type) ? type : Integrator::GetBestType();
+}
 
-				//Bounce
-				float restitution = Util::Min(rb->restitution, rb2->restitution);
+IntegratorType PhysicsEngine::GetIntegratorType() const
+{
+	return integratorType;
+}
 
-				float totalMass = rb->mass + rb2->mass;
-				float impulse = -(1.0f + restitution) * closingRate * rb->mass * rb2->mass / (totalMass);
+void PhysicsEngine::UpdateBroadphase()
+{
+	const int count = bodies.GetCount();
+	for (int i = 0; i < count; i++)
+	{
+		// Sleeping bodies have not moved since they fell asleep
+		if (bodies.IsAwake(i) && !bodies.IsStatic(i))
+		{
+			broadphase->MoveProxy(bodies.proxyId[i], ComputeAABB(i));
+		}
+	}
 
-				glm::vec2  impulseA = -impulse * collisionNormalAtoB;
-				glm::vec2  impulseB = impulse * collisionNormalAtoB;
+	// Static bodies are never moved above, unless they were put somewhere else
+	for (const BodyHandle handle : bodies.GetTeleported())
+	{
+		const int index = bodies.IsValid(handle) ? bodies.GetIndex(handle) : -1;
+		if (index != -1 && bodies.IsStatic(index))
+		{
+			staticTree.MoveProxy(bodies.proxyId[index] - STATIC_PROXY_BASE, ComputeAABB(index));
+		}
+	}
+	bodies.ClearTeleported();
 
-				//to apply impulse, just divide by mass 
-				glm::vec2 deltaVA = impulseA / rb->mass;
-				glm::vec2 deltaVB = impulseB / rb2->mass;
+	broadphase->UpdatePairs(candidatePairs);
 
-				if (deltaVA.x > deltaVB.x || deltaVA.y > deltaVB.y)
-				{
-					rb->gameObject->GetTransform()->position += minimumTranslationVector;
-				
-				}
-				else if (deltaVB.x > deltaVA.x || deltaVB.y > deltaVA.y)
-				{
-					rb2->gameObject->GetTransform()->position -= minimumTranslationVector;
-				}
+	if (staticTree.GetRoot() == -1)
+	{
+		return;
+	}
 
-				if (closingRate < 0)
-				{
-					//apply changes in velocity to objects
-					rb->velocity += deltaVA;
-					rb2->velocity += deltaVB;
-
-					if (rb->gameObject->GetType() == GameObjectType::PIG && impulse >= rb->toughness)
-					{
-						rb->wasKilled = true;
-					}
-					else if (rb2->gameObject->GetType() == GameObjectType::PIG && impulse >= rb2->toughness)
-					{
-						rb2->wasKilled = true;
-					}
-				}
-			}
+	// Dynamic bodies against the static tree, sleeping ones too so their resting contacts are kept
+	staticPairs.clear();
+	for (int i = 0; i < count; i++)
+	{
+		if (!bodies.enableGravity[i] || bodies.proxyId[i] == -1)
+		{
+			continue;
 		}
+
+		const int proxy_id = bodies.proxyId[i];
+		staticTree.Query(ComputeAABB(i), [this, proxy_id](const int static_proxy)
+		{
+			staticPairs.push_back({ proxy_id, STATIC_PROXY_BASE + static_proxy });
+			return true;
+		});
 	}
+
+	// Every static proxy id is above the broadphase ones, the merged list stays sorted by proxyA then proxyB
+	std::sort(staticPairs.begin(), staticPairs.end());
+	const size_t broadphase_pairs = candidatePairs.size();
+	candidatePairs.insert(candidatePairs.end(), staticPairs.begin(), staticPairs.end());
+	std::inplace_merge(candidatePairs.begin(), candidatePairs.begin() + broadphase_pairs, candidatePairs.end());
 }
 
-void PhysicsEngine::AABBAABBCollision()
+void PhysicsEngine::SetBroadphaseType(BroadphaseType type)
 {
-	for (auto it = rectangles.begin(); it != rectangles.end(); it++)
+	if (type == broadphase->GetType())
 	{
-		auto it2 = it;
-		it2++;
-		for (; it2 != rectangles.end(); it2++)
-		{
-			// Deference iterator to get the element
-			RigidBody* rb = (*it);
-			RigidBody* rb2 = (*it2);
+		return;
+	}
 
-			float minimumTransX = MinimumTranslationVector1D(rb->gameObject->GetTransform()->position.x, rb->gameObject->GetWidth() / 2,
-				rb2->gameObject->GetTransform()->position.x, rb2->gameObject->GetWidth() / 2);
+	broadphase = CreateBroadphase(type, broadphaseCellSize);
+	proxyBodies.clear();
+	candidatePairs.clear();
 
-			float minimumTransY = MinimumTranslationVector1D(rb->gameObject->GetTransform()->position.y, rb->gameObject->GetHeight() / 2,
-				rb2->gameObject->GetTransform()->position.y, rb2->gameObject->GetHeight() / 2);
+	// Manifolds are keyed by proxy ids, which the new broadphase hands out again
+	manifolds.clear();
 
-			if (minimumTransX == 0 && minimumTransY == 0) //
-			{
-				continue;
-			}
-			else if (minimumTransX != 0 && minimumTransY != 0)
-			{
-				glm::vec2 displacementBRelativeA = rb2->gameObject->GetTransform()->position - rb->gameObject->GetTransform()->position;
-				float distanceAB = Util::Magnitude(displacementBRelativeA);
+	// The static tree does not depend on the broadphase and keeps its proxies
+	const int count = bodies.GetCount();
+	for (int i = 0; i < count; i++)
+	{
+		if (!bodies.IsStatic(i))
+		{
+			bodies.proxyId[i] = -1;
+			AddProxy(i);
+		}
+	}
+}
 
-				glm::vec2  collisionNormalAtoB = displacementBRelativeA / distanceAB;
+BroadphaseType PhysicsEngine::GetBroadphaseType() const
+{
+	return broadphase->GetType();
+}
 
-				// get ralative velocity projected along normal
-				glm::vec2 velocityBRelativeA = rb2->velocity - rb->velocity;
+void PhysicsEngine::SetBroadphaseCellSize(float cell_size)
+{
+	broadphaseCellSize = cell_size;
 
-				//ARE THEY MOVING TOWARD OR AWAY FROM EACH OTHER
-				float closingRate = Util::Dot(velocityBRelativeA, collisionNormalAtoB);
+	if (broadphase->GetType() == BroadphaseType::SPATIAL_HASH)
+	{
+		static_cast<SpatialHashBroadphase*>(broadphase.get())->SetCellSize(cell_size);
+	}
+}
 
+std::unique_ptr<Broadphase> PhysicsEngine::CreateBroadphase(BroadphaseType type, float cell_size)
+{
+	switch (type)
+	{
+	case BroadphaseType::ALL_PAIRS:
+		return std::make_unique<AllPairsBroadphase>();
+	case BroadphaseType::DYNAMIC_TREE:
+		return std::make_unique<DynamicTreeBroadphase>();
+	case BroadphaseType::SWEEP_AND_PRUNE:
+		return std::make_unique<SweepAndPruneBroadphase>();
+	case BroadphaseType::SPATIAL_HASH:
+	default:
+		return std::make_unique<SpatialHashBroadphase>(cell_size);
+	}
+}
 
-				//Bounce
-				float restitution = Util::Min(rb2->restitution, rb->restitution);
+void PhysicsEngine::SetFixedDeltaTime(float delta_time)
+{
+	fixedDeltaTime = delta_time;
+}
 
-				float totalMass = rb2->mass + rb->mass;
-				float impulse = -(1.0f + restitution) * closingRate * rb->mass * rb2->mass / (totalMass);
+float PhysicsEngine::GetFixedDeltaTime() const
+{
+	return fixedDeltaTime;
+}
 
-				glm::vec2  impulseA = -impulse * collisionNormalAtoB;
-				glm::vec2  impulseB = impulse * collisionNormalAtoB;
+void PhysicsEngine::SetSubsteps(int new_substeps)
+{
+	substeps = std::max(1, new_substeps);
+}
 
-				//to apply impulse, just divide by mass 
-				glm::vec2 deltaVA = impulseA / rb->mass;
-				glm::vec2 deltaVB = impulseB / rb2->mass;
+int PhysicsEngine::GetSubsteps() const
+{
+	return substeps;
+}
 
+void PhysicsEngine::SetMaxStepsPerFrame(int max_steps)
+{
+	maxStepsPerFrame = std::max(1, max_steps);
+}
 
-				glm::vec2 mtv2D;
+int PhysicsEngine::GetMaxStepsPerFrame() const
+{
+	return maxStepsPerFrame;
+}
 
-				if (abs(minimumTransX) < abs(minimumTransY)) // if the amount we would need to move them by the smaller in the x direction
-				{
-					// move along x because it's less effort (minimum translation)
-					mtv2D = glm::vec2(minimumTransX, 0);
-
-					if (deltaVA.x > deltaVB.x || deltaVA.y > deltaVB.y)
-					{
-						if (rb->gameObject->GetType() != GameObjectType::OBSTACLE)
-						{
-							rb->gameObject->GetTransform()->position += mtv2D.y;
-						}
-						else
-						{
-							rb2->gameObject->GetTransform()->position += mtv2D.y;
-
-						}
-
-					}
-					else if (deltaVB.x > deltaVA.x || deltaVB.y > deltaVA.y)
-					{
-
-						if (rb2->gameObject->GetType() != GameObjectType::OBSTACLE)
-						{
-							rb2->gameObject->GetTransform()->position += mtv2D.x;
-						}
-						else
-						{
-							rb->gameObject->GetTransform()->position += mtv2D.x;
-						}
-					}
-				}
-				else
-				{
-					// move along y
-					mtv2D = glm::vec2(0, minimumTransY);
-
-					if (rb->gameObject->GetTransform()->position.y < rb2->gameObject->GetTransform()->position.y)
-					{
-						rb->gameObject->GetTransform()->position.y += mtv2D.y;
-					}
-					else
-					{
-						rb2->gameObject->GetTransform()->position.y -= mtv2D.y;
-					}
-				}
+int PhysicsEngine::GetStepsLastFrame() const
+{
+	return stepsLastFrame;
+}
 
-				if (closingRate < 0)
-				{
-					//apply changes in velocity to objects
-					rb->velocity += deltaVA;
-					rb2->velocity += deltaVB;
-				}
-			}
-		}
-	}
+int PhysicsEngine::GetDroppedSteps() const
+{
+	return droppedSteps;
+}
+
+float PhysicsEngine::GetInterpolationAlpha() const
+{
+	return interpolationAlpha;
+}
+
+int PhysicsEngine::AddContactListener(const ContactListener& listener)
+{
+	contactListeners.emplace_back(nextContactListenerId, listener);
+	return nextContactListenerId++;
 }
 
-float PhysicsEngine::MinimumTranslationVector1D(const float centerA, const float radiusA, const float centerB, const float radiusB)
+void PhysicsEngine::RemoveContactListener(int listener_id)
 {
-	// Vector between the objects from centerA to centerB
-	float displacementAtoB = centerB - centerA;
+	contactListeners.erase(std::remove_if(contactListeners.begin(), contactListeners.end(), [listener_id](const std::pair<int, ContactListener>& listener)
+	{
+		return listener.first == listener_id;
+	}), contactListeners.end());
+}
 
-	// Find distance
-	float distance = abs(displacementAtoB);
+void PhysicsEngine::SaveSnapshot(WorldSnapshot& snapshot) const
+{
+	snapshot.Clear();
+	snapshot.Write(WorldSnapshot::MAGIC);
+	snapshot.Write(WorldSnapshot::VERSION);
 
-	// Detect overlapping
-	float radiiSum = radiusA + radiusB;
-	float overlap = distance - radiiSum;
+	// The whole size goes in the header so a restore can check it before replacing anything
+	const size_t size_offset = snapshot.GetSize();
+	snapshot.Write(static_cast<uint64_t>(0));
 
-	if (overlap > 0)
+	// Owners go by their slot, what they point at may be gone by the time the snapshot is restored
+	snapshot.Write(static_cast<uint32_t>(bodies.GetCount()));
+	for (int i = 0; i < bodies.GetCount(); i++)
 	{
-		return 0.0f;
+		const uint32_t slot = ownerSlots.at(bodies.owner[i]);
+		snapshot.Write(BodyHandle{ slot, owners[slot].generation });
 	}
 
-	// Are overlapping
-	float directionAtoB = Util::Sign(displacementAtoB);
-	float minimumTranslationVector = directionAtoB * overlap;
+	bodies.Save(snapshot);
 
-	return minimumTranslationVector;
+	snapshot.Write(static_cast<uint32_t>(manifolds.size()));
+	snapshot.WriteColumn(manifolds);
+
+	snapshot.Write(accumulator);
+	snapshot.Write(interpolationAlpha);
+	snapshot.Write(onSlingshot);
+
+	snapshot.WriteAt(size_offset, static_cast<uint64_t>(snapshot.GetSize()));
 }
 
-void PhysicsEngine::CircleAABBCollision()
+bool PhysicsEngine::RestoreSnapshot(const WorldSnapshot& snapshot)
 {
-	for (auto it = rectangles.begin(); it != rectangles.end(); it++)
+	size_t offset = 0;
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t size = 0;
+	if (!snapshot.Read(offset, magic) || !snapshot.Read(offset, version) || !snapshot.Read(offset, size) ||
+		magic != WorldSnapshot::MAGIC || version != WorldSnapshot::VERSION || size != snapshot.GetSize())
+	{
+		return false;
+	}
+
+	uint32_t owner_count = 0;
+	if (!snapshot.Read(offset, owner_count))
+	{
+		return false;
+	}
+
+	restoredOwners.clear();
+	for (uint32_t i = 0; i < owner_count; i++)
 	{
-		for (auto it2 = circles.begin(); it2 != circles.end(); it2++)
+		BodyHandle owner;
+		if (!snapshot.Read(offset, owner) || owner.slot >= owners.size() || owners[owner.slot].generation != owner.generation)
 		{
-			// Deference iterator to get the element
-			RigidBody* rect = (*it);
-			RigidBody* circle = (*it2);
+			return false;
+		}
+		restoredOwners.push_back(owners[owner.slot].body);
+	}
+
+	// Contacts of the world being replaced neither end nor carry on
+	contactEvents.clear();
+
+	uint32_t manifold_count = 0;
+	const bool read = bodies.Restore(snapshot, offset, restoredOwners) &&
+		snapshot.Read(offset, manifold_count) &&
+		snapshot.ReadColumn(offset, manifolds, manifold_count) &&
+		snapshot.Read(offset, accumulator) &&
+		snapshot.Read(offset, interpolationAlpha) &&
+		snapshot.Read(offset, onSlingshot);
 
-			float clampX = Util::Clamp(circle->gameObject->GetTransform()->position.x,
-				rect->gameObject->GetTransform()->position.x - rect->gameObject->GetWidth() / 2,
-				rect->gameObject->GetTransform()->position.x + rect->gameObject->GetWidth() / 2);
+	if (!read)
+	{
+		return false;
+	}
 
-			float clampY = Util::Clamp(circle->gameObject->GetTransform()->position.y,
-				rect->gameObject->GetTransform()->position.y - rect->gameObject->GetHeight() / 2,
-				rect->gameObject->GetTransform()->position.y + rect->gameObject->GetHeight() / 2);
+	RestoreProxies();
+	bodies.SyncTransforms(interpolationAlpha);
+	return true;
+}
 
-			glm::vec2 clampPoint = glm::vec2(clampX, clampY);
+RigidBody* PhysicsEngine::GetRigidBody(BodyHandle handle) const
+{
+	return bodies.IsValid(handle) ? bodies.owner[bodies.GetIndex(handle)] : nullptr;
+}
 
-			float distance = abs(Util::Magnitude(circle->gameObject->GetTransform()->position - clampPoint));
+ContactSolver& PhysicsEngine::GetSolver()
+{
+	return solver;
+}
 
-			if (distance > circle->radius)
-			{
-				continue;
-			}
+const std::vector<ContactManifold>& PhysicsEngine::GetManifolds() const
+{
+	return manifolds;
+}
 
-			glm::vec2 normalRelativePosRectToCircle = Util::Normalize(clampPoint - circle->gameObject->GetTransform()->position);
-			glm::vec2 mtv = normalRelativePosRectToCircle * (circle->radius - distance);
+void PhysicsEngine::SetContactMargin(float margin)
+{
+	contactMargin = margin;
+}
 
-			glm::vec2 displacementBRelativeA = rect->gameObject->GetTransform()->position - circle->gameObject->GetTransform()->position;
-			float distanceAB = Util::Magnitude(displacementBRelativeA);
+void PhysicsEngine::SetSleepEnabled(bool enabled)
+{
+	sleepEnabled = enabled;
 
-			glm::vec2  collisionNormalAtoB = displacementBRelativeA / distanceAB;
+	if (!sleepEnabled)
+	{
+		WakeAll();
+	}
+}
 
-			// get ralative velocity projected along normal
-			glm::vec2 velocityBRelativeA = rect->velocity - circle->velocity;
+bool PhysicsEngine::IsSleepEnabled() const
+{
+	return sleepEnabled;
+}
 
-			//ARE THEY MOVING TOWARD OR AWAY FROM EACH OTHER
-			float closingRate = Util::Dot(velocityBRelativeA, collisionNormalAtoB);
+void PhysicsEngine::SetSleepVelocity(float velocity)
+{
+	sleepVelocity = velocity;
+}
 
-			//Bounce
-			float restitution = Util::Min(circle->restitution, rect->restitution);
+void PhysicsEngine::SetSleepSteps(int steps)
+{
+	sleepSteps = std::max(1, steps);
+}
 
-			float totalMass = rect->mass + circle->mass;
-			float impulse = -(1.0f + restitution) * closingRate * circle->mass * rect->mass / (totalMass);
+void PhysicsEngine::SetThreadCount(int thread_count)
+{
+	workers.SetThreadCount(thread_count);
+}
 
-			glm::vec2  impulseA = -impulse * collisionNormalAtoB;
-			glm::vec2  impulseB = impulse * collisionNormalAtoB;
+int PhysicsEngine::GetThreadCount() const
+{
+	return workers.GetThreadCount();
+}
 
-			//to apply impulse, just divide by mass 
-			glm::vec2 deltaVA = impulseA / circle->mass;
-			glm::vec2 deltaVB = impulseB / rect->mass;
+const BodyStore& PhysicsEngine::GetBodies() const
+{
+	return bodies;
+}
 
+const std::vector<RigidBodyDebug>& PhysicsEngine::UpdateDebugTable()
+{
+	const int count = bodies.GetCount();
+	debugTable.assign(count, RigidBodyDebug());
 
-			if (rect->gameObject->GetType() != GameObjectType::OBSTACLE)
-			{
-				rect->gameObject->GetTransform()->position += mtv;
-			}
-			else
-			{
-				if (rect->gameObject->GetTransform()->position.y < circle->gameObject->GetTransform()->position.y)
-				{
-					rect->gameObject->GetTransform()->position += mtv;
-				}
-				else
-				{
-					circle->gameObject->GetTransform()->position -= mtv;
-				}
-			}
+	// The impulses are what the solver applied over the last substep
+	const float inverse_delta_time = static_cast<float>(substeps) / fixedDeltaTime;
+	std::vector<glm::vec2> contact_normals(count, glm::vec2(0, 0));
 
-			if (closingRate < 0)
-			{
-				//apply changes in velocity to objects
-				circle->velocity += deltaVA;
-				rect->velocity += deltaVB;
+	for (const auto& manifold : manifolds)
+	{
+		const glm::vec2 tangent = glm::vec2(-manifold.normal.y, manifold.normal.x);
+		float normal_impulse = 0.0f;
+		float tangent_impulse = 0.0f;
+		for (int i = 0; i < manifold.pointCount; i++)
+		{
+			normal_impulse += manifold.points[i].normalImpulse;
+			tangent_impulse += manifold.points[i].tangentImpulse;
+		}
 
-				if (circle->gameObject->GetType() == GameObjectType::PIG && impulse >= circle->toughness * 10)
-				{
-					circle->wasKilled = true;
-				}
-				else if (circle->gameObject->GetType() == GameObjectType::PIG && rect->gameObject->GetType() == GameObjectType::PLAYER && impulse >= circle->toughness)
-				{
-					circle->wasKilled = true;
-				}
-			}
+		// The normal points from A to B, the solver pushes A back along it and B forward
+		const glm::vec2 normal_force = manifold.normal * normal_impulse * inverse_delta_time;
+		const glm::vec2 friction_force = tangent * tangent_impulse * inverse_delta_time;
+
+		RigidBodyDebug& a = debugTable[manifold.bodyA];
+		a.fNormal -= normal_force;
+		a.fFriction -= friction_force;
+		a.contactCount++;
+		contact_normals[manifold.bodyA] -= normal_force;
+
+		if (manifold.bodyB != ContactManifold::STATIC_BODY)
+		{
+			RigidBodyDebug& b = debugTable[manifold.bodyB];
+			b.fNormal += normal_force;
+			b.fFriction += friction_force;
+			b.contactCount++;
+			contact_normals[manifold.bodyB] += normal_force;
+		}
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		RigidBodyDebug& debug = debugTable[i];
+		if (bodies.enableGravity[i])
+		{
+			debug.fGravity = gravity * glm::vec2(bodies.gravityScaleX[i], bodies.gravityScaleY[i]) * bodies.mass[i];
 		}
+
+		const float length = std::sqrt(Dot(contact_normals[i], contact_normals[i]));
+		const glm::vec2 normal = (length > 0.0f) ? contact_normals[i] / length : glm::vec2(0, 0);
+		debug.fPerpendicularGravity = normal * Dot(debug.fGravity, normal);
+		debug.fParallelGravity = debug.fGravity - debug.fPerpendicularGravity;
+	}
+
+	return debugTable;
+}
+
+const RigidBodyDebug* PhysicsEngine::GetDebug(const BodyHandle handle) const
+{
+	if (!bodies.IsValid(handle))
+	{
+		return nullptr;
 	}
+
+	const int index = bodies.GetIndex(handle);
+	return index < static_cast<int>(debugTable.size()) ? &debugTable[index] : nullptr;
 }
 
-clock_t PhysicsEngine::endTime = 0;
-clock_t PhysicsEngine::startTime = 0;
\ No newline at end of file
+PhysicsProfiler& PhysicsEngine::GetProfiler()
+{
+	return profiler;
+}
+
+int PhysicsEngine::GetBodyCount() const
+{
+	return bodies.GetCount();
+}
+
+int PhysicsEngine::GetCandidatePairCount() const
+{
+	return static_cast<int>(candidatePairs.size());
+}
+
+int PhysicsEngine::GetAllPairsCount() const
+{
+	// Number of pairs the old nested loops walked over
+	const int count = GetBodyCount();
+	return count * (count - 1) / 2;
+}
+
+int PhysicsEngine::GetManifoldCount() const
+{
+	return static_cast<int>(manifolds.size());
+}
+
+int PhysicsEngine::GetWarmStartedCount() const
+{
+	return warmStartedPoints;
+}
+
+int PhysicsEngine::GetContactEventCount() const
+{
+	return static_cast<int>(dispatchedContactEvents.size());
+}
+
+int PhysicsEngine::GetDroppedContactEventCount() const
+{
+	return droppedContactEvents;
+}
+
+int PhysicsEngine::GetTimeOfImpactCount() const
+{
+	return timeOfImpactCount;
+}
+
+int PhysicsEngine::GetAwakeBodyCount() const
+{
+	return awakeBodies;
+}
+
+int PhysicsEngine::GetSleepingBodyCount() const
+{
+	return sleepingBodies;
+}
+
+AABB PhysicsEngine::ComputeAABB(const int index) const
+{
+	const glm::vec2 center = bodies.GetPosition(index);
+
+	// Grown by the contact margin so pairs about to touch reach the narrowphase
+	const glm::vec2 margin = glm::vec2(contactMargin, contactMargin);
+
+	if (bodies.shape[index] == CollisionShape::CIRCLE)
+	{
+		return AABB::FromCenter(center, glm::vec2(bodies.radius[index], bodies.radius[index]) + margin);
+	}
+
+	return AABB::FromCenter(center, glm::vec2(bodies.halfWidth[index], bodies.halfHeight[index]) + margin);
+}
+
+void PhysicsEngine::AddBody(RigidBody* rb, CollisionShape shape, const ConvexShape& hull)
+{
+	if (rb->IsSimulated())
+	{
+		return;
+	}
+
+	rb->shape = shape;
+	const BodyHandle handle = bodies.Add(rb, hull);
+	AddProxy(bodies.GetIndex(handle));
+	RegisterOwner(rb);
+}
+
+void PhysicsEngine::RemoveBody(RigidBody* rb)
+{
+	if (!rb->IsSimulated() || rb->store != &bodies)
+	{
+		return;
+	}
+
+	const int index = bodies.GetIndex(rb->handle);
+
+	// Whatever rested on the body has lost its support
+	for (const auto& manifold : manifolds)
+	{
+		if (manifold.bodyB == ContactManifold::STATIC_BODY)
+		{
+			continue;
+		}
+
+		if (manifold.bodyA == index || manifold.bodyB == index)
+		{
+			bodies.Wake(manifold.bodyA == index ? manifold.bodyB : manifold.bodyA);
+		}
+	}
+
+	RemoveProxy(index);
+
+	// The last body takes the place of the removed one, point its proxy and contacts at the new index
+	const int last = bodies.GetCount() - 1;
+	const int moved = bodies.Remove(rb->handle);
+	if (moved != -1)
+	{
+		SetProxyBody(bodies.proxyId[moved], moved);
+
+		for (auto& manifold : manifolds)
+		{
+			manifold.bodyA = (manifold.bodyA == last) ? moved : manifold.bodyA;
+			manifold.bodyB = (manifold.bodyB == last) ? moved : manifold.bodyB;
+		}
+	}
+}
+
+void PhysicsEngine::RegisterOwner(RigidBody* rb)
+{
+	if (ownerSlots.count(rb) != 0)
+	{
+		return;
+	}
+
+	uint32_t slot;
+	if (!freeOwners.empty())
+	{
+		slot = freeOwners.back();
+		freeOwners.pop_back();
+	}
+	else
+	{
+		slot = static_cast<uint32_t>(owners.size());
+		owners.emplace_back();
+	}
+
+	owners[slot].body = rb;
+	ownerSlots[rb] = slot;
+}
+
+void PhysicsEngine::ForgetOwner(const RigidBody* rb)
+{
+	const auto found = ownerSlots.find(rb);
+	if (found == ownerSlots.end())
+	{
+		return;
+	}
+
+	owners[found->second].body = nullptr;
+	owners[found->second].generation++;
+	freeOwners.push_back(found->second);
+	ownerSlots.erase(found);
+}
+
+void PhysicsEngine::AddProxy(const int index)
+{
+	const int proxy_id = bodies.IsStatic(index) ? STATIC_PROXY_BASE + staticTree.CreateProxy(ComputeAABB(index)) :
+		broadphase->CreateProxy(ComputeAABB(index));
+	bodies.proxyId[index] = proxy_id;
+	SetProxyBody(proxy_id, index);
+}
+
+int PhysicsEngine::GetProxyBody(const int proxy_id) const
+{
+	if (proxy_id >= STATIC_PROXY_BASE)
+	{
+		return staticProxyBodies[proxy_id - STATIC_PROXY_BASE];
+	}
+	return proxyBodies[proxy_id];
+}
+
+void PhysicsEngine::SetProxyBody(const int proxy_id, const int index)
+{
+	std::vector<int>& proxy_bodies = (proxy_id >= STATIC_PROXY_BASE) ? staticProxyBodies : proxyBodies;
+	const int slot = (proxy_id >= STATIC_PROXY_BASE) ? proxy_id - STATIC_PROXY_BASE : proxy_id;
+
+	if (slot >= static_cast<int>(proxy_bodies.size()))
+	{
+		proxy_bodies.resize(slot + 1, -1);
+	}
+	proxy_bodies[slot] = index;
+}
+
+void PhysicsEngine::RemoveProxy(const int index)
+{
+	const int proxy_id = bodies.proxyId[index];
+	if (proxy_id == -1)
+	{
+		return;
+	}
+
+	// Pairs of this step still reference the proxy, the narrowphase skips it once it maps to no body
+	if (proxy_id >= STATIC_PROXY_BASE)
+	{
+		staticTree.DestroyProxy(proxy_id - STATIC_PROXY_BASE);
+	}
+	else
+	{
+		broadphase->DestroyProxy(proxy_id);
+	}
+	SetProxyBody(proxy_id, -1);
+	bodies.proxyId[index] = -1;
+
+	// A new body can get the same proxy id, it must not inherit these impulses
+	manifolds.erase(std::remove_if(manifolds.begin(), manifolds.end(), [this, proxy_id](const ContactManifold& manifold)
+	{
+		if (manifold.proxyA != proxy_id && manifold.proxyB != proxy_id)
+		{
+			return false;
+		}
+
+		if (manifold.touching)
+		{
+			PushContactEvent(ContactEventType::END, manifold);
+		}
+		return true;
+	}), manifolds.end());
+}
+
+void PhysicsEngine::RestoreProxies()
+{
+	const int count = bodies.GetCount();
+
+	// Usually the proxies of the snapshot are all still there, only their boxes and bodies changed
+	int static_count = 0;
+	bool same_proxies = true;
+	for (int i = 0; i < count && same_proxies; i++)
+	{
+		const int proxy_id = bodies.proxyId[i];
+		const bool is_static = bodies.IsStatic(i);
+		const std::vector<int>& proxy_bodies = is_static ? staticProxyBodies : proxyBodies;
+		const int slot = is_static ? proxy_id - STATIC_PROXY_BASE : proxy_id;
+		same_proxies = slot >= 0 && slot < static_cast<int>(proxy_bodies.size()) && proxy_bodies[slot] != -1;
+		static_count += is_static ? 1 : 0;
+	}
+	same_proxies = same_proxies && broadphase->GetProxyCount() == count - static_count &&
+		std::count_if(staticProxyBodies.begin(), staticProxyBodies.end(), [](const int index) { return index != -1; }) == static_count;
+
+	if (same_proxies)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			SetProxyBody(bodies.proxyId[i], i);
+			if (!bodies.IsStatic(i))
+			{
+				broadphase->MoveProxy(bodies.proxyId[i], ComputeAABB(i));
+			}
+		}
+		return;
+	}
+
+	// Otherwise the broadphase and the static tree start over and the contacts are keyed by the proxy ids they
+	// hand out
+	std::vector<int> proxy_map(proxyBodies.size(), -1);
+	std::vector<int> static_proxy_map(staticProxyBodies.size(), -1);
+	for (int i = 0; i < count; i++)
+	{
+		const int proxy_id = bodies.proxyId[i];
+		std::vector<int>& map = (proxy_id >= STATIC_PROXY_BASE) ? static_proxy_map : proxy_map;
+		const int slot = (proxy_id >= STATIC_PROXY_BASE) ? proxy_id - STATIC_PROXY_BASE : proxy_id;
+		if (slot >= static_cast<int>(map.size()))
+		{
+			map.resize(slot + 1, -1);
+		}
+	}
+
+	broadphase = CreateBroadphase(broadphase->GetType(), broadphaseCellSize);
+	staticTree = DynamicTree();
+	staticTree.SetMargin(0.0f);
+	proxyBodies.clear();
+	staticProxyBodies.clear();
+	candidatePairs.clear();
+
+	for (int i = 0; i < count; i++)
+	{
+		const int old_proxy_id = bodies.proxyId[i];
+		AddProxy(i);
+		if (old_proxy_id >= STATIC_PROXY_BASE)
+		{
+			static_proxy_map[old_proxy_id - STATIC_PROXY_BASE] = bodies.proxyId[i];
+		}
+		else if (old_proxy_id != -1)
+		{
+			proxy_map[old_proxy_id] = bodies.proxyId[i];
+		}
+	}
+
+	auto remap = [&proxy_map, &static_proxy_map](const int proxy_id)
+	{
+		return (proxy_id >= STATIC_PROXY_BASE) ? static_proxy_map[proxy_id - STATIC_PROXY_BASE] : proxy_map[proxy_id];
+	};
+
+	for (auto& manifold : manifolds)
+	{
+		manifold.proxyA = remap(manifold.proxyA);
+		if (manifold.bodyB == ContactManifold::STATIC_BODY)
+		{
+			continue;
+		}
+
+		manifold.proxyB = remap(manifold.proxyB);
+		if (manifold.proxyA > manifold.proxyB)
+		{
+			// A is the lower proxy of the pair, turning the pair around turns the normal around
+			std::swap(manifold.proxyA, manifold.proxyB);
+			std::swap(manifold.bodyA, manifold.bodyB);
+			std::swap(manifold.startPositionA, manifold.startPositionB);
+			manifold.normal = -manifold.normal;
+		}
+	}
+
+	std::sort(manifolds.begin(), manifolds.end());
+}
+
+void PhysicsEngine::UpdateContacts()
+{
+	{
+		PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::NARROWPHASE);
+		CollidePairs();
+	}
+
+	{
+		PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::STATIC_GEOMETRY);
+		staticContacts.clear();
+		staticGeometry.Collide(bodies, contactMargin, staticContacts);
+	}
+
+	PHYSICS_PROFILE_SCOPE(profiler, ProfilerPhase::CONTACT_MATCHING);
+
+	// All three lists are sorted by proxy pair, walk them together to find last step's manifold of every pair.
+	// Static contacts sort after the pairs of the same body
+	previousManifolds.swap(manifolds);
+	manifolds.clear();
+	warmStartedPoints = 0;
+
+	std::vector<ContactManifold>::const_iterator previous = previousManifolds.begin();
+	auto next_static = staticContacts.cbegin();
+	for (const auto& buffer : contactBuffers)
+	{
+		for (const auto& manifold : buffer)
+		{
+			for (; next_static != staticContacts.cend() && *next_static < manifold; ++next_static)
+			{
+				MergeContact(*next_static, previous);
+			}
+			MergeContact(manifold, previous);
+		}
+	}
+
+	for (; next_static != staticContacts.cend(); ++next_static)
+	{
+		MergeContact(*next_static, previous);
+	}
+
+	for (; previous != previousManifolds.end(); ++previous)
+	{
+		EndContact(*previous);
+	}
+}
+
+void PhysicsEngine::EndContact(const ContactManifold& manifold)
+{
+	if (!manifold.touching)
+	{
+		return;
+	}
+
+	// A pair the collision filter dropped may have been holding a sleeping body up, and nothing else wakes it
+	if (manifold.bodyB != ContactManifold::STATIC_BODY && !bodies.CanCollide(manifold.bodyA, manifold.bodyB))
+	{
+		bodies.Wake(manifold.bodyA);
+		bodies.Wake(manifold.bodyB);
+	}
+
+	PushContactEvent(ContactEventType::END, manifold);
+}
+
+void PhysicsEngine::MergeContact(ContactManifold manifold, std::vector<ContactManifold>::const_iterator& previous)
+{
+	const int a = manifold.bodyA;
+	const int b = manifold.bodyB;
+
+	// Last step's manifolds passed over have no pair this step, their contact ended
+	while (previous != previousManifolds.cend() && *previous < manifold)
+	{
+		EndContact(*previous);
+		++previous;
+	}
+
+	const bool has_previous = previous != previousManifolds.cend() && previous->proxyA == manifold.proxyA && previous->proxyB == manifold.proxyB;
+	const ContactManifold* matched = has_previous ? &*previous : nullptr;
+	if (has_previous)
+	{
+		++previous;
+	}
+
+	if (manifold.pointCount == 0)
+	{
+		// Neither body moved, last step's manifold still holds and keeps the island together
+		if (matched != nullptr)
+		{
+			manifold = *matched;
+			manifold.bodyA = a;
+			manifold.bodyB = b;
+			manifolds.push_back(manifold);
+		}
+		return;
+	}
+
+	// A moving body touching or closing in on a sleeping one wakes it, UpdateIslands wakes the rest of its
+	// island. Only waking on contact keeps a body that merely sits in the margin from waking it every step.
+	// Static geometry never wakes anything
+	if (b != ContactManifold::STATIC_BODY && (!IsMoving(a) || !IsMoving(b)))
+	{
+		const glm::vec2 relative_velocity = bodies.GetVelocity(b) - bodies.GetVelocity(a);
+		const float approach = Dot(relative_velocity, manifold.normal);
+
+		if (manifold.points[0].separation <= 0.0f || approach < 0.0f)
+		{
+			if (bodies.enableGravity[a] && !bodies.IsAwake(a))
+			{
+				bodies.Wake(a);
+			}
+			if (bodies.enableGravity[b] && !bodies.IsAwake(b))
+			{
+				bodies.Wake(b);
+			}
+		}
+	}
+
+	if (matched != nullptr)
+	{
+		manifold.wasTouching = matched->touching;
+		manifold.peakImpactImpulse = matched->peakImpactImpulse;
+
+		// Points made by the same features carry their impulses over
+		for (int i = 0; i < manifold.pointCount; i++)
+		{
+			for (int j = 0; j < matched->pointCount; j++)
+			{
+				if (manifold.points[i].featureId == matched->points[j].featureId)
+				{
+					manifold.points[i].normalImpulse = matched->points[j].normalImpulse;
+					manifold.points[i].tangentImpulse = matched->points[j].tangentImpulse;
+					warmStartedPoints++;
+					break;
+				}
+			}
+		}
+	}
+
+	manifolds.push_back(manifold);
+}
+
+void PhysicsEngine::CollidePairs()
+{
+	const int pair_count = static_cast<int>(candidatePairs.size());
+
+	// Small levels are done before the workers would have woken up
+	const int thread_count = (pair_count >= PARALLEL_PAIR_COUNT) ? workers.GetThreadCount() : 1;
+	const int batch_size = (thread_count == 1) ? std::max(pair_count, 1) :
+		std::max(NARROWPHASE_BATCH_SIZE, (pair_count + thread_count * 4 - 1) / (thread_count * 4));
+
+	// One buffer per batch of pairs, read back in batch order the manifolds are in candidate pair order
+	// whichever thread ran which batch
+	contactBuffers.resize(WorkerPool::GetBatchCount(pair_count, batch_size));
+	for (auto& buffer : contactBuffers)
+	{
+		buffer.clear();
+	}
+
+	auto collide_batch = [this](const int batch, const int begin, const int end)
+	{
+		std::vector<ContactManifold>& buffer = contactBuffers[batch];
+
+		// Last step's manifolds are still in place and sorted like the pairs, walked alongside them for the
+		// GJK simplex each pair finished on
+		ContactManifold first;
+		first.proxyA = candidatePairs[begin].proxyA;
+		first.proxyB = candidatePairs[begin].proxyB;
+		auto previous = std::lower_bound(manifolds.cbegin(), manifolds.cend(), first);
+
+		for (int i = begin; i < end; i++)
+		{
+			const BroadphasePair& pair = candidatePairs[i];
+			const int a = GetProxyBody(pair.proxyA);
+			const int b = GetProxyBody(pair.proxyB);
+
+			// Filtered pairs never reach the shapes, and neither do pairs of kinematic bodies
+			if (a == -1 || b == -1 || !bodies.CanCollide(a, b) || (!bodies.enableGravity[a] && !bodies.enableGravity[b]))
+			{
+				continue;
+			}
+
+			ContactManifold manifold;
+			manifold.proxyA = pair.proxyA;
+			manifold.proxyB = pair.proxyB;
+			manifold.bodyA = a;
+			manifold.bodyB = b;
+
+			while (previous != manifolds.cend() && *previous < manifold)
+			{
+				++previous;
+			}
+			if (previous != manifolds.cend() && previous->proxyA == pair.proxyA && previous->proxyB == pair.proxyB)
+			{
+				manifold.simplexCache = previous->simplexCache;
+			}
+
+			// No points asks the merge to keep last step's manifold
+			if (!IsMoving(a) && !IsMoving(b))
+			{
+				buffer.push_back(manifold);
+				continue;
+			}
+
+			if (Narrowphase::Collide(bodies, a, b, contactMargin, manifold))
+			{
+				buffer.push_back(manifold);
+			}
+		}
+	};
+
+	workers.ParallelFor(pair_count, batch_size, collide_batch);
+}
+
+void PhysicsEngine::EmitContactEvents(const bool end_of_step)
+{
+	for (auto& manifold : manifolds)
+	{
+		// Sleeping contacts neither change nor report
+		if (!IsMoving(manifold.bodyA) && (manifold.bodyB == ContactManifold::STATIC_BODY || !IsMoving(manifold.bodyB)))
+		{
+			continue;
+		}
+
+		manifold.touching = false;
+		for (int i = 0; i < manifold.pointCount; i++)
+		{
+			manifold.touching = manifold.touching || manifold.points[i].separation <= 0.0f || manifold.points[i].normalImpulse > 0.0f;
+		}
+
+		if (manifold.touching && !manifold.wasTouching)
+		{
+			PushContactEvent(ContactEventType::BEGIN, manifold);
+			manifold.peakImpactImpulse = 0.0f;
+		}
+		else if (manifold.touching)
+		{
+			// Substeps only raise the peak, the step reports it once
+			manifold.peakImpactImpulse = std::max(manifold.peakImpactImpulse, manifold.impactImpulse);
+			if (end_of_step)
+			{
+				PushContactEvent(ContactEventType::PERSIST, manifold);
+				manifold.peakImpactImpulse = 0.0f;
+			}
+		}
+		else if (manifold.wasTouching)
+		{
+			PushContactEvent(ContactEventType::END, manifold);
+		}
+
+		// Substeps after this one compare against this one
+		manifold.wasTouching = manifold.touching;
+	}
+}
+
+void PhysicsEngine::PushContactEvent(const ContactEventType type, const ContactManifold& manifold)
+{
+	// BEGIN and END come once per contact and listeners keep track of them, only PERSIST is let go
+	if (type == ContactEventType::PERSIST && contactEvents.size() >= CONTACT_EVENT_CAPACITY)
+	{
+		droppedContactEvents++;
+		return;
+	}
+
+	ContactEvent event;
+	event.type = type;
+	event.bodyA = bodies.GetHandle(manifold.bodyA);
+	event.bodyB = (manifold.bodyB == ContactManifold::STATIC_BODY) ? BodyHandle() : bodies.GetHandle(manifold.bodyB);
+	event.normal = manifold.normal;
+
+	if (type != ContactEventType::END)
+	{
+		event.impactImpulse = (type == ContactEventType::PERSIST) ? manifold.peakImpactImpulse : manifold.impactImpulse;
+		for (int i = 0; i < manifold.pointCount; i++)
+		{
+			event.normalImpulse += manifold.points[i].normalImpulse;
+		}
+	}
+
+	contactEvents.push_back(event);
+}
+
+void PhysicsEngine::DispatchContactEvents()
+{
+	// Listeners removing bodies push END events, those go into the emptied buffer for the next frame
+	dispatchedContactEvents.swap(contactEvents);
+	contactEvents.clear();
+
+	for (const auto& listener : contactListeners)
+	{
+		listener.second(dispatchedContactEvents);
+	}
+}
+
+void PhysicsEngine::WakeAll()
+{
+	const int count = bodies.GetCount();
+	for (int i = 0; i < count; i++)
+	{
+		bodies.Wake(i);
+	}
+}
+
+bool PhysicsEngine::IsMoving(const int index) const
+{
+	// A kinematic body standing still lets what rests on it sleep, it wakes them as soon as it moves
+	if (bodies.bodyType[index] == BodyType::KINEMATIC)
+	{
+		return bodies.velocityX[index] != 0.0f || bodies.velocityY[index] != 0.0f;
+	}
+	return bodies.enableGravity[index] && bodies.IsAwake(index);
+}
+
+int PhysicsEngine::FindIsland(int index)
+{
+	while (islandParents[index] != index)
+	{
+		// Path halving
+		islandParents[index] = islandParents[islandParents[index]];
+		index = islandParents[index];
+	}
+	return index;
+}
+
+void PhysicsEngine::UpdateIslands()
+{
+	const int count = bodies.GetCount();
+	awakeBodies = 0;
+	sleepingBodies = 0;
+
+	if (!sleepEnabled)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			awakeBodies += bodies.enableGravity[i] ? 1 : 0;
+		}
+		return;
+	}
+
+	const float sleep_velocity_squared = sleepVelocity * sleepVelocity;
+	for (int i = 0; i < count; i++)
+	{
+		if (!IsMoving(i))
+		{
+			continue;
+		}
+
+		const float speed_squared = bodies.velocityX[i] * bodies.velocityX[i] + bodies.velocityY[i] * bodies.velocityY[i];
+		bodies.stillSteps[i] = (speed_squared < sleep_velocity_squared) ? bodies.stillSteps[i] + 1 : 0;
+	}
+
+	// Bodies pressed together form an island, static bodies do not join them or the ground would make
+	// the whole level one island
+	islandParents.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		islandParents[i] = i;
+	}
+
+	for (const auto& manifold : manifolds)
+	{
+		if (manifold.bodyB == ContactManifold::STATIC_BODY || !bodies.enableGravity[manifold.bodyA] || !bodies.enableGravity[manifold.bodyB])
+		{
+			continue;
+		}
+
+		bool touching = false;
+		for (int i = 0; i < manifold.pointCount; i++)
+		{
+			touching = touching || manifold.points[i].separation <= 0.0f || manifold.points[i].normalImpulse > 0.0f;
+		}
+
+		if (touching)
+		{
+			islandParents[FindIsland(manifold.bodyA)] = FindIsland(manifold.bodyB);
+		}
+	}
+
+	// An island sleeps once its most recently moving body has been still long enough, sleeping bodies
+	// count as still, so one woken body wakes the island again
+	islandStillSteps.assign(count, sleepSteps);
+	for (int i = 0; i < count; i++)
+	{
+		if (bodies.enableGravity[i])
+		{
+			const int island = FindIsland(i);
+			const int still_steps = bodies.IsAwake(i) ? bodies.stillSteps[i] : sleepSteps;
+			islandStillSteps[island] = std::min(islandStillSteps[island], still_steps);
+		}
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		if (!bodies.enableGravity[i])
+		{
+			continue;
+		}
+
+		const bool island_still = islandStillSteps[FindIsland(i)] >= sleepSteps;
+		if (island_still && bodies.IsAwake(i))
+		{
+			bodies.Sleep(i);
+		}
+		else if (!island_still && !bodies.IsAwake(i))
+		{
+			bodies.Wake(i);
+		}
+
+		if (bodies.IsAwake(i))
+		{
+			awakeBodies++;
+		}
+		else
+		{
+			sleepingBodies++;
+		}
+	}
+}
+
+void PhysicsEngine::SaveSweepStarts()
+{
+	sweptBodies.clear();
+	sweepStarts.clear();
+
+	const int count = bodies.GetCount();
+	for (int i = 0; i < count; i++)
+	{
+		if (bodies.continuousCollision[i] && IsMoving(i))
+		{
+			sweptBodies.push_back(i);
+			sweepStarts.push_back(bodies.GetPosition(i));
+		}
+	}
+}
+
+void PhysicsEngine::SweepFastBodies()
+{
+	for (int k = 0; k < static_cast<int>(sweptBodies.size()); k++)
+	{
+		const int i = sweptBodies[k];
+		const glm::vec2 start = sweepStarts[k];
+		const glm::vec2 translation = bodies.GetPosition(i) - start;
+
+		// Boxes are swept as the circle inside them, which stops them a little late but never lets them through.
+		// Capsules are swept as a circle of their radius around the middle
+		const bool rounded = bodies.shape[i] == CollisionShape::CIRCLE || bodies.shape[i] == CollisionShape::CAPSULE;
+		const float radius = rounded ? bodies.radius[i] : std::min(bodies.halfWidth[i], bodies.halfHeight[i]);
+
+		// Slow enough for the speculative contacts to catch, only fast bodies pay for the sweep
+		const float distance = std::sqrt(Dot(translation, translation));
+		if (distance < radius * 0.5f)
+		{
+			continue;
+		}
+
+		float first_fraction;
+		glm::vec2 normal;
+		if (!SweepCircle(start, translation, radius, i, false, first_fraction, normal))
+		{
+			continue;
+		}
+
+		// Stop just short of the impact and keep the velocity, next substep the contact is made and the solver
+		// bounces the body with the usual restitution and impact damage. The rest of this substep's motion is lost
+		const float fraction = std::max(0.0f, first_fraction - TIME_OF_IMPACT_GAP / distance);
+		bodies.SetPosition(i, start + translation * fraction);
+		timeOfImpactCount++;
+	}
+}
+
+bool PhysicsEngine::SweepCircle(const glm::vec2 start, const glm::vec2 translation, const float radius, const BodyHandle ignore,
+	const bool static_only, float& fraction, glm::vec2& normal)
+{
+	const int index = bodies.IsValid(ignore) ? bodies.GetIndex(ignore) : -1;
+	return SweepCircle(start, translation, radius, index, static_only, fraction, normal);
+}
+
+bool PhysicsEngine::SweepCircle(const glm::vec2 start, const glm::vec2 translation, const float radius, const int ignore,
+	const bool static_only, float& fraction, glm::vec2& normal)
+{
+	fraction = 1.0f;
+
+	const glm::vec2 end = start + translation;
+	const AABB swept = AABB::Union(AABB::FromCenter(start, glm::vec2(radius, radius)), AABB::FromCenter(end, glm::vec2(radius, radius)));
+	sweepCandidates.clear();
+	if (!static_only)
+	{
+		broadphase->Query(swept, sweepCandidates);
+	}
+	staticTree.Query(swept, [this](const int static_proxy)
+	{
+		sweepCandidates.push_back(STATIC_PROXY_BASE + static_proxy);
+		return true;
+	});
+
+	for (const int proxy : sweepCandidates)
+	{
+		const int other = GetProxyBody(proxy);
+		if (other == -1 || other == ignore || (ignore != -1 && !bodies.CanCollide(ignore, other)))
+		{
+			continue;
+		}
+
+		// Anything but a circle is hit at its bounding box, a turned plank stops the body a little early
+		float body_fraction;
+		glm::vec2 body_normal;
+		const bool hit = (bodies.shape[other] == CollisionShape::CIRCLE) ?
+			TimeOfImpact::SweepCircleCircle(start, translation, radius, bodies.GetPosition(other), bodies.radius[other], body_fraction, body_normal) :
+			TimeOfImpact::SweepCircleBox(start, translation, radius, bodies.GetPosition(other),
+				glm::vec2(bodies.halfWidth[other], bodies.halfHeight[other]), body_fraction, body_normal);
+
+		if (hit && body_fraction < fraction)
+		{
+			fraction = body_fraction;
+			normal = body_normal;
+		}
+	}
+
+	float static_fraction;
+	glm::vec2 static_normal;
+	if ((ignore == -1 || (bodies.collisionMask[ignore] & StaticGeometry::LAYER) != 0) &&
+		staticGeometry.Sweep(start, translation, radius, static_fraction, static_normal) != -1 && static_fraction < fraction)
+	{
+		fraction = static_fraction;
+		normal = static_normal;
+	}
+
+	return fraction < 1.0f;
+}
+
+bool PhysicsEngine::RayCast(const RayCastInput& input, RayCastHit& hit) const
+{
+	hit = RayCastHit();
+	int closest = -1;
+
+	// Every hit clips the cast, so the walks skip the proxies behind it
+	auto cast_body = [this, &input, &hit, &closest](const int index, const float max_fraction)
+	{
+		float fraction;
+		glm::vec2 normal;
+		if ((bodies.collisionLayer[index] & input.mask) == 0 || !CastBody(index, input, fraction, normal) || fraction >= max_fraction)
+		{
+			return max_fraction;
+		}
+
+		closest = index;
+		hit.fraction = fraction;
+		hit.normal = normal;
+		return fraction;
+	};
+
+	// Bodies teleported since the last step are not where their proxies are, they are cast one by one below
+	const std::vector<BodyHandle>& teleported = bodies.GetTeleported();
+	auto cast_proxy = [this, &cast_body, &teleported](const int proxy_id, const float max_fraction)
+	{
+		const int index = GetProxyBody(proxy_id);
+		if (index == -1 ||
+			(!teleported.empty() && std::find(teleported.begin(), teleported.end(), bodies.GetHandle(index)) != teleported.end()))
+		{
+			return max_fraction;
+		}
+		return cast_body(index, max_fraction);
+	};
+
+	broadphase->RayCast(input, hit.fraction, cast_proxy);
+	staticTree.RayCast(input.start, input.translation, input.radius, hit.fraction, [&cast_proxy](const int static_proxy, const float max_fraction)
+	{
+		return cast_proxy(STATIC_PROXY_BASE + static_proxy, max_fraction);
+	});
+
+	for (const BodyHandle handle : teleported)
+	{
+		if (bodies.IsValid(handle))
+		{
+			cast_body(bodies.GetIndex(handle), hit.fraction);
+		}
+	}
+
+	float static_fraction;
+	glm::vec2 static_normal;
+	const int static_shape = ((input.mask & StaticGeometry::LAYER) != 0) ?
+		staticGeometry.Sweep(input.start, input.translation, input.radius, static_fraction, static_normal) : -1;
+	if (static_shape != -1 && static_fraction < hit.fraction)
+	{
+		closest = -1;
+		hit.staticShape = static_shape;
+		hit.fraction = static_fraction;
+		hit.normal = static_normal;
+	}
+
+	hit.hit = closest != -1 || hit.staticShape != -1;
+	if (!hit.hit)
+	{
+		return false;
+	}
+
+	hit.body = (closest != -1) ? bodies.GetHandle(closest) : BodyHandle();
+	hit.point = input.start + input.translation * hit.fraction - hit.normal * input.radius;
+	return true;
+}
+
+bool PhysicsEngine::RayCast(const glm::vec2 start, const glm::vec2 direction, const float max_distance, RayCastHit& hit, const uint32_t mask) const
+{
+	const float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (length <= 0.0f)
+	{
+		hit = RayCastHit();
+		return false;
+	}
+
+	RayCastInput input;
+	input.start = start;
+	input.translation = direction * (max_distance / length);
+	input.mask = mask;
+	return RayCast(input, hit);
+}
+
+bool PhysicsEngine::SegmentCast(const glm::vec2 start, const glm::vec2 end, RayCastHit& hit, const uint32_t mask) const
+{
+	RayCastInput input;
+	input.start = start;
+	input.translation = end - start;
+	input.mask = mask;
+	return RayCast(input, hit);
+}
+
+bool PhysicsEngine::CircleCast(const glm::vec2 start, const glm::vec2 translation, const float radius, RayCastHit& hit, const uint32_t mask) const
+{
+	RayCastInput input;
+	input.start = start;
+	input.translation = translation;
+	input.radius = radius;
+	input.mask = mask;
+	return RayCast(input, hit);
+}
+
+void PhysicsEngine::RayCastBatch(const std::vector<RayCastInput>& inputs, std::vector<RayCastHit>& hits)
+{
+	const int count = static_cast<int>(inputs.size());
+	hits.resize(count);
+
+	auto cast_batch = [this, &inputs, &hits](int, const int begin, const int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			RayCast(inputs[i], hits[i]);
+		}
+	};
+
+	if (count < PARALLEL_CAST_COUNT)
+	{
+		cast_batch(0, 0, count);
+		return;
+	}
+
+	workers.ParallelFor(count, CAST_BATCH_SIZE, cast_batch);
+}
+
+bool PhysicsEngine::CastBody(const int index, const RayCastInput& input, float& fraction, glm::vec2& normal) const
+{
+	const glm::vec2 position = bodies.GetPosition(index);
+	switch (bodies.shape[index])
+	{
+	case CollisionShape::CIRCLE:
+		return TimeOfImpact::SweepCircleCircle(input.start, input.translation, input.radius, position, bodies.radius[index], fraction, normal);
+	case CollisionShape::RECTANGLE:
+		return TimeOfImpact::SweepCircleBox(input.start, input.translation, input.radius, position,
+			glm::vec2(bodies.halfWidth[index], bodies.halfHeight[index]), fraction, normal);
+	case CollisionShape::NO_COLLIDER:
+		return false;
+	default:
+		break;
+	}
+
+	// The rest are the hull of their points grown by their radius. Coming from outside, the cast first
+	// touches one of the hull's edges grown by both radii
+	const ConvexShape& convex = bodies.convex[index];
+	if (convex.count == 1)
+	{
+		return TimeOfImpact::SweepCircleCircle(input.start, input.translation, input.radius, position + convex.vertices[0],
+			convex.radius, fraction, normal);
+	}
+
+	const glm::vec2 local_start = input.start - position;
+	if (convex.count > 2)
+	{
+		// From inside the hull an edge would be hit on the way out
+		int side = 0;
+		for (int i = 0; i < convex.count; i++)
+		{
+			const glm::vec2 edge = convex.vertices[(i + 1) % convex.count] - convex.vertices[i];
+			const glm::vec2 offset = local_start - convex.vertices[i];
+			side += (edge.x * offset.y - edge.y * offset.x > 0.0f) ? 1 : -1;
+		}
+		if (std::abs(side) == convex.count)
+		{
+			return false;
+		}
+	}
+
+	bool hit = false;
+	const float radius = input.radius + convex.radius;
+	const int edge_count = (convex.count == 2) ? 1 : convex.count;
+	for (int i = 0; i < edge_count; i++)
+	{
+		float edge_fraction;
+		glm::vec2 edge_normal;
+		if (TimeOfImpact::SweepCircleSegment(input.start, input.translation, radius, position + convex.vertices[i],
+			position + convex.vertices[(i + 1) % convex.count], edge_fraction, edge_normal) && (!hit || edge_fraction < fraction))
+		{
+			hit = true;
+			fraction = edge_fraction;
+			normal = edge_normal;
+		}
+	}
+
+	return hit;
+}
@@ -1,51 +1,332 @@
 #pragma once
 #ifndef __PHYSICS_ENGINE__
 #define __PHYSICS_ENGINE__
-#include "SDL.h"
 #include <vector>
-#include <iostream>
-#include <list>
-#include <sstream>
+#include <memory>
+#include <functional>
+#include <unordered_map>
 #include "RigidBody.h"
-#include "HalfPlane.h"
-#include "Label.h"
-#include "time.h"
-class GameObject;
+#include "RigidBodyDebug.h"
+#include "BodyStore.h"
+#include "Integrator.h"
+#include "Broadphase.h"
+#include "ContactManifold.h"
+#include "ContactEvent.h"
+#include "ContactSolver.h"
+#include "DynamicTree.h"
+#include "PhysicsProfiler.h"
+#include "RayCastHit.h"
+#include "RayCastInput.h"
+#include "StaticGeometry.h"
+#include "WorldSnapshot.h"
+#include "WorkerPool.h"
 
 class PhysicsEngine
 {
 public:
+	// Air friction is a per step factor tuned for steps of this length
+	static constexpr float FRICTION_DELTA_TIME = 0.016f;
+
+	// Gets every contact event of a frame at once, after the last step of the frame
+	typedef std::function<void(const std::vector<ContactEvent>&)> ContactListener;
+
+	PhysicsEngine();
+
+	// Runs as many fixed steps as the frame time covers, then writes positions interpolated between the
+	// last two steps to the Transforms so drawing is smooth whatever the frame rate
+	void Step(float frame_delta_time);
+
+	// One fixed step per call, tied to the frame rate like before the accumulator
 	void UpdatePhysics();
-	void ObjectHalfPlaneCollision(HalfPlane* halfplane);
 
 	void SetGravity(float g);
+	[[nodiscard]] float GetGravity() const;
+
+	// Air friction, the velocity factor of a FRICTION_DELTA_TIME long step
 	void SetFriction(float f);
+	[[nodiscard]] float GetFriction() const;
 	void SetOnSlingshot(bool on);
 	bool GetOnSlingshot();
 
+	// Planes and segments bodies collide with but never move, see StaticGeometry. Their contacts go through the
+	// solver and the contact events like any other, with an invalid handle for the static side
+	int AddStaticPlane(glm::vec2 point, glm::vec2 normal, float friction = 0.1f, float restitution = 0.9f);
+	int AddStaticSegment(glm::vec2 start, glm::vec2 end, float friction = 0.1f, float restitution = 0.9f);
+	void RemoveStaticShape(int id);
+	[[nodiscard]] const StaticGeometry& GetStaticGeometry() const;
+
+	// Moves a static plane, for planes that follow a HalfPlane's position and orientation
+	void SetStaticPlane(int id, glm::vec2 point, glm::vec2 normal);
+
+	// RigidBody::bodyType decides how the body is simulated. Static bodies are placed once, moving one means
+	// removing it and adding it again
 	void AddCircleObject(RigidBody* circle);
 	void AddRectangleObject(RigidBody* rectangle);
 
+	// Shapes the narrowphase collides with GJK and EPA, sized by the GameObject and turned by RigidBody::angle.
+	// Polygons are the convex hull of corners around the body position. The body is not added and false is
+	// returned if the hull is not 3 to ConvexShape::MAX_VERTICES corners, see ConvexShape::MakeHull
+	void AddLineObject(RigidBody* line);
+	void AddCapsuleObject(RigidBody* capsule);
+	bool AddPolygonObject(RigidBody* polygon, const std::vector<glm::vec2>& corners);
+
+	// Removing a body forgets it, snapshots that hold it no longer restore. Call it before the RigidBody is
+	// destroyed, whether or not the body is still simulated
 	void RemoveCircleObject(RigidBody* object);
 	void RemoveObject(RigidBody* object);
-	void CircleCircleCollision();
-	void AABBAABBCollision();
-	void CircleAABBCollision();
+
+	// Takes the body out of the simulation like RemoveObject, but snapshots that hold it still add it back, so
+	// the RigidBody has to live until RemoveObject is called
+	void DisableObject(RigidBody* object);
+
+	// Defaults to the widest SIMD kernel the CPU supports, unsupported types fall back to it
+	void SetIntegratorType(IntegratorType type);
+	[[nodiscard]] IntegratorType GetIntegratorType() const;
+
+	// Refreshes the proxy boxes and rebuilds the candidate pair list shared by the collision passes
+	void UpdateBroadphase();
+
+	// Switching the broadphase recreates the proxies of every body
+	void SetBroadphaseType(BroadphaseType type);
+	[[nodiscard]] BroadphaseType GetBroadphaseType() const;
+	void SetBroadphaseCellSize(float cell_size);
+
+	// Collides the candidate pairs on the worker threads, then matches the manifolds with last step's on
+	// the main thread so the solver can warm start. Step and UpdatePhysics write the results to the Transforms
+	void UpdateContacts();
+
+	// Listeners may add and remove bodies, the END events of removed bodies go out with the next frame
+	int AddContactListener(const ContactListener& listener);
+	void RemoveContactListener(int listener_id);
+
+	// Copies the bodies, the contacts with their warm start impulses and the stepping state. Restoring puts
+	// back exactly the world that was saved, stepping it again gives the same results. Bodies disabled since
+	// are added back and bodies added since are taken out like DisableObject does, handles taken before the
+	// restore stop resolving. Restoring fails without changing anything if a body of the snapshot was removed
+	// with RemoveObject since. Settings, static geometry and half planes are not part of the snapshot. Call
+	// between frames
+	void SaveSnapshot(WorldSnapshot& snapshot) const;
+	bool RestoreSnapshot(const WorldSnapshot& snapshot);
+
+	// First thing a circle moving from start by translation touches, as a fraction of the move and the normal
+	// pointing back at the circle. Static bodies and static geometry are always tested, the other bodies unless
+	// static_only. The ignored body is skipped along with whatever its collision filter rejects. Returns false
+	// if the way is clear. Boxes are hit at their bounding box, see SweepFastBodies
+	bool SweepCircle(glm::vec2 start, glm::vec2 translation, float radius, BodyHandle ignore, bool static_only,
+		float& fraction, glm::vec2& normal);
+
+	// Closest body or static shape the cast touches. Walks the broadphase and the static tree nearest first and
+	// skips whatever is behind the closest hit so far. Shapes the cast starts inside are not hit. Bodies added or
+	// moved with RigidBody::SetPosition since the last step are hit where they are now. Casts only read the
+	// world, any number of threads may cast while the engine is not stepping or changing bodies
+	bool RayCast(const RayCastInput& input, RayCastHit& hit) const;
+
+	// A ray max_distance long, hit.fraction is of max_distance
+	bool RayCast(glm::vec2 start, glm::vec2 direction, float max_distance, RayCastHit& hit, uint32_t mask = 0xFFFFFFFF) const;
+	bool SegmentCast(glm::vec2 start, glm::vec2 end, RayCastHit& hit, uint32_t mask = 0xFFFFFFFF) const;
+	bool CircleCast(glm::vec2 start, glm::vec2 translation, float radius, RayCastHit& hit, uint32_t mask = 0xFFFFFFFF) const;
+
+	// Casts every input, split across the worker threads when there are enough of them. hits[i] is the
+	// closest hit of inputs[i]
+	void RayCastBatch(const std::vector<RayCastInput>& inputs, std::vector<RayCastHit>& hits);
+
+	// Owner of a simulated body, nullptr once the body is removed
+	[[nodiscard]] RigidBody* GetRigidBody(BodyHandle handle) const;
+
+	[[nodiscard]] ContactSolver& GetSolver();
+	[[nodiscard]] const std::vector<ContactManifold>& GetManifolds() const;
+
+	// Contacts closer than this are handed to the solver before they touch
+	void SetContactMargin(float margin);
+
+	void SetFixedDeltaTime(float delta_time);
+	[[nodiscard]] float GetFixedDeltaTime() const;
+
+	// Every fixed step is split in this many integrate and collide passes
+	void SetSubsteps(int substeps);
+	[[nodiscard]] int GetSubsteps() const;
+
+	// Frame time past this many steps is dropped, so a slow frame cannot snowball into slower ones
+	void SetMaxStepsPerFrame(int max_steps);
+	[[nodiscard]] int GetMaxStepsPerFrame() const;
+
+	// Stepping statistics for the last frame
+	[[nodiscard]] int GetStepsLastFrame() const;
+	[[nodiscard]] int GetDroppedSteps() const;
+	[[nodiscard]] float GetInterpolationAlpha() const;
+
+	// Bodies slower than the sleep velocity for the given number of steps go to sleep, one contact
+	// connected island at a time. Turning sleeping off wakes everything
+	void SetSleepEnabled(bool enabled);
+	[[nodiscard]] bool IsSleepEnabled() const;
+	void SetSleepVelocity(float velocity);
+	void SetSleepSteps(int steps);
+
+	// Threads the narrowphase is split across, including the main thread. The contacts come out the same
+	// for every count
+	void SetThreadCount(int thread_count);
+	[[nodiscard]] int GetThreadCount() const;
+
+	[[nodiscard]] const BodyStore& GetBodies() const;
+
+	// Fills the debug table from the contacts of the last substep, one entry per dense body index. Only debug
+	// views call it, nothing is worked out while no one is looking
+	const std::vector<RigidBodyDebug>& UpdateDebugTable();
+
+	// Entry of a body in the table as of the last UpdateDebugTable, nullptr if it is not in it
+	[[nodiscard]] const RigidBodyDebug* GetDebug(BodyHandle handle) const;
+
+	// Per phase timings of the last steps while enabled, nothing is recorded in builds without PHYSICS_PROFILING
+	[[nodiscard]] PhysicsProfiler& GetProfiler();
+
+	// Broadphase statistics for the last step
+	[[nodiscard]] int GetBodyCount() const;
+	[[nodiscard]] int GetCandidatePairCount() const;
+	[[nodiscard]] int GetAllPairsCount() const;
+
+	// Contact statistics for the last step
+	[[nodiscard]] int GetManifoldCount() const;
+	[[nodiscard]] int GetWarmStartedCount() const;
+
+	// Events handed to the listeners last frame, and the PERSIST events left out since the engine was made
+	// because a frame already had CONTACT_EVENT_CAPACITY events
+	[[nodiscard]] int GetContactEventCount() const;
+	[[nodiscard]] int GetDroppedContactEventCount() const;
+
+	// Bodies stopped at their first impact by the continuous collision sweeps during the last step
+	[[nodiscard]] int GetTimeOfImpactCount() const;
+
+	// Sleep statistics for the last step, bodies without gravity are neither
+	[[nodiscard]] int GetAwakeBodyCount() const;
+	[[nodiscard]] int GetSleepingBodyCount() const;
 	
 private:
-	float MinimumTranslationVector1D(const float centerA, const float radiusA, const float centerB, const float radiusB);
+	static std::unique_ptr<Broadphase> CreateBroadphase(BroadphaseType type, float cell_size);
+	[[nodiscard]] AABB ComputeAABB(int index) const;
+	void AddBody(RigidBody* rb, CollisionShape shape, const ConvexShape& hull = ConvexShape());
+	void RemoveBody(RigidBody* rb);
+	void RegisterOwner(RigidBody* rb);
+	void ForgetOwner(const RigidBody* rb);
+	void AddProxy(int index);
+	void RemoveProxy(int index);
+	[[nodiscard]] int GetProxyBody(int proxy_id) const;
+	void SetProxyBody(int proxy_id, int index);
+	void RestoreProxies();
+	void Simulate(float delta_time);
+	// BEGIN and END go out the substep they happen, PERSIST once at the end of the step
+	void EmitContactEvents(bool end_of_step);
+	void PushContactEvent(ContactEventType type, const ContactManifold& manifold);
+	void DispatchContactEvents();
+	void CollidePairs();
+	void MergeContact(ContactManifold manifold, std::vector<ContactManifold>::const_iterator& previous);
+	void EndContact(const ContactManifold& manifold);
+	void SaveSweepStarts();
+	void SweepFastBodies();
+	bool SweepCircle(glm::vec2 start, glm::vec2 translation, float radius, int ignore, bool static_only,
+		float& fraction, glm::vec2& normal);
+	bool CastBody(int index, const RayCastInput& input, float& fraction, glm::vec2& normal) const;
+	void UpdateIslands();
+	void WakeAll();
+	[[nodiscard]] bool IsMoving(int index) const;
+	int FindIsland(int index);
+
+	BodyStore bodies;
+
+	// Every RigidBody added and not removed with RemoveObject since, by the slot snapshots name it with. The
+	// generation moves on when the slot is freed, so a snapshot never restores into whatever took the slot next
+	struct BodyOwner
+	{
+		RigidBody* body = nullptr;
+		uint32_t generation = 0;
+	};
+	std::vector<BodyOwner> owners;
+	std::vector<uint32_t> freeOwners;
+	std::unordered_map<const RigidBody*, uint32_t> ownerSlots;
+	std::vector<RigidBody*> restoredOwners;
+
+	std::unique_ptr<Broadphase> broadphase;
+	float broadphaseCellSize = 128.0f;
+
+	// Dense body index of every proxy, -1 once the body is removed
+	std::vector<int> proxyBodies;
+	std::vector<BroadphasePair> candidatePairs;
+
+	// Static bodies stay out of the broadphase, in a tree of their own that is never refit. Only dynamic bodies
+	// query it, so static bodies neither move a proxy every step nor pair up with each other. Their proxy ids
+	// are the tree's plus STATIC_PROXY_BASE, above every broadphase proxy and below the static geometry ones
+	DynamicTree staticTree;
+	std::vector<int> staticProxyBodies;
+	std::vector<BroadphasePair> staticPairs;
+	static constexpr int STATIC_PROXY_BASE = 1 << 29;
+
+	std::vector<ContactManifold> manifolds;
+	std::vector<ContactManifold> previousManifolds;
+
+	StaticGeometry staticGeometry;
+	std::vector<ContactManifold> staticContacts;
+	ContactSolver solver;
+	PhysicsProfiler profiler;
+	float contactMargin = 2.0f;
+	int warmStartedPoints = 0;
+
+	// Filled during the steps of a frame and swapped into the dispatch buffer before the listeners run
+	std::vector<ContactEvent> contactEvents;
+	std::vector<ContactEvent> dispatchedContactEvents;
+	std::vector<std::pair<int, ContactListener>> contactListeners;
+	int nextContactListenerId = 0;
+	int droppedContactEvents = 0;
+	static constexpr size_t CONTACT_EVENT_CAPACITY = 256;
+
+	// Bodies with continuous collision and where they started the substep
+	std::vector<int> sweptBodies;
+	std::vector<glm::vec2> sweepStarts;
+	std::vector<int> sweepCandidates;
+	int timeOfImpactCount = 0;
+
+	// Distance kept between a swept body and what it hits, inside the contact margin so the contact is made
+	// on the next substep
+	static constexpr float TIME_OF_IMPACT_GAP = 0.25f;
+
+	WorkerPool workers;
+	std::vector<std::vector<ContactManifold>> contactBuffers;
+
+	// Fewer candidate pairs than this are collided on the main thread, and no batch is smaller than this
+	static constexpr int PARALLEL_PAIR_COUNT = 512;
+	static constexpr int NARROWPHASE_BATCH_SIZE = 64;
+
+	// Same for batched casts
+	static constexpr int PARALLEL_CAST_COUNT = 64;
+	static constexpr int CAST_BATCH_SIZE = 16;
+
+	bool sleepEnabled = true;
+	float sleepVelocity = 8.0f;
+	int sleepSteps = 30;
+	int awakeBodies = 0;
+	int sleepingBodies = 0;
+
+	// Union find parent of every body and the lowest still step count of every island root
+	std::vector<int> islandParents;
+	std::vector<int> islandStillSteps;
+
+	// Cold side table of RigidBodyDebug, empty until a debug view asks for it
+	std::vector<RigidBodyDebug> debugTable;
+
+	IntegratorType integratorType = Integrator::GetBestType();
+
+	float gravity = 0.0f;
+	float airFriction = 1.0f;
+	float fixedDeltaTime = 0.016f;
+	int substeps = 1;
+	int maxStepsPerFrame = 5;
+	float accumulator = 0.0f;
+	int stepsLastFrame = 0;
+	int droppedSteps = 0;
+	float interpolationAlpha = 0.0f;
 
-	std::list<RigidBody*>physicsObjects;
-	std::list<RigidBody*>rectangles;
-	std::list<RigidBody*>circles;
 
-	float gravity;
-	float airFriction;
-	const float fixedDeltaTime = 0.016f;
+	// Longest frame fed to the accumulator, a breakpoint or a dragged window should not fast forward the game
+	static constexpr float MAX_FRAME_TIME = 0.25f;
 	bool onSlingshot = true;
-	bool Score = false;
-	static clock_t endTime;
-	static clock_t startTime;
 
 };
 
@@ -0,0 +1,185 @@
+#include "PhysicsProfiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const char* PHASE_NAMES[] = { "Broadphase", "Narrowphase", "Static Geometry", "Contact Matching",
+		"Integrate Velocities", "Solve Velocities", "Integrate Positions", "Time Of Impact", "Solve Positions", "Islands" };
+	const char* COUNTER_NAMES[] = { "Candidate Pairs", "Contacts", "Impulses", "Time Of Impacts" };
+
+	static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == PhysicsProfiler::PHASE_COUNT, "a phase has no name");
+	static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == PhysicsProfiler::COUNTER_COUNT, "a counter has no name");
+}
+
+PhysicsProfiler::Scope::Scope(PhysicsProfiler& profiler, const ProfilerPhase phase)
+	: m_profiler(profiler.m_inStep ? &profiler : nullptr), m_phase(phase)
+{
+	if (m_profiler != nullptr)
+	{
+		m_start = std::chrono::steady_clock::now();
+	}
+}
+
+PhysicsProfiler::Scope::~Scope()
+{
+	if (m_profiler != nullptr)
+	{
+		const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - m_start;
+		m_profiler->m_phaseTimes[static_cast<int>(m_phase)] += elapsed.count();
+	}
+}
+
+void PhysicsProfiler::SetEnabled(const bool enabled)
+{
+	if (enabled && !m_enabled)
+	{
+		Clear();
+	}
+
+	m_enabled = enabled;
+	m_inStep = m_inStep && enabled;
+}
+
+bool PhysicsProfiler::IsEnabled() const
+{
+	return m_enabled;
+}
+
+void PhysicsProfiler::Clear()
+{
+	m_next = 0;
+	m_sampleCount = 0;
+	for (auto& history : m_phaseHistory)
+	{
+		history.fill(0.0f);
+	}
+	for (auto& history : m_countHistory)
+	{
+		history.fill(0.0f);
+	}
+	m_stepHistory.fill(0.0f);
+}
+
+void PhysicsProfiler::BeginStep()
+{
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	m_inStep = true;
+	m_phaseTimes.fill(0.0f);
+	m_counts.fill(0.0f);
+}
+
+void PhysicsProfiler::AddCount(const ProfilerCounter counter, const int value)
+{
+	if (m_inStep)
+	{
+		m_counts[static_cast<int>(counter)] += static_cast<float>(value);
+	}
+}
+
+void PhysicsProfiler::EndStep()
+{
+	if (!m_inStep)
+	{
+		return;
+	}
+
+	m_inStep = false;
+
+	// The step time is the sum of the phases, the small gaps between them are not worth a clock read
+	float step_time = 0.0f;
+	for (int i = 0; i < PHASE_COUNT; i++)
+	{
+		m_phaseHistory[i][m_next] = m_phaseTimes[i];
+		step_time += m_phaseTimes[i];
+	}
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_countHistory[i][m_next] = m_counts[i];
+	}
+	m_stepHistory[m_next] = step_time;
+
+	m_next = (m_next + 1) % HISTORY_SIZE;
+	m_sampleCount = std::min(m_sampleCount + 1, HISTORY_SIZE);
+}
+
+int PhysicsProfiler::GetSampleCount() const
+{
+	return m_sampleCount;
+}
+
+int PhysicsProfiler::GetHistoryOffset() const
+{
+	return (m_sampleCount < HISTORY_SIZE) ? 0 : m_next;
+}
+
+const float* PhysicsProfiler::GetHistory(const ProfilerPhase phase) const
+{
+	return m_phaseHistory[static_cast<int>(phase)].data();
+}
+
+const float* PhysicsProfiler::GetHistory(const ProfilerCounter counter) const
+{
+	return m_countHistory[static_cast<int>(counter)].data();
+}
+
+const float* PhysicsProfiler::GetStepHistory() const
+{
+	return m_stepHistory.data();
+}
+
+PhysicsProfiler::Stats PhysicsProfiler::GetStats(const ProfilerPhase phase) const
+{
+	return ComputeStats(m_phaseHistory[static_cast<int>(phase)]);
+}
+
+PhysicsProfiler::Stats PhysicsProfiler::GetStats(const ProfilerCounter counter) const
+{
+	return ComputeStats(m_countHistory[static_cast<int>(counter)]);
+}
+
+PhysicsProfiler::Stats PhysicsProfiler::GetStepStats() const
+{
+	return ComputeStats(m_stepHistory);
+}
+
+const char* PhysicsProfiler::GetName(const ProfilerPhase phase)
+{
+	return PHASE_NAMES[static_cast<int>(phase)];
+}
+
+const char* PhysicsProfiler::GetName(const ProfilerCounter counter)
+{
+	return COUNTER_NAMES[static_cast<int>(counter)];
+}
+
+PhysicsProfiler::Stats PhysicsProfiler::ComputeStats(const std::array<float, HISTORY_SIZE>& history) const
+{
+	Stats stats;
+	if (m_sampleCount == 0)
+	{
+		return stats;
+	}
+
+	// Until the ring wraps the recorded steps are the first m_sampleCount entries
+	std::array<float, HISTORY_SIZE> sorted;
+	std::copy(history.begin(), history.begin() + m_sampleCount, sorted.begin());
+
+	float sum = 0.0f;
+	for (int i = 0; i < m_sampleCount; i++)
+	{
+		sum += sorted[i];
+	}
+
+	const int p99_index = std::min(m_sampleCount - 1, static_cast<int>(std::ceil(m_sampleCount * 0.99f)) - 1);
+	std::nth_element(sorted.begin(), sorted.begin() + p99_index, sorted.begin() + m_sampleCount);
+
+	stats.min = *std::min_element(sorted.begin(), sorted.begin() + m_sampleCount);
+	stats.average = sum / static_cast<float>(m_sampleCount);
+	stats.p99 = sorted[p99_index];
+	return stats;
+}
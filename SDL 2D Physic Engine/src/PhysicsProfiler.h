@@ -0,0 +1,112 @@
+#pragma once
+#ifndef __PHYSICS_PROFILER__
+#define __PHYSICS_PROFILER__
+#include <array>
+#include <chrono>
+#include "ProfilerCounter.h"
+#include "ProfilerPhase.h"
+
+// Release builds leave the timers out of the engine, define PHYSICS_PROFILING to 1 to keep them
+#ifndef PHYSICS_PROFILING
+#ifdef NDEBUG
+#define PHYSICS_PROFILING 0
+#else
+#define PHYSICS_PROFILING 1
+#endif
+#endif
+
+#if PHYSICS_PROFILING
+#define PHYSICS_PROFILE_SCOPE(profiler, phase) const PhysicsProfiler::Scope physics_profile_scope((profiler), (phase))
+#define PHYSICS_PROFILE_BEGIN_STEP(profiler) (profiler).BeginStep()
+#define PHYSICS_PROFILE_COUNT(profiler, counter, value) (profiler).AddCount((counter), (value))
+#define PHYSICS_PROFILE_END_STEP(profiler) (profiler).EndStep()
+#else
+#define PHYSICS_PROFILE_SCOPE(profiler, phase) ((void)0)
+#define PHYSICS_PROFILE_BEGIN_STEP(profiler) ((void)0)
+#define PHYSICS_PROFILE_COUNT(profiler, counter, value) ((void)sizeof(value))
+#define PHYSICS_PROFILE_END_STEP(profiler) ((void)0)
+#endif
+
+/*
+ * Time spent in each phase of a fixed step and the work it did, kept for the last HISTORY_SIZE steps in a
+ * ring per phase and per counter. Substeps add up into their step. The rings are laid out the way
+ * ImGui::PlotLines reads a ring, values plus the offset of the oldest one.
+ *
+ * Disabled, which is the default, a scope costs a branch and no clock read
+ */
+class PhysicsProfiler
+{
+public:
+	static constexpr int HISTORY_SIZE = 256;
+	static constexpr int PHASE_COUNT = static_cast<int>(ProfilerPhase::NUM_OF_TYPES);
+	static constexpr int COUNTER_COUNT = static_cast<int>(ProfilerCounter::NUM_OF_TYPES);
+
+	struct Stats
+	{
+		float min = 0.0f;
+		float average = 0.0f;
+		float p99 = 0.0f;
+	};
+
+	// Times one phase from construction to destruction, only on the thread stepping the engine
+	class Scope
+	{
+	public:
+		Scope(PhysicsProfiler& profiler, ProfilerPhase phase);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		PhysicsProfiler* m_profiler;
+		ProfilerPhase m_phase;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	// Turning the profiler off keeps the history, turning it back on starts over
+	void SetEnabled(bool enabled);
+	[[nodiscard]] bool IsEnabled() const;
+	void Clear();
+
+	void BeginStep();
+	void AddCount(ProfilerCounter counter, int value);
+	void EndStep();
+
+	// Steps recorded so far, at most HISTORY_SIZE
+	[[nodiscard]] int GetSampleCount() const;
+
+	// Index of the oldest step in the rings
+	[[nodiscard]] int GetHistoryOffset() const;
+
+	// Milliseconds and counts per step, HISTORY_SIZE long, steps not recorded yet are 0
+	[[nodiscard]] const float* GetHistory(ProfilerPhase phase) const;
+	[[nodiscard]] const float* GetHistory(ProfilerCounter counter) const;
+	[[nodiscard]] const float* GetStepHistory() const;
+
+	// Over the recorded steps
+	[[nodiscard]] Stats GetStats(ProfilerPhase phase) const;
+	[[nodiscard]] Stats GetStats(ProfilerCounter counter) const;
+	[[nodiscard]] Stats GetStepStats() const;
+
+	[[nodiscard]] static const char* GetName(ProfilerPhase phase);
+	[[nodiscard]] static const char* GetName(ProfilerCounter counter);
+
+private:
+	[[nodiscard]] Stats ComputeStats(const std::array<float, HISTORY_SIZE>& history) const;
+
+	bool m_enabled = false;
+	bool m_inStep = false;
+	int m_next = 0;
+	int m_sampleCount = 0;
+
+	// The step being recorded, copied into the rings by EndStep
+	std::array<float, PHASE_COUNT> m_phaseTimes{};
+	std::array<float, COUNTER_COUNT> m_counts{};
+
+	std::array<std::array<float, HISTORY_SIZE>, PHASE_COUNT> m_phaseHistory{};
+	std::array<std::array<float, HISTORY_SIZE>, COUNTER_COUNT> m_countHistory{};
+	std::array<float, HISTORY_SIZE> m_stepHistory{};
+};
+
+#endif /* defined (__PHYSICS_PROFILER__) */
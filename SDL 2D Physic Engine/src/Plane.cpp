@@ -18,8 +18,7 @@ Plane::Plane()
 
 	GetTransform()->position = glm::vec2(400.0f, 200.0f);
 	GetRigidBody()->velocity = glm::vec2(0.0f, 0.0f);
-	GetRigidBody()->acceleration = glm::vec2(0.0f, 0.0f);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 	SetType(GameObjectType::PLANE);
 
 	BuildAnimations();
@@ -2,11 +2,15 @@
 #include "Game.h"
 #include "EventManager.h"
 #include "InputType.h"
+#include <sstream>
+#include <chrono>
+#include <algorithm>
 
 // required for IMGUI
 #include "imgui.h"
 #include "imgui_sdl.h"
 #include "Renderer.h"
+#include "SpriteBatch.h"
 #include "Util.h"
 
 PlayScene::PlayScene()
@@ -15,7 +19,10 @@ PlayScene::PlayScene()
 }
 
 PlayScene::~PlayScene()
-= default;
+{
+	// The pooled children go back to m_blocks, which is gone by the time ~Scene runs
+	RemoveAllChildren();
+}
 
 void PlayScene::Draw()
 {
@@ -35,7 +42,29 @@ void PlayScene::Draw()
 		Util::DrawLine({ starting_point.x + 10, starting_point.y - 4 }, { m_pProjectile->GetTransform()->position.x, m_pProjectile->GetTransform()->position.y - 4 }, { 0.89,0.65,0,34 });
 	}
 
+	SpriteBatch::Instance().ResetStatistics();
 	DrawDisplayList();
+	m_spriteCount = SpriteBatch::Instance().GetSpriteCount();
+	m_spriteDrawCalls = SpriteBatch::Instance().GetDrawCallCount();
+
+	const auto particle_start = std::chrono::steady_clock::now();
+	m_chips.Draw();
+	m_puffs.Draw();
+	m_particleDrawMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - particle_start).count();
+
+	if (!m_trajectory.GetPoints().empty())
+	{
+		Util::DrawDots(m_trajectory.GetPoints(), 4.0f, { 1.0f, 1.0f, 1.0f, 0.8f });
+		if (m_trajectory.HasHit())
+		{
+			Util::DrawCircle(m_trajectory.GetHitPoint(), 6.0f, { 1.0f, 0.3f, 0.2f, 1.0f });
+		}
+	}
+
+	if (m_showForces)
+	{
+		DrawForces();
+	}
 	SDL_SetRenderDrawColor(Renderer::Instance().GetRenderer(), 255, 255, 255, 255);
 
 	if (physicsEngine->GetOnSlingshot() == true)
@@ -63,17 +92,19 @@ void PlayScene::Update()
 
 	physicsEngine->SetGravity(accelerationGravity);
 	physicsEngine->SetFriction(friction);
-	physicsEngine->UpdatePhysics();
-	physicsEngine->CircleCircleCollision();
-	physicsEngine->AABBAABBCollision();
-	physicsEngine->CircleAABBCollision();
+	physicsEngine->Step(Game::Instance().GetDeltaTime());
+
+	const auto particle_start = std::chrono::steady_clock::now();
+	m_chips.Update(Game::Instance().GetDeltaTime());
+	m_puffs.Update(Game::Instance().GetDeltaTime());
+	m_particleUpdateMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - particle_start).count();
 
 	m_playerSelected = (Util::Distance(EventManager::Instance().GetMousePosition(),
 		m_pProjectile->GetTransform()->position) < m_pProjectile->GetWidth()) ? true : false;
 
 	if (EventManager::Instance().GetMouseButton(0) && !EventManager::Instance().MouseReleased(1) && m_playerSelected)
 	{
-		m_pProjectile->GetTransform()->position = EventManager::Instance().GetMousePosition();
+		m_pProjectile->GetRigidBody()->SetPosition(EventManager::Instance().GetMousePosition());
 
 		auto distanceMouse = Util::Distance(EventManager::Instance().GetMousePosition(),
 			starting_point);
@@ -84,53 +115,37 @@ void PlayScene::Update()
 
 		if (distanceMouse > 75 && distanceBird >= 75)
 		{
-			m_pProjectile->GetTransform()->position = BirdPosPreviousFrame;
+			m_pProjectile->GetRigidBody()->SetPosition(BirdPosPreviousFrame);
 		}
 
 		BirdPosPreviousFrame = m_pProjectile->GetTransform()->position;
 	}
 	else if (!EventManager::Instance().GetMouseButton(0) && EventManager::Instance().MouseReleased(1))
 	{
-		glm::vec2 d = m_pProjectile->GetTransform()->position - starting_point;
+		const glm::vec2 launch_velocity = GetLaunchVelocity();
 
+		SaveGame(m_shotStart);
 		physicsEngine->SetOnSlingshot(false);
 
-		m_pProjectile->GetRigidBody()->velocity += (-d * slingShotPower) / m_pProjectile->GetRigidBody()->mass;
+		RigidBody* projectile_body = m_pProjectile->GetRigidBody();
+		projectile_body->SetVelocity(projectile_body->GetVelocity() + launch_velocity);
 	}
 
-	if (EventManager::Instance().MousePressed(3))
-	{
-		physicsEngine->SetOnSlingshot(true);
-		m_pProjectile->GetTransform()->position = starting_point;
-		m_pProjectile->GetRigidBody()->velocity = { 0,0 };
-		m_pProjectile->GetRigidBody()->isColliding = false;
-	}
-	
-	if (m_pSmallPig->GetRigidBody()->wasKilled)
+	m_trajectory.Clear();
+	if (m_showTrajectory && physicsEngine->GetOnSlingshot() && m_pProjectile->GetRigidBody()->GetPosition() != starting_point)
 	{
-		score += m_pSmallPig->GetPoints();
-		m_pSmallPig->GetRigidBody()->wasKilled = false;
-		physicsEngine->RemoveCircleObject(m_pSmallPig->GetRigidBody());
-		m_pSmallPig->SetEnabled(false);
-		m_pSmallRemoved = true;
+		const RigidBody* projectile_body = m_pProjectile->GetRigidBody();
+		const auto start = std::chrono::steady_clock::now();
+		m_trajectory.Predict(*physicsEngine, *projectile_body, projectile_body->GetVelocity() + GetLaunchVelocity());
+		m_trajectoryMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 	}
 
-	if (m_pMediumPig->GetRigidBody()->wasKilled)
-	{
-		score += m_pMediumPig->GetPoints();
-		m_pMediumPig->GetRigidBody()->wasKilled = false;
-		physicsEngine->RemoveCircleObject(m_pMediumPig->GetRigidBody());
-		m_pMediumPig->SetEnabled(false);
-		m_pMediumRemoved = true;
-	}
-
-	if (m_pBigPig->GetRigidBody()->wasKilled)
+	if (EventManager::Instance().MousePressed(3))
 	{
-		score += m_pBigPig->GetPoints();
-		m_pBigPig->GetRigidBody()->wasKilled = false;
-		physicsEngine->RemoveCircleObject(m_pBigPig->GetRigidBody());
-		m_pBigPig->SetEnabled(false);
-		m_pBigRemoved = true;
+		physicsEngine->SetOnSlingshot(true);
+		m_pProjectile->GetRigidBody()->SetPosition(starting_point);
+		m_pProjectile->GetRigidBody()->SetVelocity({ 0,0 });
+		m_pProjectile->SetColliding(false);
 	}
 
 
@@ -144,7 +159,7 @@ void PlayScene::Update()
 	m_pInstructionLabel->SetText(sst2.str());
 
 	std::stringstream sst3;
-	sst3 << "1 & 2 switch the bird.Space to reset the game";
+	sst3 << "1 & 2 switch the bird.Space to reset the game, U to undo the last shot";
 	m_pInstructionLabel2->SetText(sst3.str());
 
 
@@ -175,64 +190,35 @@ void PlayScene::GetKeyboardInput()
 
 	if (EventManager::Instance().IsKeyDown(SDL_SCANCODE_1))
 	{
-		if (!m_pBird->GetRigidBody()->isActive)
+		if (m_pProjectile != m_pBird)
 		{
 			m_pProjectile = m_pBird;
-			m_pProjectile->GetTransform()->position = starting_point;
-			m_pSquareBird->GetTransform()->position = idle_point;
-			m_pBird->GetRigidBody()->isActive = true;
-			m_pSquareBird->GetRigidBody()->isActive = false;
+			m_pProjectile->GetRigidBody()->SetPosition(starting_point);
+			m_pSquareBird->GetRigidBody()->SetPosition(idle_point);
 			physicsEngine->SetOnSlingshot(true);
 		}
 	}
 
 	if (EventManager::Instance().IsKeyDown(SDL_SCANCODE_2))
 	{
-		if (!m_pSquareBird->GetRigidBody()->isActive)
+		if (m_pProjectile != m_pSquareBird)
 		{
 			m_pProjectile = m_pSquareBird;
-			m_pProjectile->GetTransform()->position = starting_point;
-			m_pBird->GetTransform()->position = idle_point;
-			m_pSquareBird->GetRigidBody()->isActive = true;
-			m_pBird->GetRigidBody()->isActive = false;
+			m_pProjectile->GetRigidBody()->SetPosition(starting_point);
+			m_pBird->GetRigidBody()->SetPosition(idle_point);
 			physicsEngine->SetOnSlingshot(true);
 		}
 	}
 
 	if (EventManager::Instance().IsKeyDown(SDL_SCANCODE_SPACE))
 	{
-		score = 0;
-		if (m_pSmallRemoved)
-		{
-			m_pSmallRemoved = false;
-			m_pSmallPig->GetTransform()->position = { 580, 172 };
-			m_pSmallPig->SetEnabled(true);
-			physicsEngine->AddCircleObject(m_pSmallPig->GetRigidBody());
-		}
-
-		if (m_pMediumRemoved)
-		{
-			m_pMediumRemoved = false;
-			m_pMediumPig->GetTransform()->position = { 580, 450 };
-			m_pMediumPig->SetEnabled(true);
-			physicsEngine->AddCircleObject(m_pMediumPig->GetRigidBody());
-		}
-
-		if (m_pBigRemoved)
-		{
-			m_pBigRemoved = false;
-			m_pBigPig->GetTransform()->position = { 780, 444 };
-			m_pBigPig->SetEnabled(true);
-			physicsEngine->AddCircleObject(m_pBigPig->GetRigidBody());
-		}
+		LoadGame(m_levelStart);
+	}
 
-		m_pLongBlock->GetTransform()->position = { 573, 211 };
-		m_pBlock6->GetTransform()->position = { 696, 272 };
-		m_pBlock5->GetTransform()->position = { 696, 363 };
-		m_pBlock4->GetTransform()->position = { 696, 454 };
-		m_pBlock3->GetTransform()->position = { 450, 272 };
-		m_pBlock2->GetTransform()->position = { 450, 363 };
-		m_pBlock->GetTransform()->position = { 450, 454 };
+	// Back to the moment the last bird was released
+	if (EventManager::Instance().KeyPressed(SDL_SCANCODE_U) && !m_shotStart.world.IsEmpty())
+	{
+		LoadGame(m_shotStart);
 	}
 
 	if (EventManager::Instance().KeyPressed(SDL_SCANCODE_H))
@@ -264,6 +250,7 @@ void PlayScene::Start()
 	AddChild(m_pInstructionLabel2);
 
 	TextureManager::Instance().Load("../Assets/textures/background.png", "background");
+	TextureManager::Instance().Load("../Assets/textures/cloud.png", "cloud");
 
 	m_pBird = new Bird(45, 45);
 	m_pBird->GetTransform()->position = starting_point;
@@ -271,6 +258,7 @@ void PlayScene::Start()
 	m_pBird->GetRigidBody()->friction = 0.1;
 	m_pBird->GetRigidBody()->mass = 500.0;
 	m_pBird->GetRigidBody()->restitution = 0.9;
+	m_pBird->GetRigidBody()->continuousCollision = true;
 	AddChild(m_pBird);
 
 	m_pSquareBird = new SquareBird(50, 50);
@@ -279,6 +267,7 @@ void PlayScene::Start()
 	m_pSquareBird->GetRigidBody()->friction = 0.1;
 	m_pSquareBird->GetRigidBody()->mass = 700.0;
 	m_pSquareBird->GetRigidBody()->restitution = 0.9;
+	m_pSquareBird->GetRigidBody()->continuousCollision = true;
 	AddChild(m_pSquareBird);
 
 	m_pSmallPig = new SmallPig(48,48);
@@ -293,38 +282,39 @@ void PlayScene::Start()
 	m_pMediumPig->GetRigidBody()->restitution = 0.9;
 	AddChild(m_pMediumPig);
 
-	m_pBlock = new Block(55,90);
+	m_blocks.Reserve(MAX_DEBRIS + 6);
+	m_pBlock = m_blocks.Get(m_blocks.Create(55, 90));
 	m_pBlock->GetTransform()->position = { 450, 454 };
 	m_pBlock->GetRigidBody()->mass = 4000;
 	m_pBlock->GetRigidBody()->restitution = 0.9;
 	m_pBlock->GetRigidBody()->friction = 0.9;
 	AddChild(m_pBlock);
 
-	m_pBlock2 = new Block(55, 90);
+	m_pBlock2 = m_blocks.Get(m_blocks.Create(55, 90));
 	m_pBlock2->GetTransform()->position = { 450, 363 };
 	m_pBlock2->GetRigidBody()->mass = 4000;
 	m_pBlock2->GetRigidBody()->restitution = 0.9;
 	AddChild(m_pBlock2);
 
-	m_pBlock3 = new Block(55, 90);
+	m_pBlock3 = m_blocks.Get(m_blocks.Create(55, 90));
 	m_pBlock3->GetTransform()->position = { 450, 272 };
 	m_pBlock3->GetRigidBody()->mass = 4000;
 	m_pBlock3->GetRigidBody()->restitution = 0.9;
 	AddChild(m_pBlock3);
 
-	m_pBlock4 = new Block(55, 90);
+	m_pBlock4 = m_blocks.Get(m_blocks.Create(55, 90));
 	m_pBlock4->GetTransform()->position = { 696, 454 };
 	m_pBlock4->GetRigidBody()->mass = 4000;
 	m_pBlock4->GetRigidBody()->restitution = 0.9;
 	AddChild(m_pBlock4);
 
-	m_pBlock5 = new Block(55, 90);
+	m_pBlock5 = m_blocks.Get(m_blocks.Create(55, 90));
 	m_pBlock5->GetTransform()->position = { 696, 363 };
 	m_pBlock5->GetRigidBody()->mass = 4000;
 	m_pBlock5->GetRigidBody()->restitution = 0.9;
 	AddChild(m_pBlock5);
 
-	m_pBlock6 = new Block(55, 90);
+	m_pBlock6 = m_blocks.Get(m_blocks.Create(55, 90));
 	m_pBlock6->GetTransform()->position = { 696, 272 };
 	m_pBlock6->GetRigidBody()->mass = 4000;
 	m_pBlock6->GetRigidBody()->restitution = 0.9;
@@ -340,7 +330,7 @@ void PlayScene::Start()
 	m_pGround->GetTransform()->position = { 505, 565 };
 	m_pGround->GetRigidBody()->mass = 400;
 	m_pGround->GetRigidBody()->restitution = 0.9;
-	m_pGround->GetRigidBody()->enableGravity = false;
+	m_pGround->GetRigidBody()->bodyType = BodyType::STATIC;
 	AddChild(m_pGround);
 
 	m_pBigPig = new BigPig(98,98);
@@ -351,6 +341,7 @@ void PlayScene::Start()
 
 	// Add circle shaped objects
 	physicsEngine = new PhysicsEngine();
+	physicsEngine->AddContactListener([this](const std::vector<ContactEvent>& events) { OnContactEvents(events); });
 	physicsEngine->AddCircleObject(m_pBird->GetRigidBody());
 	physicsEngine->AddCircleObject(m_pSmallPig->GetRigidBody());
 	physicsEngine->AddCircleObject(m_pMediumPig->GetRigidBody());
@@ -368,12 +359,240 @@ void PlayScene::Start()
 	physicsEngine->AddRectangleObject(m_pGround->GetRigidBody());
 
 	m_pProjectile = m_pBird;
-	m_pBird->GetRigidBody()->isActive = true;
+
+	SaveGame(m_levelStart);
+
+	SetupParticles();
 
 	/* DO NOT REMOVE */
 	ImGuiWindowFrame::Instance().SetGuiFunction([this] { GUI_Function(); });
 }
 
+void PlayScene::OnContactEvents(const std::vector<ContactEvent>& events)
+{
+	for (const auto& event : events)
+	{
+		if (event.type == ContactEventType::END)
+		{
+			continue;
+		}
+
+		// Static planes and segments have no body, only removed bodies are skipped
+		RigidBody* bodies_in_contact[2] = { physicsEngine->GetRigidBody(event.bodyA), physicsEngine->GetRigidBody(event.bodyB) };
+		const bool static_contact = !event.bodyB.IsValid();
+		if (bodies_in_contact[0] == nullptr || (bodies_in_contact[1] == nullptr && !static_contact))
+		{
+			continue;
+		}
+
+		// Moving blocks chip where they are hit hard, the ground does not
+		if (event.type == ContactEventType::BEGIN && event.impactImpulse >= CHIP_THRESHOLD)
+		{
+			for (const RigidBody* block : bodies_in_contact)
+			{
+				if (block != nullptr && block->bodyType == BodyType::DYNAMIC && block->gameObject->GetType() == GameObjectType::OBSTACLE)
+				{
+					const int chips = std::min(MAX_CHIPS_PER_HIT, static_cast<int>(event.impactImpulse / CHIP_IMPULSE));
+					m_chips.Burst(block->GetPosition(), chips, block->GetVelocity() * 0.5f);
+				}
+			}
+		}
+
+		for (int i = 0; i < 2; i++)
+		{
+			RigidBody* pig = bodies_in_contact[i];
+			const RigidBody* other = bodies_in_contact[1 - i];
+
+			if (pig == nullptr || pig->gameObject->GetType() != GameObjectType::PIG)
+			{
+				continue;
+			}
+
+			// Blocks, the ground and static geometry have to hit ten times harder than a bird or another pig
+			float threshold = PIG_TOUGHNESS;
+			if (other == nullptr || (other->shape == CollisionShape::RECTANGLE && other->gameObject->GetType() != GameObjectType::PLAYER))
+			{
+				threshold *= 10.0f;
+			}
+
+			// Later events of a killed pig no longer resolve to its body and are skipped above
+			if (event.impactImpulse >= threshold)
+			{
+				KillPig(pig->gameObject);
+			}
+		}
+	}
+}
+
+void PlayScene::SaveGame(SavedGame& saved) const
+{
+	physicsEngine->SaveSnapshot(saved.world);
+	saved.score = score;
+	saved.pigsRemoved[0] = m_pSmallRemoved;
+	saved.pigsRemoved[1] = m_pMediumRemoved;
+	saved.pigsRemoved[2] = m_pBigRemoved;
+	saved.squareBirdActive = m_pProjectile == m_pSquareBird;
+}
+
+void PlayScene::LoadGame(const SavedGame& saved)
+{
+	// The snapshot adds the pigs killed since back to the physics, the scene only has to show them again
+	if (!physicsEngine->RestoreSnapshot(saved.world))
+	{
+		return;
+	}
+
+	score = saved.score;
+
+	GameObject* pigs[3] = { m_pSmallPig, m_pMediumPig, m_pBigPig };
+	bool* removed[3] = { &m_pSmallRemoved, &m_pMediumRemoved, &m_pBigRemoved };
+	for (int i = 0; i < 3; i++)
+	{
+		*removed[i] = saved.pigsRemoved[i];
+		pigs[i]->SetEnabled(!saved.pigsRemoved[i]);
+	}
+
+	m_pProjectile = saved.squareBirdActive ? static_cast<GameObject*>(m_pSquareBird) : m_pBird;
+
+	// Debris dropped after the save is no longer simulated, despawn it too. A shot snapshot that still holds it
+	// no longer restores
+	for (const auto handle : m_debris)
+	{
+		Block* debris = m_blocks.Get(handle);
+		if (debris != nullptr && !debris->GetRigidBody()->IsSimulated())
+		{
+			physicsEngine->RemoveObject(debris->GetRigidBody());
+			RemoveChild(debris);
+		}
+	}
+	m_debris.erase(std::remove_if(m_debris.begin(), m_debris.end(), [this](const ObjectHandle<Block> handle)
+	{
+		return m_blocks.Get(handle) == nullptr;
+	}), m_debris.end());
+}
+
+void PlayScene::SpawnDebris(const int count)
+{
+	std::uniform_real_distribution<float> x(300.0f, 900.0f);
+	std::uniform_real_distribution<float> y(-600.0f, 100.0f);
+
+	const int spawn_count = std::min(count, MAX_DEBRIS - static_cast<int>(m_debris.size()));
+	for (int i = 0; i < spawn_count; i++)
+	{
+		const ObjectHandle<Block> handle = m_blocks.Create(DEBRIS_SIZE, DEBRIS_SIZE);
+		Block* debris = m_blocks.Get(handle);
+		debris->GetTransform()->position = { x(m_debrisRandom), y(m_debrisRandom) };
+		debris->GetRigidBody()->mass = 200;
+		debris->GetRigidBody()->restitution = 0.2;
+		debris->GetRigidBody()->friction = 0.6;
+		AddChild(debris);
+		physicsEngine->AddRectangleObject(debris->GetRigidBody());
+		m_debris.push_back(handle);
+	}
+}
+
+void PlayScene::ClearDebris()
+{
+	for (const auto handle : m_debris)
+	{
+		if (Block* debris = m_blocks.Get(handle))
+		{
+			physicsEngine->RemoveObject(debris->GetRigidBody());
+			RemoveChild(debris);
+		}
+	}
+	m_debris.clear();
+}
+
+void PlayScene::SetupParticles()
+{
+	// Gravity pulls down the screen, against the sign of the physics setting
+	ParticleEmitter::Settings chips;
+	chips.textureId = "Block";
+	chips.minSpeed = 80.0f;
+	chips.maxSpeed = 360.0f;
+	chips.minLifetime = 0.6f;
+	chips.maxLifetime = 1.4f;
+	chips.minSize = 3.0f;
+	chips.maxSize = 7.0f;
+	chips.gravity = glm::vec2(0.0f, -accelerationGravity);
+	chips.drag = 0.5f;
+	m_chips.SetSettings(chips);
+
+	ParticleEmitter::Settings puffs;
+	puffs.textureId = "cloud";
+	puffs.colour = glm::vec4(0.6f, 0.9f, 0.4f, 0.8f);
+	puffs.minSpeed = 20.0f;
+	puffs.maxSpeed = 90.0f;
+	puffs.minLifetime = 0.5f;
+	puffs.maxLifetime = 1.0f;
+	puffs.minSize = 12.0f;
+	puffs.maxSize = 28.0f;
+	puffs.gravity = glm::vec2(0.0f, -30.0f);
+	puffs.drag = 0.2f;
+	puffs.growth = 40.0f;
+	m_puffs.SetSettings(puffs);
+}
+
+void PlayScene::DrawForces()
+{
+	const std::vector<RigidBodyDebug>& debug_table = physicsEngine->UpdateDebugTable();
+	const BodyStore& bodies = physicsEngine->GetBodies();
+
+	for (int i = 0; i < static_cast<int>(debug_table.size()); i++)
+	{
+		if (bodies.IsStatic(i))
+		{
+			continue;
+		}
+
+		const RigidBodyDebug& debug = debug_table[i];
+		const glm::vec2 position = bodies.transform[i]->position;
+		const float scale = FORCE_RENDER_SCALE * bodies.inverseMass[i];
+		Util::DrawLine(position, position + debug.fGravity * scale, { 0.2f, 0.4f, 1.0f, 1.0f });
+		if (debug.contactCount > 0)
+		{
+			Util::DrawLine(position, position + debug.fParallelGravity * scale, { 0.6f, 0.2f, 1.0f, 1.0f });
+			Util::DrawLine(position, position + debug.fNormal * scale, { 0.0f, 1.0f, 0.0f, 1.0f });
+			Util::DrawLine(position, position + debug.fFriction * scale, { 1.0f, 0.2f, 0.2f, 1.0f });
+		}
+	}
+}
+
+void PlayScene::KillPig(GameObject* pig)
+{
+	if (pig == m_pSmallPig)
+	{
+		score += m_pSmallPig->GetPoints();
+		m_pSmallRemoved = true;
+	}
+	else if (pig == m_pMediumPig)
+	{
+		score += m_pMediumPig->GetPoints();
+		m_pMediumRemoved = true;
+	}
+	else if (pig == m_pBigPig)
+	{
+		score += m_pBigPig->GetPoints();
+		m_pBigRemoved = true;
+	}
+
+	physicsEngine->DisableObject(pig->GetRigidBody());
+	PopPig(pig);
+	pig->SetEnabled(false);
+}
+
+void PlayScene::PopPig(GameObject* pig)
+{
+	m_puffs.Burst(pig->GetTransform()->position, PUFFS_PER_PIG);
+}
+
+glm::vec2 PlayScene::GetLaunchVelocity() const
+{
+	const RigidBody* projectile_body = m_pProjectile->GetRigidBody();
+	return -(projectile_body->GetPosition() - starting_point) * slingShotPower / projectile_body->GetMass();
+}
+
 void PlayScene::GUI_Function()
 {
 	// Always open with a NewFrame
@@ -406,15 +625,70 @@ void PlayScene::GUI_Function()
 
 	ImGui::Separator();
 
-	ImGui::SliderFloat("Mass 1", &m_pBird->GetRigidBody()->mass, 1.0f, 1000.0f);
+	float bird_mass = m_pBird->GetRigidBody()->GetMass();
+	if (ImGui::SliderFloat("Mass 1", &bird_mass, 1.0f, 1000.0f))
+	{
+		m_pBird->GetRigidBody()->SetMass(bird_mass);
+	}
 
 	ImGui::Separator();
 
-	ImGui::SliderFloat("Sling Shot Power", &slingShotPower, 0, 1000);
+	ImGui::SliderFloat("Sling Shot Power", &slingShotPower, 0, 40000);
+
+	ImGui::Checkbox("Trajectory Preview", &m_showTrajectory);
+	bool static_only = m_trajectory.IsStaticOnly();
+	if (ImGui::Checkbox("Preview Static Only", &static_only))
+	{
+		m_trajectory.SetStaticOnly(static_only);
+	}
+	int step_count = m_trajectory.GetStepCount();
+	if (ImGui::SliderInt("Preview Steps", &step_count, 10, 600))
+	{
+		m_trajectory.SetStepCount(step_count);
+	}
+	ImGui::Text("Preview: %.3f ms", m_trajectoryMilliseconds);
 
 	ImGui::Separator();
 
-	ImGui::SliderFloat("Bounciness 1", &m_pBird->GetRigidBody()->restitution, 0.01f, 0.99f);
+	ImGui::Text("Particles: %d  update %.3f ms  draw %.3f ms", m_chips.GetCount() + m_puffs.GetCount(),
+		m_particleUpdateMilliseconds, m_particleDrawMilliseconds);
+	if (ImGui::Button("Particle Stress Test"))
+	{
+		m_chips.Burst(glm::vec2(Config::SCREEN_WIDTH * 0.5f, Config::SCREEN_HEIGHT * 0.5f), STRESS_PARTICLE_COUNT);
+	}
+
+	ImGui::Separator();
+
+	ImGui::Checkbox("Force Vectors", &m_showForces);
+
+	bool batch_sprites = SpriteBatch::Instance().IsEnabled();
+	if (ImGui::Checkbox("Batch Sprites", &batch_sprites))
+	{
+		SpriteBatch::Instance().SetEnabled(batch_sprites);
+	}
+	ImGui::Text("Sprites: %d in %d draw calls", m_spriteCount, m_spriteDrawCalls);
+
+	ImGui::Separator();
+
+	ImGui::SliderInt("Debris Count", &m_debrisDropCount, 1, 1000);
+	if (ImGui::Button("Drop Debris"))
+	{
+		SpawnDebris(m_debrisDropCount);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Clear Debris"))
+	{
+		ClearDebris();
+	}
+	ImGui::Text("Debris: %d  pooled blocks %d / %d", static_cast<int>(m_debris.size()), m_blocks.GetCount(), m_blocks.GetCapacity());
+
+	ImGui::Separator();
+
+	float bird_restitution = m_pBird->GetRigidBody()->GetRestitution();
+	if (ImGui::SliderFloat("Bounciness 1", &bird_restitution, 0.01f, 0.99f))
+	{
+		m_pBird->GetRigidBody()->SetRestitution(bird_restitution);
+	}
 
 	ImGui::Separator();
 
@@ -423,6 +697,74 @@ void PlayScene::GUI_Function()
 	ImGui::Separator();
 
 	ImGui::SliderFloat("Air - Friction", &friction, 0.9f, 1.0f);
+
+	ImGui::Separator();
+
+	int substeps = physicsEngine->GetSubsteps();
+	if (ImGui::SliderInt("Substeps", &substeps, 1, 8))
+	{
+		physicsEngine->SetSubsteps(substeps);
+	}
+
+	ImGui::Text("Steps This Frame: %d (dropped: %d, alpha: %.2f)", physicsEngine->GetStepsLastFrame(),
+		physicsEngine->GetDroppedSteps(), physicsEngine->GetInterpolationAlpha());
+
+	ImGui::Separator();
+
+	int velocity_iterations = physicsEngine->GetSolver().GetVelocityIterations();
+	if (ImGui::SliderInt("Velocity Iterations", &velocity_iterations, 1, 20))
+	{
+		physicsEngine->GetSolver().SetVelocityIterations(velocity_iterations);
+	}
+
+	bool warm_starting = physicsEngine->GetSolver().IsWarmStarting();
+	if (ImGui::Checkbox("Warm Starting", &warm_starting))
+	{
+		physicsEngine->GetSolver().SetWarmStarting(warm_starting);
+	}
+
+	int thread_count = physicsEngine->GetThreadCount();
+	if (ImGui::SliderInt("Narrowphase Threads", &thread_count, 1, 16))
+	{
+		physicsEngine->SetThreadCount(thread_count);
+	}
+
+	ImGui::Text("Contacts: %d (warm started: %d)", physicsEngine->GetManifoldCount(), physicsEngine->GetWarmStartedCount());
+	ImGui::Text("Continuous Collision Hits: %d", physicsEngine->GetTimeOfImpactCount());
+	ImGui::Text("Contact Events: %d (dropped: %d)", physicsEngine->GetContactEventCount(), physicsEngine->GetDroppedContactEventCount());
+
+	bool sleep_enabled = physicsEngine->IsSleepEnabled();
+	if (ImGui::Checkbox("Sleeping", &sleep_enabled))
+	{
+		physicsEngine->SetSleepEnabled(sleep_enabled);
+	}
+
+	ImGui::Text("Awake Bodies: %d (sleeping: %d)", physicsEngine->GetAwakeBodyCount(), physicsEngine->GetSleepingBodyCount());
+
+	ImGui::Separator();
+
+	static const char* broadphase_names[] = { "All Pairs", "Spatial Hash", "Dynamic Tree", "Sweep and Prune" };
+	int broadphase_index = static_cast<int>(physicsEngine->GetBroadphaseType());
+	if (ImGui::Combo("Broadphase", &broadphase_index, broadphase_names, IM_ARRAYSIZE(broadphase_names)))
+	{
+		physicsEngine->SetBroadphaseType(static_cast<BroadphaseType>(broadphase_index));
+	}
+
+	static const char* integrator_names[] = { "Scalar", "SSE", "AVX" };
+	int integrator_index = static_cast<int>(physicsEngine->GetIntegratorType());
+	if (ImGui::Combo("Integrator", &integrator_index, integrator_names, IM_ARRAYSIZE(integrator_names)))
+	{
+		physicsEngine->SetIntegratorType(static_cast<IntegratorType>(integrator_index));
+	}
+
+	ImGui::Text("Bodies: %d", physicsEngine->GetBodyCount());
+	ImGui::Text("Candidate Pairs: %d (all pairs: %d)", physicsEngine->GetCandidatePairCount(), physicsEngine->GetAllPairsCount());
+
+	ImGui::Separator();
+
+	ImGui::Checkbox("Physics Profiler", &m_showProfiler);
 	
 	ImGui::End();
+
+	ImGuiWindowFrame::Instance().PhysicsProfilerPanel(physicsEngine->GetProfiler(), &m_showProfiler);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #define __PLAY_SCENE__
 
 #include <iostream>
+#include <random>
 #include "Scene.h"
 #include "Plane.h"
 #include "Bird.h"
@@ -18,6 +19,9 @@
 #include "BigBlock.h"
 #include "LongBlock.h"
 #include "Ground.h"
+#include "TrajectoryPredictor.h"
+#include "ParticleEmitter.h"
+#include "ObjectPool.h"
 
 const float DELTA_TIME = 1.0 / 60.0f;
 
@@ -65,9 +69,39 @@ private:
 	Label* m_pScoreLabel = nullptr;
 	Label* m_pInstructionLabel = nullptr;
 	Label* m_pInstructionLabel2 = nullptr;
-	int score;
+	int score = 0;
 	void GetKeyboardInput();
 
+	// Kills the pigs hit harder than their toughness
+	void OnContactEvents(const std::vector<ContactEvent>& events);
+
+	// The physics and the game state that goes with it, for resetting the level and undoing a shot
+	struct SavedGame
+	{
+		WorldSnapshot world;
+		int score = 0;
+		bool pigsRemoved[3] = { false, false, false };
+		bool squareBirdActive = false;
+	};
+	void SaveGame(SavedGame& saved) const;
+	void LoadGame(const SavedGame& saved);
+
+	// What the slingshot adds to the projectile's velocity if it is let go now
+	[[nodiscard]] glm::vec2 GetLaunchVelocity() const;
+
+	void SetupParticles();
+	// Scores the pig, takes it out of the physics and leaves a puff where it was
+	void KillPig(GameObject* pig);
+	void PopPig(GameObject* pig);
+	void DrawForces();
+
+	// Loose blocks dropped over the level, they stay until cleared or until a load goes back past them
+	void SpawnDebris(int count);
+	void ClearDebris();
+
+	SavedGame m_levelStart;
+	SavedGame m_shotStart;
+
 	float startingY = 250;
 	float lunchAngle = 45;
 	float lunchSpeed = 1200;
@@ -98,6 +132,44 @@ private:
 	glm::vec2 normal = { 0.0f, -1.0f };
 	bool m_pDrawHalfplane = false;
 	bool m_pItIsDrew = false;
+
+	bool m_showProfiler = false;
+
+	// The arc the projectile would fly while it is pulled back
+	TrajectoryPredictor m_trajectory;
+	bool m_showTrajectory = true;
+	float m_trajectoryMilliseconds = 0.0f;
+
+	// Chips off blocks that are hit hard, one chip per CHIP_IMPULSE of the impact, and the puff a popped pig leaves
+	ParticleEmitter m_chips;
+	ParticleEmitter m_puffs{ 4096 };
+	static constexpr float CHIP_THRESHOLD = 20000.0f;
+	static constexpr float CHIP_IMPULSE = 200.0f;
+	static constexpr int MAX_CHIPS_PER_HIT = 1000;
+	static constexpr int PUFFS_PER_PIG = 40;
+
+	// Impact impulse a bird or another pig needs to kill a pig
+	static constexpr float PIG_TOUGHNESS = 20000.0f;
+	static constexpr int STRESS_PARTICLE_COUNT = 50000;
+	float m_particleUpdateMilliseconds = 0.0f;
+	float m_particleDrawMilliseconds = 0.0f;
+
+	// Gravity, contact and friction forces on every body, as the acceleration they cause scaled to pixels
+	bool m_showForces = false;
+	static constexpr float FORCE_RENDER_SCALE = 0.05f;
+
+	// Sprites the display list drew last frame and the draw calls they took
+	int m_spriteCount = 0;
+	int m_spriteDrawCalls = 0;
+
+	// Every block comes from the pool, the level's and the debris, so dropping and clearing debris does not
+	// allocate once the pool has grown to MAX_DEBRIS
+	ObjectPool<Block> m_blocks;
+	std::vector<ObjectHandle<Block>> m_debris;
+	std::mt19937 m_debrisRandom{ 7 };
+	int m_debrisDropCount = 200;
+	static constexpr int MAX_DEBRIS = 4096;
+	static constexpr int DEBRIS_SIZE = 18;
 };
 
 #endif /* defined (__PLAY_SCENE__) */
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+#ifndef __PROFILER_COUNTER__
+#define __PROFILER_COUNTER__
+enum class ProfilerCounter {
+	CANDIDATE_PAIRS,
+	CONTACTS,
+	IMPULSES,
+	TIME_OF_IMPACTS,
+	NUM_OF_TYPES
+};
+#endif /* defined (__PROFILER_COUNTER__) */
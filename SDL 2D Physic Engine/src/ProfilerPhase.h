@@ -0,0 +1,17 @@
+#pragma once
+#ifndef __PROFILER_PHASE__
+#define __PROFILER_PHASE__
+enum class ProfilerPhase {
+	BROADPHASE,
+	NARROWPHASE,
+	STATIC_GEOMETRY,
+	CONTACT_MATCHING,
+	INTEGRATE_VELOCITIES,
+	SOLVE_VELOCITIES,
+	INTEGRATE_POSITIONS,
+	TIME_OF_IMPACT,
+	SOLVE_POSITIONS,
+	ISLANDS,
+	NUM_OF_TYPES
+};
+#endif /* defined (__PROFILER_PHASE__) */
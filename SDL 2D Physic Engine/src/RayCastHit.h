@@ -0,0 +1,25 @@
+#pragma once
+#ifndef __RAY_CAST_HIT__
+#define __RAY_CAST_HIT__
+#include <glm/vec2.hpp>
+#include "BodyHandle.h"
+
+/*
+ * Closest thing a cast touched. Static planes and segments have no body, the id of the shape is in
+ * staticShape instead
+ */
+struct RayCastHit
+{
+	bool hit = false;
+	BodyHandle body;
+	int staticShape = -1;
+
+	// Where the cast touches the surface, the normal points from the surface back at the cast
+	glm::vec2 point = glm::vec2(0, 0);
+	glm::vec2 normal = glm::vec2(0, 0);
+
+	// Of the translation, the cast circle is centered at start + translation * fraction
+	float fraction = 1.0f;
+};
+
+#endif /* defined (__RAY_CAST_HIT__) */
@@ -0,0 +1,17 @@
+#pragma once
+#ifndef __RAY_CAST_INPUT__
+#define __RAY_CAST_INPUT__
+#include <cstdint>
+#include <glm/vec2.hpp>
+
+// A circle moving from start by translation, a radius of 0 makes it a ray or segment. Only bodies whose
+// collision layer is in mask are hit, StaticGeometry::LAYER stands for the static planes and segments
+struct RayCastInput
+{
+	glm::vec2 start = glm::vec2(0, 0);
+	glm::vec2 translation = glm::vec2(0, 0);
+	float radius = 0.0f;
+	uint32_t mask = 0xFFFFFFFF;
+};
+
+#endif /* defined (__RAY_CAST_INPUT__) */
@@ -0,0 +1,112 @@
+#include "RigidBody.h"
+#include <cstddef>
+#include "BodyStore.h"
+#include "GameObject.h"
+
+// The layout the comment in RigidBody.h describes
+static_assert(sizeof(void*) != 8 || offsetof(RigidBody, shape) == 48, "RigidBody layout changed, update RigidBody.h");
+static_assert(sizeof(void*) != 8 || offsetof(RigidBody, enableGravity) == 68, "RigidBody layout changed, update RigidBody.h");
+static_assert(sizeof(void*) != 8 || offsetof(RigidBody, handle) == 72, "RigidBody layout changed, update RigidBody.h");
+static_assert(sizeof(RigidBody) == offsetof(RigidBody, store) + sizeof(BodyStore*), "RigidBody layout changed, update RigidBody.h");
+
+bool RigidBody::IsSimulated() const
+{
+	return store != nullptr && store->IsValid(handle);
+}
+
+bool RigidBody::IsAwake() const
+{
+	return !IsSimulated() || store->IsAwake(store->GetIndex(handle));
+}
+
+void RigidBody::Wake()
+{
+	if (IsSimulated())
+	{
+		store->Wake(store->GetIndex(handle));
+	}
+}
+
+glm::vec2 RigidBody::GetPosition() const
+{
+	if (IsSimulated())
+	{
+		return store->GetPosition(store->GetIndex(handle));
+	}
+	return gameObject->GetTransform()->position;
+}
+
+void RigidBody::SetPosition(const glm::vec2 position)
+{
+	if (IsSimulated())
+	{
+		store->Teleport(store->GetIndex(handle), position);
+		Wake();
+	}
+	gameObject->GetTransform()->position = position;
+}
+
+glm::vec2 RigidBody::GetVelocity() const
+{
+	if (IsSimulated())
+	{
+		return store->GetVelocity(store->GetIndex(handle));
+	}
+	return velocity;
+}
+
+void RigidBody::SetVelocity(const glm::vec2 new_velocity)
+{
+	if (IsSimulated())
+	{
+		store->SetVelocity(store->GetIndex(handle), new_velocity);
+		Wake();
+	}
+	velocity = new_velocity;
+}
+
+float RigidBody::GetMass() const
+{
+	if (IsSimulated())
+	{
+		return store->mass[store->GetIndex(handle)];
+	}
+	return mass;
+}
+
+void RigidBody::SetMass(const float new_mass)
+{
+	if (IsSimulated())
+	{
+		store->SetMass(store->GetIndex(handle), new_mass);
+	}
+	mass = new_mass;
+}
+
+float RigidBody::GetRestitution() const
+{
+	if (IsSimulated())
+	{
+		return store->restitution[store->GetIndex(handle)];
+	}
+	return restitution;
+}
+
+void RigidBody::SetRestitution(const float new_restitution)
+{
+	if (IsSimulated())
+	{
+		store->restitution[store->GetIndex(handle)] = new_restitution;
+	}
+	restitution = new_restitution;
+}
+
+void RigidBody::SetCollisionFilter(const uint32_t layer, const uint32_t mask)
+{
+	if (IsSimulated())
+	{
+		store->SetCollisionFilter(store->GetIndex(handle), layer, mask);
+	}
+	collisionLayer = layer;
+	collisionMask = mask;
+}
@@ -1,39 +1,82 @@
 #pragma once
 #ifndef __RIGID_BODY__
 #define __RIGID_BODY__
+#include <cstdint>
 #include <glm/vec2.hpp>
+#include "BodyHandle.h"
+#include "BodyType.h"
+#include "CollisionShape.h"
 
 class GameObject;
 class Label;
+class BodyStore;
 
+/*
+ * The fields are the definition of the body. Once it is added to the PhysicsEngine the BodyStore holds the
+ * live state and the fields are only refreshed when the body is removed, so position, velocity and mass
+ * have to go through the accessors below while the body is simulated.
+ *
+ * The step never touches a RigidBody, so the struct only has to stay small inside its GameObject. On 64 bit
+ * builds it is 88 bytes and 8 byte aligned, BodyStore::Add copies the first 70 and the handle and store
+ * pointer start at byte 72. Gameplay state lives in the GameObject and the game scenes, debug forces in
+ * RigidBodyDebug and polygon corners are handed to PhysicsEngine::AddPolygonObject. RigidBody.cpp checks the
+ * offsets
+ */
 struct RigidBody
 {
-	int score = 0;
+	// Read by BodyStore::Add, the ones the body can change while simulated are written back by Remove.
+	// PhysicsEngine::AddBody sets shape from the Add function it was called through
 	GameObject* gameObject = nullptr;
+	glm::vec2 velocity = glm::vec2(0, 0);
+	glm::vec2 netForce = glm::vec2(0, 0);
+	glm::vec2 gravityScale = { 0,-1 };
 	float mass = 100.0f;
-	glm::vec2 velocity = glm::vec2(0,0);
-	glm::vec2 acceleration = glm::vec2(0, 0);
-	bool isColliding = false;
-
-	// Collision Detection
 	float radius = 15.0f;
-	double time = 0;
-
-	// Lab 9
-	glm::vec2 fFriction;
-	glm::vec2 fNormal;
-	glm::vec2 fPerpendicularGravity;
-	glm::vec2 fParallelGravity;
-
-	glm::vec2 netForce;
-	glm::vec2 gravityScale = { 0,-1 };
 	float friction = 0.1;
 	float restitution = 0.9;
-	float toughness = 20000;
+	CollisionShape shape = CollisionShape::NO_COLLIDER;
+
+	// Dynamic bodies fall and get pushed around. Kinematic ones move by their velocity alone and push
+	// dynamic bodies without being pushed back. Static ones never move, they are kept apart from the
+	// broadphase and only dynamic bodies are tested against them
+	BodyType bodyType = BodyType::DYNAMIC;
+
+	// Fixed turn in degrees of rectangles, lines, capsules and polygons, bodies do not spin
+	float angle = 0.0f;
 
+	// One bit per layer the body is on and the layers it collides with. Two bodies collide only if each one's
+	// layer is in the other's mask. Static geometry is on StaticGeometry::LAYER
+	uint32_t collisionLayer = 1;
+	uint32_t collisionMask = 0xFFFFFFFF;
+
+	// A dynamic body without gravity is added as a static one
 	bool enableGravity = true;
-	bool wasKilled = false;
-	bool isActive = false;
+
+	// Sweeps the body along its motion every step so it cannot pass through thin bodies at high speed.
+	// Costs a broadphase query per step, meant for projectiles
+	bool continuousCollision = false;
+
+	// Set while the body is registered with a PhysicsEngine
+	BodyHandle handle;
+	BodyStore* store = nullptr;
+
+	[[nodiscard]] bool IsSimulated() const;
+
+	// Teleporting the body or changing its velocity wakes it and the bodies resting on it
+	[[nodiscard]] bool IsAwake() const;
+	void Wake();
+
+	[[nodiscard]] glm::vec2 GetPosition() const;
+	void SetPosition(glm::vec2 position);
+	[[nodiscard]] glm::vec2 GetVelocity() const;
+	void SetVelocity(glm::vec2 new_velocity);
+	[[nodiscard]] float GetMass() const;
+	void SetMass(float new_mass);
+	[[nodiscard]] float GetRestitution() const;
+	void SetRestitution(float new_restitution);
+
+	// Wakes the body, whatever rested on a layer it stops colliding with falls
+	void SetCollisionFilter(uint32_t layer, uint32_t mask);
 };
 
 #endif /* defined (__RIGID_BODY__) */
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+#ifndef __RIGID_BODY_DEBUG__
+#define __RIGID_BODY_DEBUG__
+#include <glm/vec2.hpp>
+
+/*
+ * Forces on a body during the last substep, for drawing. These used to be fields of every RigidBody that
+ * nothing filled, now PhysicsEngine::UpdateDebugTable works them out from the contacts for whichever
+ * debug view asks, and the simulation never reads or writes them
+ */
+struct RigidBodyDebug
+{
+	glm::vec2 fGravity = glm::vec2(0, 0);
+
+	// Sum of what the contacts pushed the body with, split along and across their normals
+	glm::vec2 fNormal = glm::vec2(0, 0);
+	glm::vec2 fFriction = glm::vec2(0, 0);
+
+	// Gravity split across and along the direction the contacts push the body in. With no contacts all of it is parallel
+	glm::vec2 fPerpendicularGravity = glm::vec2(0, 0);
+	glm::vec2 fParallelGravity = glm::vec2(0, 0);
+
+	int contactCount = 0;
+};
+
+#endif /* defined (__RIGID_BODY_DEBUG__) */
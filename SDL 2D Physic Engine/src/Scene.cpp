@@ -3,6 +3,8 @@
 #include <algorithm>
 
 #include "DisplayObject.h"
+#include "ObjectPool.h"
+#include "SpriteBatch.h"
 
 Scene::Scene()
 = default;
@@ -26,84 +28,210 @@ void Scene::AddChild(DisplayObject * child, uint32_t layer_index, std::optional<
 	{
 		index = m_nextLayerIndex++;
 	}
-	child->SetLayerIndex(layer_index, index);
+	// Not through SetLayerIndex, the child may already name this scene as its parent without being in a layer
+	child->m_layerIndex = layer_index;
+	child->m_layerOrderIndex = index;
 	child->m_pParentScene = this;
-	m_displayList.push_back(child);
+	InsertIntoLayer(child);
+	m_childCount++;
+	m_displayListDirty = true;
 }
 
 void Scene::RemoveChild(DisplayObject * child)
 {
-	delete child;
-	m_displayList.erase(std::remove(m_displayList.begin(), m_displayList.end(), child), m_displayList.end());
+	if (RemoveFromLayer(child, child->m_layerIndex))
+	{
+		m_childCount--;
+	}
+
+	// The rest stays in order, so the lists only lose the child. A removal from inside an update or draw walk
+	// leaves nothing dangling behind
+	const auto position = std::find(m_displayList.begin(), m_displayList.end(), child);
+	if (position != m_displayList.end())
+	{
+		const size_t index = static_cast<size_t>(position - m_displayList.begin());
+		if (index < m_enabledCount)
+		{
+			m_enabledCount--;
+		}
+
+		// The children behind it move up one, the update walk has to step back to not skip the next one
+		if (index < m_nextUpdate)
+		{
+			m_nextUpdate--;
+		}
+		m_displayList.erase(position);
+	}
+	m_drawList.erase(std::remove(m_drawList.begin(), m_drawList.end(), child), m_drawList.end());
+	DestroyChild(child);
 }
 
 void Scene::RemoveAllChildren()
 {
-	for (auto& count : m_displayList)
+	for (auto& layer : m_layers)
 	{
-		delete count;
-		count = nullptr;
+		for (auto& count : layer.second)
+		{
+			DestroyChild(count);
+			count = nullptr;
+		}
 	}
 
+	m_layers.clear();
+	m_childCount = 0;
 	m_displayList.clear();
+	m_drawList.clear();
+	m_enabledCount = 0;
+	m_displayListDirty = false;
 }
 
 
+void Scene::DestroyChild(DisplayObject* child)
+{
+	if (child != nullptr && child->m_pPool != nullptr)
+	{
+		child->m_pPool->Release(child);
+		return;
+	}
+
+	delete child;
+}
+
 int Scene::NumberOfChildren() const
 {
-	return m_displayList.size();
+	return m_childCount;
 }
 
-bool Scene::SortObjects(DisplayObject * left, DisplayObject * right)
+void Scene::InsertIntoLayer(DisplayObject* child)
 {
-	/*
-	 * First check if they have the same enabled status, if they have the same enabled status,
-	 * we first check to see if they're on the same layer, if they are then we sort by layer order index,
-	 * otherwise we simply sort by layer index
-	 * If they do not have the same enabled status, one is true and one is false, so if left is true, it gets
-	 * sorted first, otherwise right is true and it goes first
-	 * This will effectively sort by layer indices, and move disabled elements to the end of the list
-	 */
-	return
-		(left->IsEnabled() == right->IsEnabled()) ?
-		(left->m_layerIndex == right->m_layerIndex ?
-			left->m_layerOrderIndex < right->m_layerOrderIndex :
-			left->m_layerIndex < right->m_layerIndex) :
-		left->IsEnabled();
+	std::vector<DisplayObject*>& layer = m_layers[child->m_layerIndex];
+
+	// Usually the child has the highest order index yet and goes on the end without moving anything
+	const auto position = std::upper_bound(layer.begin(), layer.end(), child, [](const DisplayObject* left, const DisplayObject* right)
+	{
+		return left->m_layerOrderIndex < right->m_layerOrderIndex;
+	});
+	layer.insert(position, child);
 }
 
-void Scene::UpdateDisplayList()
+bool Scene::RemoveFromLayer(DisplayObject* child, const uint32_t layer_index)
 {
-	std::sort(m_displayList.begin(), m_displayList.end(), SortObjects);
-	for (auto& display_object : m_displayList)
+	const auto layer = m_layers.find(layer_index);
+	if (layer == m_layers.end())
 	{
-		if (display_object != nullptr)
-		{
-			if (!display_object->IsEnabled())
-				break;
-			display_object->Update();
-		}
+		return false;
 	}
+
+	const auto position = std::find(layer->second.begin(), layer->second.end(), child);
+	if (position == layer->second.end())
+	{
+		return false;
+	}
+
+	layer->second.erase(position);
+	if (layer->second.empty())
+	{
+		m_layers.erase(layer);
+	}
+	return true;
 }
 
-void Scene::DrawDisplayList()
+void Scene::MoveChild(DisplayObject* child, const uint32_t old_layer_index)
+{
+	if (RemoveFromLayer(child, old_layer_index))
+	{
+		InsertIntoLayer(child);
+		m_displayListDirty = true;
+	}
+}
+
+void Scene::MarkDisplayListDirty()
+{
+	m_displayListDirty = true;
+}
+
+void Scene::CollectChildren(std::vector<DisplayObject*>& children) const
 {
-	std::sort(m_displayList.begin(), m_displayList.end(), SortObjects);
-	for (auto& display_object : m_displayList)
+	// Enabled children in layer order, then the disabled ones in layer order
+	children.clear();
+	for (const bool enabled : { true, false })
 	{
-		if (display_object != nullptr)
+		for (const auto& layer : m_layers)
 		{
-			if (display_object->IsEnabled() && display_object->IsVisible())
+			for (DisplayObject* child : layer.second)
 			{
-				display_object->Draw();
+				if (child->IsEnabled() == enabled)
+				{
+					children.push_back(child);
+				}
 			}
+		}
+	}
+}
+
+void Scene::RebuildDisplayList()
+{
+	CollectChildren(m_displayList);
 
+	m_enabledCount = 0;
+	m_drawList.clear();
+	while (m_enabledCount < m_displayList.size() && m_displayList[m_enabledCount]->IsEnabled())
+	{
+		DisplayObject* child = m_displayList[m_enabledCount++];
+		if (child->IsVisible())
+		{
+			m_drawList.push_back(child);
 		}
 	}
 
+	m_displayListDirty = false;
+}
+
+void Scene::UpdateDisplayList()
+{
+	if (m_displayListDirty)
+	{
+		RebuildDisplayList();
+	}
+
+	// Children added, removed, enabled or disabled by an update show from the next call on. Removing erases
+	// from the list, so the walk goes by index, which RemoveChild keeps pointing at the next child
+	m_nextUpdate = 0;
+	while (m_nextUpdate < m_enabledCount && m_nextUpdate < m_displayList.size())
+	{
+		m_displayList[m_nextUpdate++]->Update();
+	}
+	m_nextUpdate = 0;
+}
+
+void Scene::DrawDisplayList()
+{
+	if (m_displayListDirty)
+	{
+		RebuildDisplayList();
+	}
+
+	// Batched sprites are regrouped by texture within a layer but never across layers
+	SpriteBatch& sprite_batch = SpriteBatch::Instance();
+	for (size_t i = 0; i < m_drawList.size(); i++)
+	{
+		if (i > 0 && m_drawList[i]->m_layerIndex != m_drawList[i - 1]->m_layerIndex)
+		{
+			sprite_batch.Flush();
+		}
+		m_drawList[i]->Draw();
+	}
+	sprite_batch.Flush();
 }
 
 std::vector<DisplayObject*> Scene::GetDisplayList() const
 {
-	return m_displayList;
+	if (!m_displayListDirty)
+	{
+		return m_displayList;
+	}
+
+	std::vector<DisplayObject*> children;
+	CollectChildren(children);
+	return children;
 }
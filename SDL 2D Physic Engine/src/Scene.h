@@ -2,6 +2,7 @@
 #ifndef __SCENE__
 #define __SCENE__
 
+#include <map>
 #include <vector>
 #include <optional>
 #include "GameObject.h"
@@ -27,16 +28,42 @@ public:
 	void RemoveAllChildren();
 	[[nodiscard]] int NumberOfChildren() const;
 
+	// Both walk the children in layer order, enabled ones only, and Draw skips the invisible ones. The order is
+	// only rebuilt after a child was added, removed, moved to another layer, enabled, disabled, shown or hidden
 	void UpdateDisplayList();
 	void DrawDisplayList();
 
+	// Every child in draw order, the disabled ones last
 	[[nodiscard]] std::vector<DisplayObject*> GetDisplayList() const;
 
 private:
 	uint32_t m_nextLayerIndex = 0;
+
+	// Children by layer index, each bucket sorted by layer order index. Children added without an order index
+	// get the next one, which puts them at the end of their bucket
+	std::map<uint32_t, std::vector<DisplayObject*>> m_layers;
+	int m_childCount = 0;
+
+	// The buckets one after the other, the enabled children first, and the enabled and visible ones on their own
 	std::vector<DisplayObject*> m_displayList;
+	size_t m_enabledCount = 0;
+	std::vector<DisplayObject*> m_drawList;
+
+	// Index of the child UpdateDisplayList updates next, 0 outside of it
+	size_t m_nextUpdate = 0;
+	bool m_displayListDirty = false;
+
+	void InsertIntoLayer(DisplayObject* child);
+	bool RemoveFromLayer(DisplayObject* child, uint32_t layer_index);
+
+	// Called by DisplayObject when its layer, enabled or visible state changes
+	void MoveChild(DisplayObject* child, uint32_t old_layer_index);
+	void MarkDisplayListDirty();
+	void RebuildDisplayList();
+	void CollectChildren(std::vector<DisplayObject*>& children) const;
 
-	static bool SortObjects(DisplayObject* left, DisplayObject* right);
+	// Deletes the child, or gives it back to the ObjectPool it came from
+	static void DestroyChild(DisplayObject* child);
 };
 
 #endif /* defined (__SCENE__) */
@@ -1,5 +1,6 @@
 #include "SmallPig.h"
 #include "SoundManager.h"
+#include "SpriteBatch.h"
 #include "TextureManager.h"
 
 SmallPig::SmallPig(int w, int h)
@@ -19,7 +20,7 @@ SmallPig::SmallPig(int w, int h)
 	GetTransform()->position = glm::vec2(300.0f, 300.0f);
 
 	SetType(GameObjectType::PIG);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 }
 
 SmallPig::~SmallPig()
@@ -27,7 +28,7 @@ SmallPig::~SmallPig()
 
 void SmallPig::Draw()
 {
-	TextureManager::Instance().Draw("SmallPig", GetTransform()->position, 0, 255, true);
+	SpriteBatch::Instance().Draw("SmallPig", GetTransform()->position, 0, 255, true);
 }
 
 void SmallPig::Update()
@@ -0,0 +1,367 @@
+#include "SpatialHashBroadphase.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SpatialHashBroadphase::SpatialHashBroadphase(const float cell_size)
+	: m_cellSize(cell_size), m_inverseCellSize(1.0f / cell_size)
+{
+}
+
+int SpatialHashBroadphase::CreateProxy(const AABB& aabb)
+{
+	int proxy_id;
+	if (!m_freeProxies.empty())
+	{
+		proxy_id = m_freeProxies.back();
+		m_freeProxies.pop_back();
+	}
+	else
+	{
+		proxy_id = static_cast<int>(m_proxies.size());
+		m_proxies.emplace_back();
+	}
+
+	m_proxies[proxy_id].aabb = aabb;
+	m_proxies[proxy_id].active = true;
+	m_proxyCount++;
+	MarkUnhashed(proxy_id);
+
+	return proxy_id;
+}
+
+void SpatialHashBroadphase::DestroyProxy(const int proxy_id)
+{
+	m_proxies[proxy_id].active = false;
+	m_freeProxies.push_back(proxy_id);
+	m_proxyCount--;
+}
+
+void SpatialHashBroadphase::MoveProxy(const int proxy_id, const AABB& aabb)
+{
+	m_proxies[proxy_id].aabb = aabb;
+	MarkUnhashed(proxy_id);
+}
+
+void SpatialHashBroadphase::UpdatePairs(std::vector<BroadphasePair>& pairs)
+{
+	pairs.clear();
+	m_entries.clear();
+	m_oversized.clear();
+
+	for (const int proxy_id : m_unhashed)
+	{
+		m_proxies[proxy_id].unhashed = false;
+	}
+	m_unhashed.clear();
+
+	// Hash every proxy into the cells it touches
+	for (int i = 0; i < static_cast<int>(m_proxies.size()); i++)
+	{
+		Proxy& proxy = m_proxies[i];
+		if (!proxy.active)
+		{
+			continue;
+		}
+
+		const int min_x = ToCell(proxy.aabb.min.x);
+		const int min_y = ToCell(proxy.aabb.min.y);
+		const int max_x = ToCell(proxy.aabb.max.x);
+		const int max_y = ToCell(proxy.aabb.max.y);
+
+		proxy.minCellX = min_x;
+		proxy.minCellY = min_y;
+		proxy.oversizedIndex = -1;
+
+		const int64_t cell_count = static_cast<int64_t>(max_x - min_x + 1) * (max_y - min_y + 1);
+		if (cell_count > MAX_CELLS_PER_PROXY)
+		{
+			proxy.oversizedIndex = static_cast<int>(m_oversized.size());
+			m_oversized.push_back(i);
+			continue;
+		}
+
+		for (int y = min_y; y <= max_y; y++)
+		{
+			for (int x = min_x; x <= max_x; x++)
+			{
+				m_entries.push_back({ CellKey(x, y), x, y, i });
+			}
+		}
+	}
+
+	// Group the entries by cell, proxies inside a cell stay in id order
+	std::sort(m_entries.begin(), m_entries.end(), [](const CellEntry& left, const CellEntry& right)
+	{
+		return (left.key == right.key) ? left.proxy < right.proxy : left.key < right.key;
+	});
+
+	const int entry_count = static_cast<int>(m_entries.size());
+	int run_start = 0;
+	while (run_start < entry_count)
+	{
+		int run_end = run_start + 1;
+		while (run_end < entry_count && m_entries[run_end].key == m_entries[run_start].key)
+		{
+			run_end++;
+		}
+
+		const int cell_x = m_entries[run_start].cellX;
+		const int cell_y = m_entries[run_start].cellY;
+
+		for (int i = run_start; i < run_end; i++)
+		{
+			const Proxy& proxy_a = m_proxies[m_entries[i].proxy];
+			for (int j = i + 1; j < run_end; j++)
+			{
+				const Proxy& proxy_b = m_proxies[m_entries[j].proxy];
+
+				// Two proxies can share several cells, only report the pair from the first cell they share
+				if (std::max(proxy_a.minCellX, proxy_b.minCellX) != cell_x ||
+					std::max(proxy_a.minCellY, proxy_b.minCellY) != cell_y)
+				{
+					continue;
+				}
+
+				if (proxy_a.aabb.Overlaps(proxy_b.aabb))
+				{
+					pairs.push_back({ m_entries[i].proxy, m_entries[j].proxy });
+				}
+			}
+		}
+
+		run_start = run_end;
+	}
+
+	// Oversized proxies are tested against every other proxy
+	for (int k = 0; k < static_cast<int>(m_oversized.size()); k++)
+	{
+		const int big = m_oversized[k];
+		for (int i = 0; i < static_cast<int>(m_proxies.size()); i++)
+		{
+			const Proxy& other = m_proxies[i];
+			if (!other.active || i == big)
+			{
+				continue;
+			}
+
+			// Pairs between two oversized proxies are only reported once
+			if (other.oversizedIndex >= 0 && other.oversizedIndex < k)
+			{
+				continue;
+			}
+
+			if (m_proxies[big].aabb.Overlaps(other.aabb))
+			{
+				pairs.push_back({ std::min(big, i), std::max(big, i) });
+			}
+		}
+	}
+
+	std::sort(pairs.begin(), pairs.end());
+}
+
+void SpatialHashBroadphase::Query(const AABB& aabb, std::vector<int>& proxies) const
+{
+	proxies.clear();
+
+	const int min_x = ToCell(aabb.min.x);
+	const int min_y = ToCell(aabb.min.y);
+	const int max_x = ToCell(aabb.max.x);
+	const int max_y = ToCell(aabb.max.y);
+
+	// A box covering much of the level is quicker to test against every proxy
+	const int64_t cell_count = static_cast<int64_t>(max_x - min_x + 1) * (max_y - min_y + 1);
+	if (cell_count > MAX_CELLS_PER_PROXY)
+	{
+		for (int i = 0; i < static_cast<int>(m_proxies.size()); i++)
+		{
+			if (m_proxies[i].active && m_proxies[i].aabb.Overlaps(aabb))
+			{
+				proxies.push_back(i);
+			}
+		}
+		return;
+	}
+
+	// Entries are sorted by cell key, so each cell is a binary search away
+	for (int y = min_y; y <= max_y; y++)
+	{
+		for (int x = min_x; x <= max_x; x++)
+		{
+			const uint64_t key = CellKey(x, y);
+			auto entry = std::lower_bound(m_entries.begin(), m_entries.end(), key, [](const CellEntry& left, const uint64_t right)
+			{
+				return left.key < right;
+			});
+
+			for (; entry != m_entries.end() && entry->key == key; ++entry)
+			{
+				const Proxy& proxy = m_proxies[entry->proxy];
+				if (proxy.active && proxy.aabb.Overlaps(aabb))
+				{
+					proxies.push_back(entry->proxy);
+				}
+			}
+		}
+	}
+
+	for (const int big : m_oversized)
+	{
+		if (m_proxies[big].active && m_proxies[big].aabb.Overlaps(aabb))
+		{
+			proxies.push_back(big);
+		}
+	}
+
+	for (const int proxy_id : m_unhashed)
+	{
+		if (m_proxies[proxy_id].active && m_proxies[proxy_id].aabb.Overlaps(aabb))
+		{
+			proxies.push_back(proxy_id);
+		}
+	}
+
+	// A proxy spanning several of the cells was found once per cell
+	std::sort(proxies.begin(), proxies.end());
+	proxies.erase(std::unique(proxies.begin(), proxies.end()), proxies.end());
+}
+
+void SpatialHashBroadphase::RayCast(const RayCastInput& input, float max_fraction, const RayCastCallback& callback) const
+{
+	auto report = [this, &input, &callback, &max_fraction](const int proxy_id)
+	{
+		float enter;
+		if (m_proxies[proxy_id].active && m_proxies[proxy_id].aabb.Grow(input.radius).RayCast(input.start, input.translation, max_fraction, enter))
+		{
+			max_fraction = callback(proxy_id, max_fraction);
+		}
+		return max_fraction > 0.0f;
+	};
+
+	for (const int big : m_oversized)
+	{
+		if (!report(big))
+		{
+			return;
+		}
+	}
+
+	// The cells may still hold where these were before, their boxes are tested as they are now
+	for (const int proxy_id : m_unhashed)
+	{
+		if (!report(proxy_id))
+		{
+			return;
+		}
+	}
+
+	// Steps from cell to cell along the line the cast's center follows, looking at the cells around it the radius
+	// reaches into too. A proxy hit at some fraction is in the cells around where the center is then, so
+	// once the line enters a cell past the closest hit nothing further on can be closer
+	const int reach = static_cast<int>(std::ceil(input.radius * m_inverseCellSize));
+	const float infinity = std::numeric_limits<float>::max();
+
+	int cell[2] = { ToCell(input.start.x), ToCell(input.start.y) };
+	int step[2];
+	float next_border[2];
+	float border_distance[2];
+	for (int axis = 0; axis < 2; axis++)
+	{
+		step[axis] = (input.translation[axis] > 0.0f) ? 1 : -1;
+		if (std::abs(input.translation[axis]) < 1e-6f)
+		{
+			next_border[axis] = infinity;
+			border_distance[axis] = infinity;
+			continue;
+		}
+
+		const float border = static_cast<float>(cell[axis] + ((step[axis] > 0) ? 1 : 0)) * m_cellSize;
+		next_border[axis] = (border - input.start[axis]) / input.translation[axis];
+		border_distance[axis] = m_cellSize / std::abs(input.translation[axis]);
+	}
+
+	float enter = 0.0f;
+	while (enter <= max_fraction)
+	{
+		for (int y = cell[1] - reach; y <= cell[1] + reach; y++)
+		{
+			for (int x = cell[0] - reach; x <= cell[0] + reach; x++)
+			{
+				const uint64_t key = CellKey(x, y);
+				auto entry = std::lower_bound(m_entries.begin(), m_entries.end(), key, [](const CellEntry& left, const uint64_t right)
+				{
+					return left.key < right;
+				});
+
+				for (; entry != m_entries.end() && entry->key == key; ++entry)
+				{
+					if (!report(entry->proxy))
+					{
+						return;
+					}
+				}
+			}
+		}
+
+		const int axis = (next_border[0] < next_border[1]) ? 0 : 1;
+		enter = next_border[axis];
+		next_border[axis] += border_distance[axis];
+		cell[axis] += step[axis];
+	}
+}
+
+void SpatialHashBroadphase::SetCellSize(const float cell_size)
+{
+	m_cellSize = cell_size;
+	m_inverseCellSize = 1.0f / cell_size;
+}
+
+float SpatialHashBroadphase::GetCellSize() const
+{
+	return m_cellSize;
+}
+
+const AABB& SpatialHashBroadphase::GetAABB(const int proxy_id) const
+{
+	return m_proxies[proxy_id].aabb;
+}
+
+int SpatialHashBroadphase::GetProxyCount() const
+{
+	return m_proxyCount;
+}
+
+BroadphaseType SpatialHashBroadphase::GetType() const
+{
+	return BroadphaseType::SPATIAL_HASH;
+}
+
+int SpatialHashBroadphase::GetCellEntryCount() const
+{
+	return static_cast<int>(m_entries.size());
+}
+
+int SpatialHashBroadphase::GetOversizedCount() const
+{
+	return static_cast<int>(m_oversized.size());
+}
+
+uint64_t SpatialHashBroadphase::CellKey(const int cell_x, const int cell_y)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32) | static_cast<uint32_t>(cell_y);
+}
+
+void SpatialHashBroadphase::MarkUnhashed(const int proxy_id)
+{
+	if (!m_proxies[proxy_id].unhashed)
+	{
+		m_proxies[proxy_id].unhashed = true;
+		m_unhashed.push_back(proxy_id);
+	}
+}
+
+int SpatialHashBroadphase::ToCell(const float value) const
+{
+	return static_cast<int>(std::floor(value * m_inverseCellSize));
+}
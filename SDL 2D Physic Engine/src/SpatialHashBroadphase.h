@@ -0,0 +1,79 @@
+#pragma once
+#ifndef __SPATIAL_HASH_BROADPHASE__
+#define __SPATIAL_HASH_BROADPHASE__
+#include <cstdint>
+#include <vector>
+#include "Broadphase.h"
+
+/*
+ * Uniform grid broadphase. Every proxy is hashed into the cells its AABB touches and
+ * the grid is rebuilt from scratch on each UpdatePairs call, so moving a proxy is just a store.
+ * Proxies that would cover too many cells (the ground, long platforms) are kept in a separate
+ * oversized list and tested against everything instead of flooding the grid.
+ */
+class SpatialHashBroadphase final : public Broadphase
+{
+public:
+	explicit SpatialHashBroadphase(float cell_size = 128.0f);
+
+	int CreateProxy(const AABB& aabb) override;
+	void DestroyProxy(int proxy_id) override;
+	void MoveProxy(int proxy_id, const AABB& aabb) override;
+
+	// Rebuilds the grid and writes every overlapping proxy pair, sorted by proxy id
+	void UpdatePairs(std::vector<BroadphasePair>& pairs) override;
+
+	// Looks in the cells of the last UpdatePairs, proxies created or moved since then are tested one by one
+	void Query(const AABB& aabb, std::vector<int>& proxies) const override;
+
+	// Walks the cells along the cast, and like Query tests the proxies created or moved since the last UpdatePairs
+	void RayCast(const RayCastInput& input, float max_fraction, const RayCastCallback& callback) const override;
+
+	void SetCellSize(float cell_size);
+	[[nodiscard]] float GetCellSize() const;
+
+	[[nodiscard]] const AABB& GetAABB(int proxy_id) const;
+	[[nodiscard]] int GetProxyCount() const override;
+	[[nodiscard]] BroadphaseType GetType() const override;
+	[[nodiscard]] int GetCellEntryCount() const;
+	[[nodiscard]] int GetOversizedCount() const;
+
+private:
+	struct Proxy
+	{
+		AABB aabb;
+		int minCellX = 0;
+		int minCellY = 0;
+		int oversizedIndex = -1;
+		bool active = false;
+		bool unhashed = false;
+	};
+
+	struct CellEntry
+	{
+		uint64_t key;
+		int cellX;
+		int cellY;
+		int proxy;
+	};
+
+	static uint64_t CellKey(int cell_x, int cell_y);
+	int ToCell(float value) const;
+
+	// Remembers a proxy whose box is not in the cells of the last UpdatePairs
+	void MarkUnhashed(int proxy_id);
+
+	std::vector<Proxy> m_proxies;
+	std::vector<int> m_freeProxies;
+	std::vector<CellEntry> m_entries;
+	std::vector<int> m_oversized;
+	std::vector<int> m_unhashed;
+
+	float m_cellSize;
+	float m_inverseCellSize;
+	int m_proxyCount = 0;
+
+	static constexpr int MAX_CELLS_PER_PROXY = 64;
+};
+
+#endif /* defined (__SPATIAL_HASH_BROADPHASE__) */
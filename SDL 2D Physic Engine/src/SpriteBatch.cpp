@@ -0,0 +1,227 @@
+#include "SpriteBatch.h"
+#include <cmath>
+#include "TextureManager.h"
+
+namespace
+{
+	constexpr float DEGREES_TO_RADIANS = 3.14159265358979f / 180.0f;
+
+	// Corners around the centre in units of the half size, clockwise from the top left
+	constexpr float CORNERS[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+}
+
+SpriteBatch::SpriteBatch()
+= default;
+
+SpriteBatch::~SpriteBatch()
+= default;
+
+void SpriteBatch::Draw(const std::string& id, const glm::vec2 position, const double angle, const int alpha, const bool centered,
+	const SDL_RendererFlip flip)
+{
+	SDL_Texture* texture = TextureManager::Instance().GetTexture(id);
+	if (texture == nullptr)
+	{
+		return;
+	}
+
+	const TextureRun& run = m_textures[FindTexture(texture)];
+	const float width = static_cast<float>(run.width);
+	const float height = static_cast<float>(run.height);
+	const glm::vec2 corner = centered ? position - glm::vec2(width, height) * 0.5f : position;
+	Draw(texture, nullptr, { corner.x, corner.y, width, height }, angle, alpha, flip);
+}
+
+void SpriteBatch::Draw(const std::string& id, const glm::vec2 position, const GameObject* go, const double angle, const int alpha,
+	const bool centered, const SDL_RendererFlip flip)
+{
+	SDL_Texture* texture = TextureManager::Instance().GetTexture(id);
+	if (texture == nullptr)
+	{
+		return;
+	}
+
+	const float width = static_cast<float>(go->GetWidth());
+	const float height = static_cast<float>(go->GetHeight());
+	const glm::vec2 corner = centered ? position - glm::vec2(width, height) * 0.5f : position;
+	Draw(texture, nullptr, { corner.x, corner.y, width, height }, angle, alpha, flip);
+}
+
+void SpriteBatch::Draw(SDL_Texture* texture, const SDL_Rect* source, const SDL_FRect& destination, const double angle, const int alpha,
+	const SDL_RendererFlip flip)
+{
+	m_spriteCount++;
+
+	if (!m_enabled)
+	{
+		SDL_SetTextureAlphaMod(texture, static_cast<Uint8>(alpha));
+		SDL_RenderCopyExF(Renderer::Instance().GetRenderer(), texture, source, &destination, angle, nullptr, flip);
+		SDL_SetTextureAlphaMod(texture, 255);
+		m_drawCallCount++;
+		return;
+	}
+
+	Sprite sprite{};
+	sprite.destination = destination;
+	sprite.angle = static_cast<float>(angle);
+	sprite.flip = flip;
+	sprite.alpha = static_cast<Uint8>(alpha);
+	sprite.texture = FindTexture(texture);
+
+	const TextureRun& run = m_textures[sprite.texture];
+	if (source != nullptr)
+	{
+		sprite.u0 = static_cast<float>(source->x) / static_cast<float>(run.width);
+		sprite.v0 = static_cast<float>(source->y) / static_cast<float>(run.height);
+		sprite.u1 = static_cast<float>(source->x + source->w) / static_cast<float>(run.width);
+		sprite.v1 = static_cast<float>(source->y + source->h) / static_cast<float>(run.height);
+	}
+	else
+	{
+		sprite.u0 = 0.0f;
+		sprite.v0 = 0.0f;
+		sprite.u1 = 1.0f;
+		sprite.v1 = 1.0f;
+	}
+
+	m_sprites.push_back(sprite);
+}
+
+void SpriteBatch::Flush(SDL_Renderer* renderer)
+{
+	const int count = static_cast<int>(m_sprites.size());
+	if (count == 0)
+	{
+		m_textures.clear();
+		return;
+	}
+
+	// Counting sort by texture, a layer rarely has more than a handful of them
+	const int texture_count = static_cast<int>(m_textures.size());
+	m_runStarts.assign(texture_count + 1, 0);
+	for (const auto& sprite : m_sprites)
+	{
+		m_runStarts[sprite.texture + 1]++;
+	}
+	for (int i = 0; i < texture_count; i++)
+	{
+		m_runStarts[i + 1] += m_runStarts[i];
+	}
+
+	m_order.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		m_order[m_runStarts[m_sprites[i].texture]++] = i;
+	}
+
+	// Every start was moved to the next run's start, the first run starts at zero
+	for (int i = texture_count; i > 0; i--)
+	{
+		m_runStarts[i] = m_runStarts[i - 1];
+	}
+	m_runStarts[0] = 0;
+
+	m_vertices.resize(static_cast<size_t>(count) * 4);
+	for (int i = 0; i < count; i++)
+	{
+		WriteQuad(m_sprites[m_order[i]], &m_vertices[static_cast<size_t>(i) * 4]);
+	}
+
+	for (int quad = static_cast<int>(m_indices.size()) / 6; quad < count; quad++)
+	{
+		const int vertex = quad * 4;
+		m_indices.insert(m_indices.end(), { vertex, vertex + 1, vertex + 2, vertex, vertex + 2, vertex + 3 });
+	}
+
+	// Each run starts its vertices at its own offset, so the indices of the first quads fit every run
+	for (int i = 0; i < texture_count; i++)
+	{
+		const int first = m_runStarts[i];
+		const int quads = m_runStarts[i + 1] - first;
+		if (quads == 0)
+		{
+			continue;
+		}
+
+		SDL_RenderGeometry(renderer, m_textures[i].texture, &m_vertices[static_cast<size_t>(first) * 4], quads * 4, m_indices.data(), quads * 6);
+		m_drawCallCount++;
+	}
+
+	m_sprites.clear();
+	m_textures.clear();
+}
+
+void SpriteBatch::SetEnabled(const bool enabled)
+{
+	if (!enabled)
+	{
+		Flush();
+	}
+	m_enabled = enabled;
+}
+
+bool SpriteBatch::IsEnabled() const
+{
+	return m_enabled;
+}
+
+void SpriteBatch::ResetStatistics()
+{
+	m_spriteCount = 0;
+	m_drawCallCount = 0;
+}
+
+int SpriteBatch::GetSpriteCount() const
+{
+	return m_spriteCount;
+}
+
+int SpriteBatch::GetDrawCallCount() const
+{
+	return m_drawCallCount;
+}
+
+int SpriteBatch::FindTexture(SDL_Texture* texture)
+{
+	for (int i = 0; i < static_cast<int>(m_textures.size()); i++)
+	{
+		if (m_textures[i].texture == texture)
+		{
+			return i;
+		}
+	}
+
+	TextureRun run{ texture, 0, 0 };
+	SDL_QueryTexture(texture, nullptr, nullptr, &run.width, &run.height);
+	m_textures.push_back(run);
+	return static_cast<int>(m_textures.size()) - 1;
+}
+
+void SpriteBatch::WriteQuad(const Sprite& sprite, SDL_Vertex* vertices)
+{
+	const float half_width = sprite.destination.w * 0.5f;
+	const float half_height = sprite.destination.h * 0.5f;
+	const float centre_x = sprite.destination.x + half_width;
+	const float centre_y = sprite.destination.y + half_height;
+
+	// Clockwise on screen like SDL_RenderCopyEx, y points down
+	const float cosine = (sprite.angle != 0.0f) ? std::cos(sprite.angle * DEGREES_TO_RADIANS) : 1.0f;
+	const float sine = (sprite.angle != 0.0f) ? std::sin(sprite.angle * DEGREES_TO_RADIANS) : 0.0f;
+
+	const float u[2] = { (sprite.flip & SDL_FLIP_HORIZONTAL) ? sprite.u1 : sprite.u0, (sprite.flip & SDL_FLIP_HORIZONTAL) ? sprite.u0 : sprite.u1 };
+	const float v[2] = { (sprite.flip & SDL_FLIP_VERTICAL) ? sprite.v1 : sprite.v0, (sprite.flip & SDL_FLIP_VERTICAL) ? sprite.v0 : sprite.v1 };
+	const SDL_Color colour = { 255, 255, 255, sprite.alpha };
+
+	for (int corner = 0; corner < 4; corner++)
+	{
+		const float x = CORNERS[corner][0] * half_width;
+		const float y = CORNERS[corner][1] * half_height;
+
+		SDL_Vertex& vertex = vertices[corner];
+		vertex.position.x = centre_x + x * cosine - y * sine;
+		vertex.position.y = centre_y + x * sine + y * cosine;
+		vertex.color = colour;
+		vertex.tex_coord.x = u[CORNERS[corner][0] > 0.0f ? 1 : 0];
+		vertex.tex_coord.y = v[CORNERS[corner][1] > 0.0f ? 1 : 0];
+	}
+}
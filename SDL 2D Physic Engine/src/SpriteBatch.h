@@ -0,0 +1,93 @@
+#pragma once
+#ifndef __SPRITE_BATCH__
+#define __SPRITE_BATCH__
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <SDL.h>
+#include "GameObject.h"
+#include "Renderer.h"
+
+/*
+ * Queues textured quads and draws every quad of a texture with one SDL_RenderGeometry call. The Draw functions
+ * take the same arguments as TextureManager::Draw, so a DisplayObject opts in by drawing through here instead.
+ *
+ * Flush orders the queue by texture, textures in the order they were first queued and quads of the same texture
+ * in the order they were queued. Scene::DrawDisplayList flushes whenever the layer changes and at the end, so
+ * layers still draw in order and only the quads within a layer are regrouped. Quads queued elsewhere wait for
+ * the flush at the end of Game::Render.
+ *
+ * Alpha goes in the vertex colours. The colour and alpha mods set through the TextureManager still apply
+ */
+class SpriteBatch
+{
+public:
+	static SpriteBatch& Instance()
+	{
+		static SpriteBatch instance;
+		return instance;
+	}
+
+	// Texture sized
+	void Draw(const std::string& id, glm::vec2 position, double angle = 0, int alpha = 255, bool centered = false, SDL_RendererFlip flip = SDL_FLIP_NONE);
+
+	// Sized like the game object
+	void Draw(const std::string& id, glm::vec2 position, const GameObject* go, double angle = 0, int alpha = 255, bool centered = false, SDL_RendererFlip flip = SDL_FLIP_NONE);
+
+	// Part of the texture, the whole of it without a source, stretched over destination and turned around its centre
+	void Draw(SDL_Texture* texture, const SDL_Rect* source, const SDL_FRect& destination, double angle = 0, int alpha = 255,
+		SDL_RendererFlip flip = SDL_FLIP_NONE);
+
+	void Flush(SDL_Renderer* renderer = Renderer::Instance().GetRenderer());
+
+	// While disabled every quad is drawn on the spot with SDL_RenderCopyExF, for comparing
+	void SetEnabled(bool enabled);
+	[[nodiscard]] bool IsEnabled() const;
+
+	// Quads and draw calls since the last reset, both batched and drawn on the spot
+	void ResetStatistics();
+	[[nodiscard]] int GetSpriteCount() const;
+	[[nodiscard]] int GetDrawCallCount() const;
+
+private:
+	SpriteBatch();
+	~SpriteBatch();
+
+	struct Sprite
+	{
+		SDL_FRect destination;
+		float u0, v0, u1, v1;
+		float angle;
+		SDL_RendererFlip flip;
+		Uint8 alpha;
+		int texture;
+	};
+
+	struct TextureRun
+	{
+		SDL_Texture* texture;
+		int width;
+		int height;
+	};
+
+	// Index of the texture in m_textures, added if new. The list is cleared on every flush, so a texture freed
+	// and another created at the same address is not mistaken for it
+	int FindTexture(SDL_Texture* texture);
+	static void WriteQuad(const Sprite& sprite, SDL_Vertex* vertices);
+
+	bool m_enabled = true;
+	std::vector<Sprite> m_sprites;
+	std::vector<TextureRun> m_textures;
+
+	// Reused between flushes, the indices of quad k are always 4k + { 0, 1, 2, 0, 2, 3 }
+	std::vector<int> m_runStarts;
+	std::vector<int> m_order;
+	std::vector<SDL_Vertex> m_vertices;
+	std::vector<int> m_indices;
+
+	int m_spriteCount = 0;
+	int m_drawCallCount = 0;
+};
+
+#endif /* defined (__SPRITE_BATCH__) */
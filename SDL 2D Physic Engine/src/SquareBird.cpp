@@ -1,4 +1,5 @@
 #include "SquareBird.h"
+#include "SpriteBatch.h"
 #include "TextureManager.h"
 
 SquareBird::SquareBird(int w, int h)
@@ -18,8 +19,7 @@ SquareBird::SquareBird(int w, int h)
 
 	GetTransform()->position = glm::vec2(400.0f, 300.0f);
 	GetRigidBody()->velocity = glm::vec2(0.0f, 0.0f);
-	GetRigidBody()->acceleration = glm::vec2(0.0f, 0.0f);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 	SetType(GameObjectType::PLAYER);
 }
 
@@ -28,7 +28,7 @@ SquareBird::~SquareBird()
 
 void SquareBird::Draw()
 {
-	TextureManager::Instance().Draw("SquareBird", GetTransform()->position, 0, 255, true);
+	SpriteBatch::Instance().Draw("SquareBird", GetTransform()->position, 0, 255, true);
 }
 
 void SquareBird::Update()
@@ -0,0 +1,519 @@
+#include "StaticGeometry.h"
+#include "Narrowphase.h"
+#include "TimeOfImpact.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define STATIC_GEOMETRY_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr uint32_t PLANE_MASK = 0xFFFFFFFF;
+	constexpr uint32_t SEGMENT_MASK = 0x7FFFFFFF;
+
+	// Segment ends closer than this are joined, a body sliding over the joint does not catch on either end
+	constexpr float JOINT_TOLERANCE = 0.01f;
+
+	// Feature ids of a segment contact, which end of the segment a box rests against is named by the axis
+	constexpr uint32_t FACE_FEATURE = 0;
+	constexpr uint32_t START_FEATURE = 1;
+	constexpr uint32_t END_FEATURE = 2;
+
+	// A GJK normal this close to the segment normal pushes through the face, anything else is an end
+	constexpr float FACE_NORMAL_DOT = 0.999f;
+
+	float Dot(const glm::vec2 lhs, const glm::vec2 rhs)
+	{
+		return lhs.x * rhs.x + lhs.y * rhs.y;
+	}
+
+	float Sign(const float value)
+	{
+		return (value < 0.0f) ? -1.0f : 1.0f;
+	}
+
+	bool IsJoined(const glm::vec2 lhs, const glm::vec2 rhs)
+	{
+		const glm::vec2 offset = lhs - rhs;
+		return Dot(offset, offset) <= JOINT_TOLERANCE * JOINT_TOLERANCE;
+	}
+}
+
+int StaticGeometry::AddPlane(const glm::vec2 point, const glm::vec2 normal, const float friction, const float restitution)
+{
+	const int id = Allocate();
+	m_segment[id] = 0;
+	m_distanceMask[id] = PLANE_MASK;
+	m_friction[id] = friction;
+	m_restitution[id] = restitution;
+	WritePlane(id, point, normal);
+	return id;
+}
+
+int StaticGeometry::AddSegment(const glm::vec2 start, const glm::vec2 end, const float friction, const float restitution)
+{
+	const int id = Allocate();
+	const glm::vec2 edge = end - start;
+	const float length = std::sqrt(Dot(edge, edge));
+	const glm::vec2 normal = (length > 0.0f) ? glm::vec2(-edge.y, edge.x) / length : glm::vec2(0, -1);
+
+	m_normalX[id] = normal.x;
+	m_normalY[id] = normal.y;
+	m_offset[id] = Dot(normal, start);
+	m_distanceMask[id] = SEGMENT_MASK;
+	m_startX[id] = start.x;
+	m_startY[id] = start.y;
+	m_endX[id] = end.x;
+	m_endY[id] = end.y;
+	m_minX[id] = std::min(start.x, end.x);
+	m_minY[id] = std::min(start.y, end.y);
+	m_maxX[id] = std::max(start.x, end.x);
+	m_maxY[id] = std::max(start.y, end.y);
+	m_friction[id] = friction;
+	m_restitution[id] = restitution;
+	m_segment[id] = 1;
+
+	RefreshJoints(id);
+	return id;
+}
+
+void StaticGeometry::SetPlane(const int id, const glm::vec2 point, const glm::vec2 normal)
+{
+	// A segment would keep its mask and joints with a plane's line and bounds
+	if (id < 0 || id >= static_cast<int>(m_segment.size()) || IsRemoved(id) || IsSegment(id))
+	{
+		return;
+	}
+
+	WritePlane(id, point, normal);
+}
+
+void StaticGeometry::WritePlane(const int id, const glm::vec2 point, const glm::vec2 normal)
+{
+	const float length = std::sqrt(Dot(normal, normal));
+	const glm::vec2 unit_normal = (length > 0.0f) ? normal / length : glm::vec2(0, -1);
+	const float infinity = std::numeric_limits<float>::max();
+
+	m_normalX[id] = unit_normal.x;
+	m_normalY[id] = unit_normal.y;
+	m_offset[id] = Dot(unit_normal, point);
+	m_startX[id] = point.x;
+	m_startY[id] = point.y;
+	m_endX[id] = point.x;
+	m_endY[id] = point.y;
+	m_minX[id] = -infinity;
+	m_minY[id] = -infinity;
+	m_maxX[id] = infinity;
+	m_maxY[id] = infinity;
+}
+
+void StaticGeometry::Remove(const int id)
+{
+	if (id < 0 || id >= static_cast<int>(m_segment.size()) || IsRemoved(id))
+	{
+		return;
+	}
+
+	const bool was_segment = m_segment[id] != 0;
+
+	// An empty box fails the overlap test, the slot stays in the columns until it is reused
+	const float infinity = std::numeric_limits<float>::max();
+	m_minX[id] = infinity;
+	m_minY[id] = infinity;
+	m_maxX[id] = -infinity;
+	m_maxY[id] = -infinity;
+	m_segment[id] = 0;
+	m_joints[id] = 0;
+	m_freeIds.push_back(id);
+
+	if (was_segment)
+	{
+		// The neighbours lost their joint with this segment
+		const glm::vec2 ends[2] = { glm::vec2(m_startX[id], m_startY[id]), glm::vec2(m_endX[id], m_endY[id]) };
+		for (int other = 0; other < static_cast<int>(m_segment.size()); other++)
+		{
+			if (m_segment[other] && (IsJoined(GetStart(other), ends[0]) || IsJoined(GetStart(other), ends[1]) ||
+				IsJoined(GetEnd(other), ends[0]) || IsJoined(GetEnd(other), ends[1])))
+			{
+				RefreshJoints(other);
+			}
+		}
+	}
+}
+
+void StaticGeometry::Clear()
+{
+	m_normalX.clear();
+	m_normalY.clear();
+	m_offset.clear();
+	m_distanceMask.clear();
+	m_minX.clear();
+	m_minY.clear();
+	m_maxX.clear();
+	m_maxY.clear();
+	m_startX.clear();
+	m_startY.clear();
+	m_endX.clear();
+	m_endY.clear();
+	m_friction.clear();
+	m_restitution.clear();
+	m_segment.clear();
+	m_joints.clear();
+	m_freeIds.clear();
+}
+
+int StaticGeometry::GetCount() const
+{
+	return static_cast<int>(m_segment.size() - m_freeIds.size());
+}
+
+int StaticGeometry::GetCapacity() const
+{
+	return static_cast<int>(m_segment.size());
+}
+
+bool StaticGeometry::IsRemoved(const int id) const
+{
+	return m_minX[id] > m_maxX[id];
+}
+
+bool StaticGeometry::IsSegment(const int id) const
+{
+	return m_segment[id] != 0;
+}
+
+glm::vec2 StaticGeometry::GetStart(const int id) const
+{
+	return glm::vec2(m_startX[id], m_startY[id]);
+}
+
+glm::vec2 StaticGeometry::GetEnd(const int id) const
+{
+	return glm::vec2(m_endX[id], m_endY[id]);
+}
+
+glm::vec2 StaticGeometry::GetNormal(const int id) const
+{
+	return glm::vec2(m_normalX[id], m_normalY[id]);
+}
+
+void StaticGeometry::Collide(const BodyStore& bodies, const float margin, std::vector<ContactManifold>& manifolds) const
+{
+	const size_t first = manifolds.size();
+	const int body_count = bodies.GetCount();
+	const int shape_count = static_cast<int>(m_segment.size());
+
+	if (shape_count == 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < body_count; i++)
+	{
+		// Static bodies never touch static shapes, sleeping ones are tested so their contacts keep the impulses
+		if (!bodies.enableGravity[i] || bodies.shape[i] == CollisionShape::NO_COLLIDER || bodies.proxyId[i] == -1 ||
+			(bodies.collisionMask[i] & LAYER) == 0)
+		{
+			continue;
+		}
+
+		const bool circle = bodies.shape[i] == CollisionShape::CIRCLE;
+		const float x = bodies.positionX[i];
+		const float y = bodies.positionY[i];
+		const float half_width = (circle ? bodies.radius[i] : bodies.halfWidth[i]) + margin;
+		const float half_height = (circle ? bodies.radius[i] : bodies.halfHeight[i]) + margin;
+
+		// How far the body reaches towards a shape is the radius for circles and depends on the normal for boxes
+		const float radius = circle ? bodies.radius[i] : 0.0f;
+		const float box_width = circle ? 0.0f : bodies.halfWidth[i];
+		const float box_height = circle ? 0.0f : bodies.halfHeight[i];
+
+		int id = 0;
+
+#if defined(STATIC_GEOMETRY_SSE)
+		// The distance to each shape's line and the bounding boxes decide which shapes get the exact test
+		const __m128 position_x = _mm_set1_ps(x);
+		const __m128 position_y = _mm_set1_ps(y);
+		const __m128 radius_4 = _mm_set1_ps(radius + margin);
+		const __m128 box_width_4 = _mm_set1_ps(box_width);
+		const __m128 box_height_4 = _mm_set1_ps(box_height);
+		const __m128 min_x = _mm_set1_ps(x - half_width);
+		const __m128 max_x = _mm_set1_ps(x + half_width);
+		const __m128 min_y = _mm_set1_ps(y - half_height);
+		const __m128 max_y = _mm_set1_ps(y + half_height);
+		const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(SEGMENT_MASK)));
+
+		for (; id + 4 <= shape_count; id += 4)
+		{
+			const __m128 normal_x = _mm_loadu_ps(&m_normalX[id]);
+			const __m128 normal_y = _mm_loadu_ps(&m_normalY[id]);
+
+			__m128 distance = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(normal_x, position_x), _mm_mul_ps(normal_y, position_y)), _mm_loadu_ps(&m_offset[id]));
+			distance = _mm_and_ps(distance, _mm_loadu_ps(reinterpret_cast<const float*>(&m_distanceMask[id])));
+
+			const __m128 reach = _mm_add_ps(radius_4, _mm_add_ps(
+				_mm_mul_ps(box_width_4, _mm_and_ps(normal_x, abs_mask)),
+				_mm_mul_ps(box_height_4, _mm_and_ps(normal_y, abs_mask))));
+
+			__m128 near_shape = _mm_cmple_ps(distance, reach);
+			near_shape = _mm_and_ps(near_shape, _mm_cmple_ps(_mm_loadu_ps(&m_minX[id]), max_x));
+			near_shape = _mm_and_ps(near_shape, _mm_cmpge_ps(_mm_loadu_ps(&m_maxX[id]), min_x));
+			near_shape = _mm_and_ps(near_shape, _mm_cmple_ps(_mm_loadu_ps(&m_minY[id]), max_y));
+			near_shape = _mm_and_ps(near_shape, _mm_cmpge_ps(_mm_loadu_ps(&m_maxY[id]), min_y));
+
+			int lanes = _mm_movemask_ps(near_shape);
+			while (lanes != 0)
+			{
+				int lane = 0;
+				while ((lanes & (1 << lane)) == 0)
+				{
+					lane++;
+				}
+				lanes &= ~(1 << lane);
+
+				ContactManifold manifold;
+				if (CollideShape(bodies, i, id + lane, margin, manifold))
+				{
+					manifolds.push_back(manifold);
+				}
+			}
+		}
+#endif
+
+		for (; id < shape_count; id++)
+		{
+			float distance = m_normalX[id] * x + m_normalY[id] * y - m_offset[id];
+			distance = m_segment[id] ? std::abs(distance) : distance;
+			const float reach = radius + margin + box_width * std::abs(m_normalX[id]) + box_height * std::abs(m_normalY[id]);
+
+			if (distance > reach || m_minX[id] > x + half_width || m_maxX[id] < x - half_width ||
+				m_minY[id] > y + half_height || m_maxY[id] < y - half_height)
+			{
+				continue;
+			}
+
+			ContactManifold manifold;
+			if (CollideShape(bodies, i, id, margin, manifold))
+			{
+				manifolds.push_back(manifold);
+			}
+		}
+	}
+
+	// Bodies are visited in dense order, the merge with last step's manifolds wants proxy order
+	std::sort(manifolds.begin() + first, manifolds.end());
+}
+
+int StaticGeometry::Sweep(const glm::vec2 start, const glm::vec2 translation, const float radius, float& fraction, glm::vec2& normal) const
+{
+	int first_id = -1;
+	float first_fraction = 1.0f;
+
+	for (int id = 0; id < static_cast<int>(m_segment.size()); id++)
+	{
+		if (IsRemoved(id))
+		{
+			continue;
+		}
+
+		float hit_fraction;
+		glm::vec2 hit_normal;
+		const bool hit = m_segment[id] ?
+			TimeOfImpact::SweepCircleSegment(start, translation, radius, GetStart(id), GetEnd(id), hit_fraction, hit_normal) :
+			TimeOfImpact::SweepCircleHalfPlane(start, translation, radius, GetStart(id), GetNormal(id), hit_fraction, hit_normal);
+
+		if (hit && hit_fraction < first_fraction)
+		{
+			first_id = id;
+			first_fraction = hit_fraction;
+			normal = hit_normal;
+		}
+	}
+
+	fraction = first_fraction;
+	return first_id;
+}
+
+int StaticGeometry::Allocate()
+{
+	if (!m_freeIds.empty())
+	{
+		const int id = m_freeIds.back();
+		m_freeIds.pop_back();
+		return id;
+	}
+
+	m_normalX.push_back(0.0f);
+	m_normalY.push_back(0.0f);
+	m_offset.push_back(0.0f);
+	m_distanceMask.push_back(PLANE_MASK);
+	m_minX.push_back(0.0f);
+	m_minY.push_back(0.0f);
+	m_maxX.push_back(0.0f);
+	m_maxY.push_back(0.0f);
+	m_startX.push_back(0.0f);
+	m_startY.push_back(0.0f);
+	m_endX.push_back(0.0f);
+	m_endY.push_back(0.0f);
+	m_friction.push_back(0.0f);
+	m_restitution.push_back(0.0f);
+	m_segment.push_back(0);
+	m_joints.push_back(0);
+	return static_cast<int>(m_segment.size()) - 1;
+}
+
+void StaticGeometry::RefreshJoints(const int id)
+{
+	const glm::vec2 start = GetStart(id);
+	const glm::vec2 end = GetEnd(id);
+	m_joints[id] = 0;
+
+	for (int other = 0; other < static_cast<int>(m_segment.size()); other++)
+	{
+		if (other == id || !m_segment[other])
+		{
+			continue;
+		}
+
+		const glm::vec2 other_start = GetStart(other);
+		const glm::vec2 other_end = GetEnd(other);
+
+		// Joints are mutual, a new segment also joins the ones already there
+		if (IsJoined(start, other_start) || IsJoined(start, other_end))
+		{
+			m_joints[id] |= 1 << START_FEATURE;
+			m_joints[other] |= IsJoined(start, other_start) ? 1 << START_FEATURE : 1 << END_FEATURE;
+		}
+		if (IsJoined(end, other_start) || IsJoined(end, other_end))
+		{
+			m_joints[id] |= 1 << END_FEATURE;
+			m_joints[other] |= IsJoined(end, other_start) ? 1 << START_FEATURE : 1 << END_FEATURE;
+		}
+	}
+}
+
+bool StaticGeometry::CollideShape(const BodyStore& bodies, const int body, const int id, const float margin, ContactManifold& manifold) const
+{
+	const glm::vec2 center = bodies.GetPosition(body);
+	const bool circle = bodies.shape[body] == CollisionShape::CIRCLE;
+	const bool box = bodies.shape[body] == CollisionShape::RECTANGLE;
+	const glm::vec2 line_normal = GetNormal(id);
+
+	// Worked out as the direction from the shape to the body, flipped at the end so the normal goes from A to B
+	glm::vec2 normal;
+	float separation;
+	uint32_t feature = FACE_FEATURE;
+
+	if (!m_segment[id])
+	{
+		float reach = circle ? bodies.radius[body] :
+			bodies.halfWidth[body] * std::abs(line_normal.x) + bodies.halfHeight[body] * std::abs(line_normal.y);
+
+		if (!circle && !box)
+		{
+			// Deepest point of the hull into the plane
+			const ConvexShape& convex = bodies.convex[body];
+			reach = Dot(convex.vertices[convex.GetSupport(-line_normal)], -line_normal) + convex.radius;
+		}
+
+		normal = line_normal;
+		separation = Dot(center, line_normal) - m_offset[id] - reach;
+	}
+	else if (circle)
+	{
+		// Closest point of the segment to the center
+		const glm::vec2 start = GetStart(id);
+		const glm::vec2 edge = GetEnd(id) - start;
+		const float length_squared = Dot(edge, edge);
+		const float along = (length_squared > 0.0f) ? std::clamp(Dot(center - start, edge) / length_squared, 0.0f, 1.0f) : 0.0f;
+
+		const glm::vec2 offset = center - (start + edge * along);
+		const float distance = std::sqrt(Dot(offset, offset));
+
+		normal = (distance > 0.0f) ? offset / distance : line_normal;
+		separation = distance - bodies.radius[body];
+		feature = (along <= 0.0f) ? START_FEATURE : (along >= 1.0f) ? END_FEATURE : FACE_FEATURE;
+	}
+	else if (!box)
+	{
+		// Any other shape goes through GJK against the segment
+		ConvexShape segment;
+		segment.vertices[0] = GetStart(id);
+		segment.vertices[1] = GetEnd(id);
+		segment.count = 2;
+
+		ContactManifold convex_manifold;
+		if (!Narrowphase::CollideConvex(segment, glm::vec2(0, 0), bodies.convex[body], center, margin, convex_manifold))
+		{
+			return false;
+		}
+
+		normal = convex_manifold.normal;
+		separation = convex_manifold.points[0].separation;
+
+		// Pushed out sideways means the shape is against an end, the one nearer its center
+		if (std::abs(Dot(normal, line_normal)) < FACE_NORMAL_DOT)
+		{
+			const glm::vec2 edge = segment.vertices[1] - segment.vertices[0];
+			feature = (Dot(center - segment.vertices[0], edge) < Dot(edge, edge) * 0.5f) ? START_FEATURE : END_FEATURE;
+		}
+	}
+	else
+	{
+		// Separating axes of a box and a segment, the segment's normal and the two box axes. The least
+		// overlapping one pushes the box out
+		const glm::vec2 half_extents = glm::vec2(bodies.halfWidth[body], bodies.halfHeight[body]);
+		const float line_distance = Dot(center, line_normal) - m_offset[id];
+
+		normal = line_normal * Sign(line_distance);
+		separation = std::abs(line_distance) - (half_extents.x * std::abs(line_normal.x) + half_extents.y * std::abs(line_normal.y));
+
+		const float mins[2] = { m_minX[id], m_minY[id] };
+		const float maxs[2] = { m_maxX[id], m_maxY[id] };
+		for (int axis = 0; axis < 2; axis++)
+		{
+			const float below = mins[axis] - (center[axis] + half_extents[axis]);
+			const float above = (center[axis] - half_extents[axis]) - maxs[axis];
+			const float axis_separation = std::max(below, above);
+
+			if (axis_separation > separation)
+			{
+				// The box is off an end of the segment, the end nearest to it is the one it touches
+				const float side = (above > below) ? 1.0f : -1.0f;
+				const bool start_nearer = GetStart(id)[axis] * side > GetEnd(id)[axis] * side;
+
+				separation = axis_separation;
+				normal = glm::vec2(0, 0);
+				normal[axis] = side;
+				feature = start_nearer ? START_FEATURE : END_FEATURE;
+			}
+		}
+	}
+
+	if (separation > margin)
+	{
+		return false;
+	}
+
+	// The next segment of a chain takes over at a joint, its end would be a wall in the middle of the floor
+	if (feature != FACE_FEATURE && !circle && (m_joints[id] & (1 << feature)) != 0)
+	{
+		return false;
+	}
+
+	manifold.proxyA = bodies.proxyId[body];
+	manifold.proxyB = PROXY_BASE + id;
+	manifold.bodyA = body;
+	manifold.bodyB = ContactManifold::STATIC_BODY;
+	manifold.normal = -normal;
+	manifold.points[0].separation = separation;
+	manifold.points[0].featureId = feature;
+	manifold.pointCount = 1;
+	manifold.friction = std::sqrt(bodies.friction[body] * m_friction[id]);
+	manifold.restitution = std::min(bodies.restitution[body], m_restitution[id]);
+	return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef __STATIC_GEOMETRY__
+#define __STATIC_GEOMETRY__
+#include <cstdint>
+#include <vector>
+#include <glm/vec2.hpp>
+#include "BodyStore.h"
+#include "ContactManifold.h"
+
+/*
+ * Planes and segments that never move, kept as columns so every body is tested against all of them in one
+ * pass, four at a time. Planes are solid behind their normal, segments are solid on both sides, chains of
+ * them make terrain. The contacts go into the same manifold list as body pairs, with the static side as
+ * ContactManifold::STATIC_BODY.
+ *
+ * Ids stay valid until removed, removed slots are reused by the next add
+ */
+class StaticGeometry
+{
+public:
+	// Proxy id of static shape id in the manifolds, above every broadphase proxy so they sort after a
+	// body's pair contacts
+	static constexpr int PROXY_BASE = 1 << 30;
+
+	// Collision layer of every static shape, bodies without it in their mask pass through them
+	static constexpr uint32_t LAYER = 0x80000000;
+
+	int AddPlane(glm::vec2 point, glm::vec2 normal, float friction, float restitution);
+	int AddSegment(glm::vec2 start, glm::vec2 end, float friction, float restitution);
+
+	// Moves a plane, ids of segments and removed shapes are ignored
+	void SetPlane(int id, glm::vec2 point, glm::vec2 normal);
+	void Remove(int id);
+	void Clear();
+
+	// Number of planes and segments, not counting removed ones, and one past the highest id in use
+	[[nodiscard]] int GetCount() const;
+	[[nodiscard]] int GetCapacity() const;
+	[[nodiscard]] bool IsRemoved(int id) const;
+	[[nodiscard]] bool IsSegment(int id) const;
+	[[nodiscard]] glm::vec2 GetStart(int id) const;
+	[[nodiscard]] glm::vec2 GetEnd(int id) const;
+	[[nodiscard]] glm::vec2 GetNormal(int id) const;
+
+	// Appends a manifold for every body with gravity within margin of a static shape, sorted by proxy pair
+	void Collide(const BodyStore& bodies, float margin, std::vector<ContactManifold>& manifolds) const;
+
+	// First static shape a circle moving from start by translation touches, -1 if none. See TimeOfImpact
+	int Sweep(glm::vec2 start, glm::vec2 translation, float radius, float& fraction, glm::vec2& normal) const;
+
+private:
+	int Allocate();
+	void WritePlane(int id, glm::vec2 point, glm::vec2 normal);
+	void RefreshJoints(int id);
+	bool CollideShape(const BodyStore& bodies, int body, int id, float margin, ContactManifold& manifold) const;
+
+	// Planes are n . p = offset, segments store the line through them the same way so both share the
+	// distance test that picks the shapes worth an exact look
+	std::vector<float> m_normalX;
+	std::vector<float> m_normalY;
+	std::vector<float> m_offset;
+
+	// All bits for planes, all but the sign bit for segments, so the distance to a segment's line is
+	// taken on whichever side the body is
+	std::vector<uint32_t> m_distanceMask;
+
+	// Bounding boxes, infinite for planes and empty for removed slots
+	std::vector<float> m_minX;
+	std::vector<float> m_minY;
+	std::vector<float> m_maxX;
+	std::vector<float> m_maxY;
+
+	std::vector<float> m_startX;
+	std::vector<float> m_startY;
+	std::vector<float> m_endX;
+	std::vector<float> m_endY;
+	std::vector<float> m_friction;
+	std::vector<float> m_restitution;
+	std::vector<uint32_t> m_segment;
+
+	// Bit per segment end shared with another segment, named by the feature id of the end
+	std::vector<uint32_t> m_joints;
+
+	std::vector<int> m_freeIds;
+};
+
+#endif /* defined (__STATIC_GEOMETRY__) */
@@ -0,0 +1,344 @@
+#include "SweepAndPruneBroadphase.h"
+#include <algorithm>
+
+int SweepAndPruneBroadphase::CreateProxy(const AABB& aabb)
+{
+	int proxy_id;
+	if (!m_freeProxies.empty())
+	{
+		proxy_id = m_freeProxies.back();
+		m_freeProxies.pop_back();
+	}
+	else
+	{
+		proxy_id = static_cast<int>(m_aabbs.size());
+		m_aabbs.emplace_back();
+		m_active.push_back(false);
+	}
+
+	m_aabbs[proxy_id] = aabb;
+	m_active[proxy_id] = true;
+	m_proxyCount++;
+
+	// New endpoints go to the end and get sorted in, reporting their pairs, on the next update
+	const uint32_t data = static_cast<uint32_t>(proxy_id) << 1;
+	m_endpoints.push_back({ aabb.min[m_axis], data });
+	m_endpoints.push_back({ aabb.max[m_axis], data | 1 });
+	m_newEndpoints += 2;
+
+	return proxy_id;
+}
+
+void SweepAndPruneBroadphase::DestroyProxy(const int proxy_id)
+{
+	// Searching the endpoints and pairs for every destroyed proxy would be quadratic in a mass removal
+	m_active[proxy_id] = false;
+	m_destroyedProxies.push_back(proxy_id);
+	m_proxyCount--;
+}
+
+void SweepAndPruneBroadphase::MoveProxy(const int proxy_id, const AABB& aabb)
+{
+	m_aabbs[proxy_id] = aabb;
+}
+
+void SweepAndPruneBroadphase::UpdatePairs(std::vector<BroadphasePair>& pairs)
+{
+	RemoveDestroyedProxies();
+	SortEndpoints();
+
+	// Only pairs already overlapping on the sort axis need the other axis checked
+	const int other_axis = 1 - m_axis;
+	for (auto& axis_pair : m_axisPairs)
+	{
+		const AABB& aabb_a = m_aabbs[axis_pair.proxyA];
+		const AABB& aabb_b = m_aabbs[axis_pair.proxyB];
+		const bool overlapping = aabb_a.min[other_axis] <= aabb_b.max[other_axis] && aabb_a.max[other_axis] >= aabb_b.min[other_axis];
+
+		if (overlapping == axis_pair.overlapping)
+		{
+			continue;
+		}
+
+		axis_pair.overlapping = overlapping;
+		m_pairsChanged = true;
+
+		const PairCallback& callback = overlapping ? m_onPairAdded : m_onPairRemoved;
+		if (callback)
+		{
+			callback(axis_pair.proxyA, axis_pair.proxyB);
+		}
+	}
+
+	// The sorted list only has to be rebuilt when a pair came or went
+	if (m_pairsChanged)
+	{
+		m_sortedPairs.clear();
+		for (const auto& axis_pair : m_axisPairs)
+		{
+			if (axis_pair.overlapping)
+			{
+				m_sortedPairs.push_back({ axis_pair.proxyA, axis_pair.proxyB });
+			}
+		}
+		std::sort(m_sortedPairs.begin(), m_sortedPairs.end());
+		m_pairsChanged = false;
+	}
+
+	pairs = m_sortedPairs;
+}
+
+void SweepAndPruneBroadphase::Query(const AABB& aabb, std::vector<int>& proxies) const
+{
+	proxies.clear();
+
+	// Endpoints are only sorted inside UpdatePairs, so walk the boxes instead
+	const int count = static_cast<int>(m_aabbs.size());
+	for (int i = 0; i < count; i++)
+	{
+		if (m_active[i] && m_aabbs[i].Overlaps(aabb))
+		{
+			proxies.push_back(i);
+		}
+	}
+}
+
+void SweepAndPruneBroadphase::RayCast(const RayCastInput& input, float max_fraction, const RayCastCallback& callback) const
+{
+	// The endpoints only help along one axis, a cast can point anywhere
+	const int count = static_cast<int>(m_aabbs.size());
+	for (int i = 0; i < count && max_fraction > 0.0f; i++)
+	{
+		float enter;
+		if (m_active[i] && m_aabbs[i].Grow(input.radius).RayCast(input.start, input.translation, max_fraction, enter))
+		{
+			max_fraction = callback(i, max_fraction);
+		}
+	}
+}
+
+int SweepAndPruneBroadphase::GetProxyCount() const
+{
+	return m_proxyCount;
+}
+
+BroadphaseType SweepAndPruneBroadphase::GetType() const
+{
+	return BroadphaseType::SWEEP_AND_PRUNE;
+}
+
+void SweepAndPruneBroadphase::SetPairCallbacks(const PairCallback& on_pair_added, const PairCallback& on_pair_removed)
+{
+	m_onPairAdded = on_pair_added;
+	m_onPairRemoved = on_pair_removed;
+}
+
+void SweepAndPruneBroadphase::SetSortAxis(const int axis)
+{
+	if (axis == m_axis)
+	{
+		return;
+	}
+
+	// The pairs are kept for the re-sort to tell which still overlap, so those are not reported again
+	m_axis = axis;
+	m_resort = true;
+	m_endpoints.clear();
+	for (int i = 0; i < static_cast<int>(m_aabbs.size()); i++)
+	{
+		if (m_active[i])
+		{
+			const uint32_t data = static_cast<uint32_t>(i) << 1;
+			m_endpoints.push_back({ m_aabbs[i].min[m_axis], data });
+			m_endpoints.push_back({ m_aabbs[i].max[m_axis], data | 1 });
+		}
+	}
+}
+
+int SweepAndPruneBroadphase::GetSortAxis() const
+{
+	return m_axis;
+}
+
+int SweepAndPruneBroadphase::GetSwapCount() const
+{
+	return m_swapCount;
+}
+
+uint64_t SweepAndPruneBroadphase::PairKey(const int proxy_a, const int proxy_b)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(proxy_a)) << 32) | static_cast<uint32_t>(proxy_b);
+}
+
+bool SweepAndPruneBroadphase::Less(const Endpoint& left, const Endpoint& right)
+{
+	// Min endpoints go first on ties so touching boxes count as overlapping, like AABB::Overlaps
+	return left.value < right.value || (left.value == right.value && !left.IsMax() && right.IsMax());
+}
+
+void SweepAndPruneBroadphase::RemoveDestroyedProxies()
+{
+	if (m_destroyedProxies.empty())
+	{
+		return;
+	}
+
+	m_endpoints.erase(std::remove_if(m_endpoints.begin(), m_endpoints.end(), [this](const Endpoint& endpoint)
+	{
+		return !m_active[endpoint.GetProxy()];
+	}), m_endpoints.end());
+
+	for (int i = static_cast<int>(m_axisPairs.size()) - 1; i >= 0; i--)
+	{
+		if (!m_active[m_axisPairs[i].proxyA] || !m_active[m_axisPairs[i].proxyB])
+		{
+			RemoveAxisPairAt(i);
+		}
+	}
+
+	m_freeProxies.insert(m_freeProxies.end(), m_destroyedProxies.begin(), m_destroyedProxies.end());
+	m_destroyedProxies.clear();
+}
+
+void SweepAndPruneBroadphase::SortEndpoints()
+{
+	// Refresh the endpoint values from the current boxes, the order is from the previous step
+	for (auto& endpoint : m_endpoints)
+	{
+		const AABB& aabb = m_aabbs[endpoint.GetProxy()];
+		endpoint.value = endpoint.IsMax() ? aabb.max[m_axis] : aabb.min[m_axis];
+	}
+
+	m_swapCount = 0;
+
+	// New endpoints are at the end in no order, each one could travel the whole array
+	if (m_resort || m_newEndpoints > RESORT_ENDPOINTS)
+	{
+		ResortEndpoints();
+		return;
+	}
+	m_newEndpoints = 0;
+
+	// Insertion sort, every swap between a min and a max endpoint changes the overlap on this axis
+	const int count = static_cast<int>(m_endpoints.size());
+	for (int i = 1; i < count; i++)
+	{
+		const Endpoint key = m_endpoints[i];
+		int j = i - 1;
+
+		while (j >= 0 && Less(key, m_endpoints[j]))
+		{
+			const Endpoint& other = m_endpoints[j];
+
+			if (!key.IsMax() && other.IsMax())
+			{
+				// Min moved below the other max, they start overlapping on this axis
+				AddAxisPair(key.GetProxy(), other.GetProxy());
+			}
+			else if (key.IsMax() && !other.IsMax())
+			{
+				// Max moved below the other min, they are separated on this axis
+				RemoveAxisPair(key.GetProxy(), other.GetProxy());
+			}
+
+			m_endpoints[j + 1] = m_endpoints[j];
+			j--;
+			m_swapCount++;
+		}
+
+		m_endpoints[j + 1] = key;
+	}
+}
+
+void SweepAndPruneBroadphase::ResortEndpoints()
+{
+	std::sort(m_endpoints.begin(), m_endpoints.end(), Less);
+
+	for (auto& axis_pair : m_axisPairs)
+	{
+		axis_pair.swept = false;
+	}
+
+	// Every proxy still open when a min endpoint comes up overlaps that proxy on this axis
+	m_openProxies.clear();
+	m_openIndex.resize(m_aabbs.size());
+	for (const auto& endpoint : m_endpoints)
+	{
+		const int proxy_id = endpoint.GetProxy();
+		if (endpoint.IsMax())
+		{
+			const int index = m_openIndex[proxy_id];
+			m_openProxies[index] = m_openProxies.back();
+			m_openIndex[m_openProxies[index]] = index;
+			m_openProxies.pop_back();
+			continue;
+		}
+
+		for (const int other : m_openProxies)
+		{
+			AddAxisPair(proxy_id, other);
+		}
+		m_openIndex[proxy_id] = static_cast<int>(m_openProxies.size());
+		m_openProxies.push_back(proxy_id);
+	}
+
+	for (int i = static_cast<int>(m_axisPairs.size()) - 1; i >= 0; i--)
+	{
+		if (!m_axisPairs[i].swept)
+		{
+			RemoveAxisPairAt(i);
+		}
+	}
+
+	m_newEndpoints = 0;
+	m_resort = false;
+}
+
+void SweepAndPruneBroadphase::AddAxisPair(const int proxy_a, const int proxy_b)
+{
+	const int low = std::min(proxy_a, proxy_b);
+	const int high = std::max(proxy_a, proxy_b);
+
+	const auto inserted = m_axisPairIndex.emplace(PairKey(low, high), static_cast<int>(m_axisPairs.size()));
+	if (inserted.second)
+	{
+		// Not reported until the other axis is checked in UpdatePairs
+		m_axisPairs.push_back({ low, high, false, true });
+	}
+	else
+	{
+		m_axisPairs[inserted.first->second].swept = true;
+	}
+}
+
+void SweepAndPruneBroadphase::RemoveAxisPair(const int proxy_a, const int proxy_b)
+{
+	const auto it = m_axisPairIndex.find(PairKey(std::min(proxy_a, proxy_b), std::max(proxy_a, proxy_b)));
+	if (it != m_axisPairIndex.end())
+	{
+		RemoveAxisPairAt(it->second);
+	}
+}
+
+void SweepAndPruneBroadphase::RemoveAxisPairAt(const int index)
+{
+	const AxisPair removed = m_axisPairs[index];
+
+	// Swap and pop, the moved pair gets its new index
+	m_axisPairIndex.erase(PairKey(removed.proxyA, removed.proxyB));
+	if (index != static_cast<int>(m_axisPairs.size()) - 1)
+	{
+		m_axisPairs[index] = m_axisPairs.back();
+		m_axisPairIndex[PairKey(m_axisPairs[index].proxyA, m_axisPairs[index].proxyB)] = index;
+	}
+	m_axisPairs.pop_back();
+
+	if (removed.overlapping)
+	{
+		m_pairsChanged = true;
+		if (m_onPairRemoved)
+		{
+			m_onPairRemoved(removed.proxyA, removed.proxyB);
+		}
+	}
+}
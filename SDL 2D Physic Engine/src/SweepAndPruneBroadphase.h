@@ -0,0 +1,110 @@
+#pragma once
+#ifndef __SWEEP_AND_PRUNE_BROADPHASE__
+#define __SWEEP_AND_PRUNE_BROADPHASE__
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include "Broadphase.h"
+
+/*
+ * Sweep and prune. The endpoint array of the sort axis stays sorted between steps and is repaired with an
+ * insertion sort, which is close to linear when bodies barely move. Every swap of a min and a max endpoint
+ * adds or removes a pair overlapping on that axis, so the pair set is maintained incrementally and only
+ * those pairs are checked on the other axis. Many new proxies at once would each be sorted in across the
+ * whole array, so then the endpoints are sorted from scratch and the pairs found again in one sweep.
+ *
+ * Sorting on x is the default. Towers resting on the same ground share the same heights, so sorting on y
+ * as well would make every jitter shuffle whole rows of endpoints
+ */
+class SweepAndPruneBroadphase final : public Broadphase
+{
+public:
+	typedef std::function<void(int, int)> PairCallback;
+
+	int CreateProxy(const AABB& aabb) override;
+	void DestroyProxy(int proxy_id) override;
+	void MoveProxy(int proxy_id, const AABB& aabb) override;
+	void UpdatePairs(std::vector<BroadphasePair>& pairs) override;
+	void Query(const AABB& aabb, std::vector<int>& proxies) const override;
+	void RayCast(const RayCastInput& input, float max_fraction, const RayCastCallback& callback) const override;
+
+	[[nodiscard]] int GetProxyCount() const override;
+	[[nodiscard]] BroadphaseType GetType() const override;
+
+	// Called when two proxies start or stop overlapping
+	void SetPairCallbacks(const PairCallback& on_pair_added, const PairCallback& on_pair_removed);
+
+	// 0 sorts on x, 1 on y. Changing the axis re-sorts everything on the next update
+	void SetSortAxis(int axis);
+	[[nodiscard]] int GetSortAxis() const;
+
+	// Endpoint swaps done by the last update, a measure of how much the scene moved. None when it re-sorted
+	[[nodiscard]] int GetSwapCount() const;
+
+private:
+	struct Endpoint
+	{
+		float value;
+
+		// proxy id << 1 | 1 for a max endpoint
+		uint32_t data;
+
+		[[nodiscard]] int GetProxy() const { return static_cast<int>(data >> 1); }
+		[[nodiscard]] bool IsMax() const { return (data & 1) != 0; }
+	};
+
+	// Pair overlapping on the sort axis, overlapping is true once the other axis overlaps too. swept is set
+	// when a re-sort finds the pair again, the ones it does not find are removed
+	struct AxisPair
+	{
+		int proxyA;
+		int proxyB;
+		bool overlapping;
+		bool swept;
+	};
+
+	// More new endpoints than this re-sort everything instead of being sorted in one by one
+	static constexpr int RESORT_ENDPOINTS = 32;
+
+	static uint64_t PairKey(int proxy_a, int proxy_b);
+	static bool Less(const Endpoint& left, const Endpoint& right);
+
+	void RemoveDestroyedProxies();
+	void SortEndpoints();
+	void ResortEndpoints();
+	void AddAxisPair(int proxy_a, int proxy_b);
+	void RemoveAxisPair(int proxy_a, int proxy_b);
+	void RemoveAxisPairAt(int index);
+
+	std::vector<AABB> m_aabbs;
+	std::vector<bool> m_active;
+	std::vector<int> m_freeProxies;
+	std::vector<Endpoint> m_endpoints;
+	int m_axis = 0;
+
+	// Destroyed proxies keep their endpoints and pairs until the next update removes them all in one pass,
+	// their ids are only reused after that
+	std::vector<int> m_destroyedProxies;
+
+	// Endpoints added since the last update, and whether the axis changed since
+	int m_newEndpoints = 0;
+	bool m_resort = false;
+
+	// Proxies whose min endpoint a re-sort has passed and max not yet, and where each is in that list
+	std::vector<int> m_openProxies;
+	std::vector<int> m_openIndex;
+
+	std::vector<AxisPair> m_axisPairs;
+	std::unordered_map<uint64_t, int> m_axisPairIndex;
+
+	std::vector<BroadphasePair> m_sortedPairs;
+	bool m_pairsChanged = false;
+
+	PairCallback m_onPairAdded;
+	PairCallback m_onPairRemoved;
+
+	int m_proxyCount = 0;
+	int m_swapCount = 0;
+};
+
+#endif /* defined (__SWEEP_AND_PRUNE_BROADPHASE__) */
@@ -11,7 +11,7 @@ Target::Target()
 	SetHeight(static_cast<int>(size.y));
 	GetTransform()->position = glm::vec2(100.0f, 100.0f);
 	GetRigidBody()->velocity = glm::vec2(0, 0);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 
 	SetType(GameObjectType::TARGET);
 }
@@ -0,0 +1,183 @@
+#include "TimeOfImpact.h"
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	float Dot(const glm::vec2 lhs, const glm::vec2 rhs)
+	{
+		return lhs.x * rhs.x + lhs.y * rhs.y;
+	}
+
+	float Sign(const float value)
+	{
+		return (value < 0.0f) ? -1.0f : 1.0f;
+	}
+}
+
+bool TimeOfImpact::SweepCircleCircle(const glm::vec2 start, const glm::vec2 translation, const float radius,
+	const glm::vec2 center, const float other_radius, float& fraction, glm::vec2& normal)
+{
+	// Ray against the circle with both radii, solve |start + translation * t - center| = r for the first t
+	const float combined_radius = radius + other_radius;
+	const glm::vec2 offset = start - center;
+
+	const float c = Dot(offset, offset) - combined_radius * combined_radius;
+	if (c < 0.0f)
+	{
+		return false;
+	}
+
+	const float a = Dot(translation, translation);
+	const float b = Dot(offset, translation);
+	if (a <= 0.0f || b >= 0.0f)
+	{
+		// Not moving, or moving away
+		return false;
+	}
+
+	const float discriminant = b * b - a * c;
+	if (discriminant < 0.0f)
+	{
+		return false;
+	}
+
+	const float t = (-b - std::sqrt(discriminant)) / a;
+	if (t < 0.0f || t > 1.0f)
+	{
+		return false;
+	}
+
+	const glm::vec2 hit = offset + translation * t;
+	const float length = std::sqrt(Dot(hit, hit));
+
+	fraction = t;
+	normal = (length > 0.0f) ? hit / length : glm::vec2(0, -1);
+	return true;
+}
+
+bool TimeOfImpact::SweepCircleBox(const glm::vec2 start, const glm::vec2 translation, const float radius,
+	const glm::vec2 center, const glm::vec2 half_extents, float& fraction, glm::vec2& normal)
+{
+	// The circle center has to stay out of the box grown by the radius with rounded corners.
+	// Clip the ray against the square grown box first, then fix up the hits that land on a corner
+	const glm::vec2 local = start - center;
+	const glm::vec2 grown = half_extents + glm::vec2(radius, radius);
+
+	float enter = -std::numeric_limits<float>::max();
+	float exit = std::numeric_limits<float>::max();
+	int enter_axis = 0;
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (std::abs(translation[axis]) < 1e-6f)
+		{
+			if (std::abs(local[axis]) > grown[axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float closest = (-grown[axis] - local[axis]) / translation[axis];
+		float farthest = (grown[axis] - local[axis]) / translation[axis];
+		if (closest > farthest)
+		{
+			const float swap = closest;
+			closest = farthest;
+			farthest = swap;
+		}
+
+		if (closest > enter)
+		{
+			enter = closest;
+			enter_axis = axis;
+		}
+		exit = std::fmin(exit, farthest);
+	}
+
+	if (enter > exit || enter > 1.0f || exit < 0.0f)
+	{
+		return false;
+	}
+
+	const glm::vec2 hit = local + translation * std::fmax(enter, 0.0f);
+
+	// Beyond the box on both axes means the grown box was entered through a corner, rays have no rounded corners
+	if (radius > 0.0f && std::abs(hit.x) > half_extents.x && std::abs(hit.y) > half_extents.y)
+	{
+		const glm::vec2 corner = glm::vec2(Sign(hit.x) * half_extents.x, Sign(hit.y) * half_extents.y);
+		return SweepCircleCircle(local, translation, radius, corner, 0.0f, fraction, normal);
+	}
+
+	if (enter < 0.0f)
+	{
+		return false;
+	}
+
+	fraction = enter;
+	normal = glm::vec2(0, 0);
+	normal[enter_axis] = Sign(hit[enter_axis]);
+	return true;
+}
+
+bool TimeOfImpact::SweepCircleHalfPlane(const glm::vec2 start, const glm::vec2 translation, const float radius,
+	const glm::vec2 plane_point, const glm::vec2 plane_normal, float& fraction, glm::vec2& normal)
+{
+	const float start_distance = Dot(start - plane_point, plane_normal) - radius;
+	const float end_distance = start_distance + Dot(translation, plane_normal);
+
+	if (start_distance < 0.0f || end_distance >= 0.0f)
+	{
+		return false;
+	}
+
+	fraction = start_distance / (start_distance - end_distance);
+	normal = plane_normal;
+	return true;
+}
+
+bool TimeOfImpact::SweepCircleSegment(const glm::vec2 start, const glm::vec2 translation, const float radius,
+	const glm::vec2 segment_start, const glm::vec2 segment_end, float& fraction, glm::vec2& normal)
+{
+	// The circle center has to stay out of the segment grown by the radius, two lines capped by two circles
+	const glm::vec2 edge = segment_end - segment_start;
+	const float length_squared = Dot(edge, edge);
+
+	if (length_squared > 0.0f)
+	{
+		// Face of the grown segment on the side the circle starts on
+		const glm::vec2 line_normal = glm::vec2(-edge.y, edge.x) / std::sqrt(length_squared);
+		const float start_distance = Dot(start - segment_start, line_normal);
+		const glm::vec2 face_normal = line_normal * Sign(start_distance);
+
+		float face_fraction;
+		glm::vec2 face_hit_normal;
+		if (SweepCircleHalfPlane(start, translation, radius, segment_start, face_normal, face_fraction, face_hit_normal))
+		{
+			const float along = Dot(start + translation * face_fraction - segment_start, edge);
+			if (along >= 0.0f && along <= length_squared)
+			{
+				fraction = face_fraction;
+				normal = face_hit_normal;
+				return true;
+			}
+		}
+	}
+
+	// Missed the faces, the ends are all that is left
+	float cap_fraction[2];
+	glm::vec2 cap_normal[2];
+	const bool hit_start = SweepCircleCircle(start, translation, radius, segment_start, 0.0f, cap_fraction[0], cap_normal[0]);
+	const bool hit_end = SweepCircleCircle(start, translation, radius, segment_end, 0.0f, cap_fraction[1], cap_normal[1]);
+
+	if (!hit_start && !hit_end)
+	{
+		return false;
+	}
+
+	const int cap = (hit_start && (!hit_end || cap_fraction[0] <= cap_fraction[1])) ? 0 : 1;
+	fraction = cap_fraction[cap];
+	normal = cap_normal[cap];
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#ifndef __TIME_OF_IMPACT__
+#define __TIME_OF_IMPACT__
+#include <glm/vec2.hpp>
+
+/*
+ * Sweeps of a moving circle against a shape that stays put for the step. Each one returns true when the
+ * circle, moving from start by translation, first touches the shape at a fraction in [0, 1] of the move,
+ * with the normal pointing from the shape to the circle. A circle that already overlaps the shape at the
+ * start is left to the narrowphase and reports no hit
+ */
+class TimeOfImpact
+{
+public:
+	static bool SweepCircleCircle(glm::vec2 start, glm::vec2 translation, float radius,
+		glm::vec2 center, float other_radius, float& fraction, glm::vec2& normal);
+
+	static bool SweepCircleBox(glm::vec2 start, glm::vec2 translation, float radius,
+		glm::vec2 center, glm::vec2 half_extents, float& fraction, glm::vec2& normal);
+
+	static bool SweepCircleHalfPlane(glm::vec2 start, glm::vec2 translation, float radius,
+		glm::vec2 plane_point, glm::vec2 plane_normal, float& fraction, glm::vec2& normal);
+
+	// Segments have no thickness and are hit from either side
+	static bool SweepCircleSegment(glm::vec2 start, glm::vec2 translation, float radius,
+		glm::vec2 segment_start, glm::vec2 segment_end, float& fraction, glm::vec2& normal);
+};
+
+#endif /* defined (__TIME_OF_IMPACT__) */
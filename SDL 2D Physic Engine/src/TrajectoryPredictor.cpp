@@ -0,0 +1,113 @@
+#include "TrajectoryPredictor.h"
+#include "GameObject.h"
+#include "PhysicsEngine.h"
+#include <algorithm>
+#include <cmath>
+
+TrajectoryPredictor::TrajectoryPredictor()
+{
+	SetStepCount(DEFAULT_STEP_COUNT);
+}
+
+void TrajectoryPredictor::SetStepCount(const int step_count)
+{
+	m_stepCount = std::max(1, step_count);
+
+	// Every interval'th step, the launch point and the end point
+	m_points.reserve(m_stepCount / m_pointInterval + 2);
+}
+
+int TrajectoryPredictor::GetStepCount() const
+{
+	return m_stepCount;
+}
+
+void TrajectoryPredictor::SetPointInterval(const int interval)
+{
+	m_pointInterval = std::max(1, interval);
+	SetStepCount(m_stepCount);
+}
+
+void TrajectoryPredictor::SetStaticOnly(const bool static_only)
+{
+	m_staticOnly = static_only;
+}
+
+bool TrajectoryPredictor::IsStaticOnly() const
+{
+	return m_staticOnly;
+}
+
+bool TrajectoryPredictor::Predict(PhysicsEngine& engine, const RigidBody& projectile, glm::vec2 velocity)
+{
+	Clear();
+
+	// Swept like the continuous collision sweeps the body, as the circle inside it
+	const GameObject* game_object = projectile.gameObject;
+	const float radius = (projectile.shape == CollisionShape::CIRCLE || game_object == nullptr) ? projectile.radius :
+		std::min(game_object->GetWidth(), game_object->GetHeight()) * 0.5f;
+
+	// The same substeps and the same semi-implicit Euler as the engine, gravity is all the force there is
+	const int substeps = engine.GetSubsteps();
+	const float delta_time = engine.GetFixedDeltaTime() / static_cast<float>(substeps);
+	const float air_friction = std::pow(engine.GetFriction(), delta_time / PhysicsEngine::FRICTION_DELTA_TIME);
+	const glm::vec2 acceleration = engine.GetGravity() * projectile.gravityScale;
+
+	glm::vec2 position = projectile.GetPosition();
+	m_points.push_back(position);
+
+	for (int step = 1; step <= m_stepCount; step++)
+	{
+		for (int i = 0; i < substeps; i++)
+		{
+			velocity = velocity * air_friction + acceleration * delta_time;
+			const glm::vec2 translation = velocity * delta_time;
+
+			float fraction;
+			glm::vec2 normal;
+			if (engine.SweepCircle(position, translation, radius, projectile.handle, m_staticOnly, fraction, normal))
+			{
+				m_hit = true;
+				m_hitPoint = position + translation * fraction;
+				m_hitNormal = normal;
+				m_points.push_back(m_hitPoint);
+				return true;
+			}
+
+			position += translation;
+		}
+
+		if (step % m_pointInterval == 0 || step == m_stepCount)
+		{
+			m_points.push_back(position);
+		}
+	}
+
+	return false;
+}
+
+void TrajectoryPredictor::Clear()
+{
+	m_points.clear();
+	m_hit = false;
+}
+
+const std::vector<glm::vec2>& TrajectoryPredictor::GetPoints() const
+{
+	return m_points;
+}
+
+bool TrajectoryPredictor::HasHit() const
+{
+	return m_hit;
+}
+
+glm::vec2 TrajectoryPredictor::GetHitPoint() const
+{
+	return m_hitPoint;
+}
+
+glm::vec2 TrajectoryPredictor::GetHitNormal() const
+{
+	return m_hitNormal;
+}
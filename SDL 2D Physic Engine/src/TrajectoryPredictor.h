@@ -0,0 +1,56 @@
+#pragma once
+#ifndef __TRAJECTORY_PREDICTOR__
+#define __TRAJECTORY_PREDICTOR__
+#include <vector>
+#include <glm/vec2.hpp>
+#include "BodyHandle.h"
+
+class PhysicsEngine;
+struct RigidBody;
+
+/*
+ * Where a projectile would go if it were launched now. Steps a lone copy of it with the engine's gravity, air
+ * friction and fixed steps, sweeping every substep's move against the world like the continuous collision
+ * does, and stops at the first thing it would hit. Nothing in the world moves or wakes.
+ *
+ * The arc buffer is allocated once for the step count, predicting every frame does not allocate
+ */
+class TrajectoryPredictor
+{
+public:
+	static constexpr int DEFAULT_STEP_COUNT = 120;
+	static constexpr int DEFAULT_POINT_INTERVAL = 3;
+
+	TrajectoryPredictor();
+
+	// Fixed steps looked ahead, and how many of them apart the points of the arc are
+	void SetStepCount(int step_count);
+	[[nodiscard]] int GetStepCount() const;
+	void SetPointInterval(int interval);
+
+	// Only test static bodies and static geometry, the cheapest prediction
+	void SetStaticOnly(bool static_only);
+	[[nodiscard]] bool IsStaticOnly() const;
+
+	// Launches the copy from where the projectile is with the given velocity, returns true if it hits something
+	bool Predict(PhysicsEngine& engine, const RigidBody& projectile, glm::vec2 velocity);
+	void Clear();
+
+	// The arc starts at the launch point and ends at the hit point, or where the steps ran out
+	[[nodiscard]] const std::vector<glm::vec2>& GetPoints() const;
+	[[nodiscard]] bool HasHit() const;
+	[[nodiscard]] glm::vec2 GetHitPoint() const;
+	[[nodiscard]] glm::vec2 GetHitNormal() const;
+
+private:
+	int m_stepCount = DEFAULT_STEP_COUNT;
+	int m_pointInterval = DEFAULT_POINT_INTERVAL;
+	bool m_staticOnly = false;
+
+	std::vector<glm::vec2> m_points;
+	bool m_hit = false;
+	glm::vec2 m_hitPoint = glm::vec2(0, 0);
+	glm::vec2 m_hitNormal = glm::vec2(0, 0);
+};
+
+#endif /* defined (__TRAJECTORY_PREDICTOR__) */
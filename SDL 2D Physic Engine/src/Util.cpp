@@ -357,6 +357,23 @@ void Util::DrawFilledRect(const glm::vec2 position, const int width, const int h
 	SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
 }
 
+void Util::DrawDots(const std::vector<glm::vec2>& centres, const float size, const glm::vec4 colour, SDL_Renderer* renderer)
+{
+	// Kept between calls so drawing the dots every frame does not allocate
+	static std::vector<SDL_FRect> rectangles;
+	rectangles.clear();
+	for (const auto& centre : centres)
+	{
+		rectangles.push_back({ centre.x - size * 0.5f, centre.y - size * 0.5f, size, size });
+	}
+
+	const auto [r, g, b, a] = ToSDLColour(colour);
+
+	SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	SDL_RenderFillRectsF(renderer, rectangles.data(), static_cast<int>(rectangles.size()));
+	SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+}
+
 void Util::DrawCircle(const glm::vec2 centre, const float radius, const glm::vec4 colour, const ShapeType type, SDL_Renderer* renderer)
 {
 	const auto [r, g, b, a] = ToSDLColour(colour);
@@ -6,6 +6,7 @@
 #include "GLM/vec4.hpp"
 #include "ShapeType.h"
 #include <SDL.h>
+#include <vector>
 
 #include "GameObject.h"
 #include "Renderer.h"
@@ -59,6 +60,9 @@ public:
 	static void DrawCircle(glm::vec2 centre, float radius, glm::vec4 colour = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), ShapeType type = ShapeType::SYMMETRICAL, SDL_Renderer* renderer = Renderer::Instance().GetRenderer());
 	static void DrawCapsule(glm::vec2 position, int width, int height, glm::vec4 colour = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), SDL_Renderer* renderer = Renderer::Instance().GetRenderer());
 
+	// A size x size square on every centre, all drawn with a single render call
+	static void DrawDots(const std::vector<glm::vec2>& centres, float size, glm::vec4 colour = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), SDL_Renderer* renderer = Renderer::Instance().GetRenderer());
+
 	static float GetClosestEdge(glm::vec2 vec_a, GameObject* object);
 
 	static SDL_Color ToSDLColour(glm::vec4 colour);
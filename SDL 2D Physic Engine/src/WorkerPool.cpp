@@ -0,0 +1,145 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(const int thread_count)
+{
+	Start(thread_count);
+}
+
+WorkerPool::~WorkerPool()
+{
+	Stop();
+}
+
+void WorkerPool::ParallelFor(const int count, const int batch_size, const std::function<void(int, int, int)>& job)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	const int batch_count = GetBatchCount(count, batch_size);
+
+	// Not worth waking anyone for a single batch
+	if (m_threads.empty() || batch_count == 1)
+	{
+		for (int batch = 0; batch < batch_count; batch++)
+		{
+			const int begin = batch * batch_size;
+			job(batch, begin, std::min(begin + batch_size, count));
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job = &job;
+		m_count = count;
+		m_batchSize = batch_size;
+		m_batchCount = batch_count;
+		m_nextBatch = 0;
+		m_busyWorkers = static_cast<int>(m_threads.size());
+		m_generation++;
+	}
+	m_wake.notify_all();
+
+	RunBatches();
+
+	// The job lives on the caller's stack, every worker has to be done with it before returning
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this] { return m_busyWorkers == 0; });
+	m_job = nullptr;
+}
+
+int WorkerPool::GetBatchCount(const int count, const int batch_size)
+{
+	return (count + batch_size - 1) / batch_size;
+}
+
+void WorkerPool::SetThreadCount(const int thread_count)
+{
+	if (thread_count == GetThreadCount())
+	{
+		return;
+	}
+
+	Stop();
+	Start(thread_count);
+}
+
+int WorkerPool::GetThreadCount() const
+{
+	return static_cast<int>(m_threads.size()) + 1;
+}
+
+void WorkerPool::Start(int thread_count)
+{
+	if (thread_count <= 0)
+	{
+		thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	}
+
+	// Workers start from the current generation, a thread that only gets going after the next ParallelFor
+	// was issued still takes part in it
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stopping = false;
+	for (int i = 1; i < thread_count; i++)
+	{
+		m_threads.emplace_back(&WorkerPool::WorkerLoop, this, m_generation);
+	}
+}
+
+void WorkerPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+
+	for (auto& thread : m_threads)
+	{
+		thread.join();
+	}
+	m_threads.clear();
+}
+
+void WorkerPool::WorkerLoop(unsigned seen_generation)
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this, seen_generation] { return m_stopping || m_generation != seen_generation; });
+
+			if (m_stopping)
+			{
+				return;
+			}
+			seen_generation = m_generation;
+		}
+
+		RunBatches();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_busyWorkers--;
+		}
+		m_done.notify_one();
+	}
+}
+
+void WorkerPool::RunBatches()
+{
+	while (true)
+	{
+		const int batch = m_nextBatch.fetch_add(1);
+		if (batch >= m_batchCount)
+		{
+			return;
+		}
+
+		const int begin = batch * m_batchSize;
+		(*m_job)(batch, begin, std::min(begin + m_batchSize, m_count));
+	}
+}
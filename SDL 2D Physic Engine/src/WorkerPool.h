@@ -0,0 +1,57 @@
+#pragma once
+#ifndef __WORKER_POOL__
+#define __WORKER_POOL__
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed set of threads that split a loop into batches. The calling thread works on the batches too, so a
+ * pool of one thread runs everything inline. Which thread takes which batch changes from run to run, so
+ * callers write each batch's output to its own slot and combine the slots in batch order afterwards
+ */
+class WorkerPool
+{
+public:
+	// 0 uses every hardware thread
+	explicit WorkerPool(int thread_count = 0);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// Calls job(batch, begin, end) for every batch_size long range of [0, count) and returns once all are done
+	void ParallelFor(int count, int batch_size, const std::function<void(int, int, int)>& job);
+
+	[[nodiscard]] static int GetBatchCount(int count, int batch_size);
+
+	// Includes the calling thread
+	void SetThreadCount(int thread_count);
+	[[nodiscard]] int GetThreadCount() const;
+
+private:
+	void Start(int thread_count);
+	void Stop();
+	void WorkerLoop(unsigned seen_generation);
+	void RunBatches();
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	// Job being run, guarded by m_mutex apart from the batch counter
+	const std::function<void(int, int, int)>* m_job = nullptr;
+	int m_count = 0;
+	int m_batchSize = 1;
+	int m_batchCount = 0;
+	std::atomic<int> m_nextBatch{ 0 };
+	int m_busyWorkers = 0;
+	unsigned m_generation = 0;
+	bool m_stopping = false;
+};
+
+#endif /* defined (__WORKER_POOL__) */
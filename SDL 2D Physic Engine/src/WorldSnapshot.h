@@ -0,0 +1,108 @@
+#pragma once
+#ifndef __WORLD_SNAPSHOT__
+#define __WORLD_SNAPSHOT__
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Flat copy of the simulation state taken by PhysicsEngine::SaveSnapshot. The state is stored column by
+ * column, so writing and reading a snapshot is one memcpy per column whatever the body count.
+ *
+ * Bodies are named by the slot the engine registered their RigidBody under, never by pointer, so a snapshot
+ * only restores into the engine that took it and not once one of its bodies was removed. Reusing one snapshot
+ * keeps its buffer, taking one every frame does not allocate
+ */
+class WorldSnapshot
+{
+public:
+	// Bumped whenever the layout changes, restoring a snapshot of another version fails
+	static constexpr uint32_t MAGIC = 0x57534E50;
+	static constexpr uint32_t VERSION = 5;
+
+	[[nodiscard]] bool IsEmpty() const
+	{
+		return m_data.empty();
+	}
+
+	[[nodiscard]] size_t GetSize() const
+	{
+		return m_data.size();
+	}
+
+	void Clear()
+	{
+		m_data.clear();
+	}
+
+	template <typename T>
+	void Write(const T* values, const size_t count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots are copied byte for byte");
+
+		const size_t offset = m_data.size();
+		m_data.resize(offset + count * sizeof(T));
+		if (count > 0)
+		{
+			std::memcpy(m_data.data() + offset, values, count * sizeof(T));
+		}
+	}
+
+	template <typename T>
+	void Write(const T& value)
+	{
+		Write(&value, 1);
+	}
+
+	// Overwrites what an earlier Write put at offset, for sizes only known once the rest is written
+	template <typename T>
+	void WriteAt(const size_t offset, const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots are copied byte for byte");
+		std::memcpy(m_data.data() + offset, &value, sizeof(T));
+	}
+
+	template <typename T>
+	void WriteColumn(const std::vector<T>& column)
+	{
+		Write(column.data(), column.size());
+	}
+
+	// Copies count values starting at offset and moves offset past them, false if the snapshot ends first
+	template <typename T>
+	bool Read(size_t& offset, T* values, const size_t count) const
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots are copied byte for byte");
+
+		if (offset + count * sizeof(T) > m_data.size())
+		{
+			return false;
+		}
+
+		if (count > 0)
+		{
+			std::memcpy(values, m_data.data() + offset, count * sizeof(T));
+		}
+		offset += count * sizeof(T);
+		return true;
+	}
+
+	template <typename T>
+	bool Read(size_t& offset, T& value) const
+	{
+		return Read(offset, &value, 1);
+	}
+
+	template <typename T>
+	bool ReadColumn(size_t& offset, std::vector<T>& column, const size_t count) const
+	{
+		column.resize(count);
+		return Read(offset, column.data(), count);
+	}
+
+private:
+	std::vector<unsigned char> m_data;
+};
+
+#endif /* defined (__WORLD_SNAPSHOT__) */
@@ -14,8 +14,7 @@ Ship::Ship() : m_maxSpeed(10.0f)
 
 	GetTransform()->position = glm::vec2(400.0f, 300.0f);
 	GetRigidBody()->velocity = glm::vec2(0.0f, 0.0f);
-	GetRigidBody()->acceleration = glm::vec2(0.0f, 0.0f);
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 	SetType(GameObjectType::AGENT);
 
 	SetCurrentHeading(0.0f);// current facing angle
@@ -121,7 +120,7 @@ void Ship::CheckBounds()
 
 void Ship::Reset()
 {
-	GetRigidBody()->isColliding = false;
+	SetColliding(false);
 	const int half_width = static_cast<int>(GetWidth() * 0.5);
 	const auto x_component = rand() % (640 - GetWidth()) + half_width + 1;
 	const auto y_component = -GetHeight();